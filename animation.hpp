@@ -10,6 +10,12 @@
 #include "mini3d_animation/animation.hpp"
 #include "mini3d_animation/animationmanager.hpp"
 #include "mini3d_animation/track.hpp"
+#include "mini3d_animation/animationclip.hpp"
+#include "mini3d_animation/compressedclip.hpp"
+#include "mini3d_animation/posebuffer.hpp"
+#include "mini3d_animation/blendspace.hpp"
+#include "mini3d_animation/animationevents.hpp"
+#include "mini3d_animation/clipplayer.hpp"
 #include "mini3d_animation/animationdatatypes.hpp"
 
 #endif
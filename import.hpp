@@ -8,5 +8,6 @@
 #define MINI3D_IMPORT_H
 
 #include "mini3d_import/assetlibrary.hpp"
+#include "mini3d_import/assetstreamer.hpp"
 
 #endif
@@ -8,8 +8,19 @@
 #define MINI3D_MATH_H
 
 #include "mini3d_math/quat.hpp"
-#include "mini3d_math/Vec3.hpp"
-#include "mini3d_math/Vec4.hpp"
+#include "mini3d_math/fastmath.hpp"
+#include "mini3d_math/vecn.hpp"
+#include "mini3d_math/vec3.hpp"
+#include "mini3d_math/vec4.hpp"
+#include "mini3d_math/mat4.hpp"
 #include "mini3d_math/transform.hpp"
+#include "mini3d_math/transformbatch.hpp"
+#include "mini3d_math/quatbatch.hpp"
+#include "mini3d_math/bonepalette.hpp"
+#include "mini3d_math/dualquat.hpp"
+#include "mini3d_math/skinning.hpp"
+#include "mini3d_math/packing.hpp"
+#include "mini3d_math/bounds.hpp"
+#include "mini3d_math/frustum.hpp"
 
 #endif
@@ -7,7 +7,7 @@
 
 using namespace mini3d::animation;
 
-Animation::Animation(ITrack** pTrack, unsigned int count, float length) : m_pTracks(pTrack), m_count(count), m_length(length)
+Animation::Animation(ITrack** pTrack, unsigned int count, float length) : m_pTracks(pTrack), m_count(count), m_activeCount(count), m_time(0), m_length(length)
 {
     m_state = STATE_STOPPED;
 }
@@ -36,7 +36,16 @@ void Animation::Update(float timeStep, float weight)
 
     if (m_state == STATE_PLAYING)
     {
-        for (unsigned int i = 0; i < m_count; ++i)
+        for (unsigned int i = 0; i < m_activeCount; ++i)
             m_pTracks[i]->Update(m_time, weight);
     }
-};
\ No newline at end of file
+};
+
+void Animation::Blend(float weight)
+{
+    if (m_state == STATE_PLAYING)
+    {
+        for (unsigned int i = 0; i < m_activeCount; ++i)
+            m_pTracks[i]->Blend(weight);
+    }
+}
@@ -32,12 +32,22 @@ public:
     float GetLength() const                         { return m_length; }
     float GetPosition() const                       { return m_time; }
     void SetPosition(float time)                    { m_time = time; }
-    
+
+    // Level of detail: only the first count tracks are updated, the rest keep their
+    // last values. Put the tracks that matter least, like finger bones, last.
+    unsigned int GetTrackCount() const              { return m_count; }
+    unsigned int GetActiveTrackCount() const        { return m_activeCount; }
+    void SetActiveTrackCount(unsigned int count)    { m_activeCount = (count < m_count) ? count : m_count; }
+
     void Update(float timeStep, float weight = 1.0f);
 
+    // Moves the active tracks toward their last Update by weight, see ITrack::Blend
+    void Blend(float weight);
+
 private:
     ITrack** m_pTracks;
     unsigned int m_count;
+    unsigned int m_activeCount;
     float m_time;
     float m_length;
     State m_state;
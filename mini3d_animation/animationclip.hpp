@@ -0,0 +1,318 @@
+
+// Copyright (c) <2009-2013> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MINI3DANIMATIONCLIP_H
+#define MINI3D_MINI3DANIMATIONCLIP_H
+
+#include <cstring>
+#include <cmath>
+
+#include "track.hpp"
+#include "../mini3d_system/arrays.hpp"
+
+namespace mini3d {
+namespace animation {
+
+
+////////// CATMULL-ROM ////////////////////////////////////////////////////////
+
+// Catmull-Rom spline between the keyframes (t0, v0) and (t1, v1) at time, like Track.
+// vPrev and vNext are the keyframes before and after the interval, or 0 at the ends of
+// a channel where the tangent is zero. normalize scales the result to unit length.
+inline void CatmullRom(float* pOut, unsigned int components, float time, float t0, const float* v0, float t1, const float* v1, float tPrev, const float* vPrev, float tNext, const float* vNext, bool normalize)
+{
+    float length = t1 - t0;
+    float s = (length != 0) ? (time - t0) * (1 / length) : 0;
+    float s2 = s * s, s3 = s2 * s;
+    float h00 = 2 * s3 - 3 * s2 + 1, h01 = -2 * s3 + 3 * s2, h10 = s3 - 2 * s2 + s, h11 = s3 - s2;
+
+    // Tangents scaled to the interval, a missing neighbor gets a zero scale
+    float m0Scale = (vPrev && t1 != tPrev) ? length / (t1 - tPrev) : 0;
+    float m1Scale = (vNext && tNext != t0) ? length / (tNext - t0) : 0;
+    vPrev = vPrev ? vPrev : v0;
+    vNext = vNext ? vNext : v1;
+
+    float norm = 0;
+    for (unsigned int j = 0; j < components; ++j)
+    {
+        float m0 = (v1[j] - vPrev[j]) * m0Scale;
+        float m1 = (vNext[j] - v0[j]) * m1Scale;
+        pOut[j] = v0[j] * h00 + v1[j] * h01 + m0 * h10 + m1 * h11;
+        norm += pOut[j] * pOut[j];
+    }
+
+    if (normalize && norm != 0)
+    {
+        float scale = 1 / sqrtf(norm);
+        for (unsigned int j = 0; j < components; ++j)
+            pOut[j] *= scale;
+    }
+}
+
+// Cubic Hermite spline between the keyframes (t0, v0) and (t1, v1) at time, with
+// the out tangent m0 of the first and the in tangent m1 of the second key in value
+// per second. No branches on the neighboring keys, see AnimationClip.
+inline void HermiteKeys(float* pOut, unsigned int components, float time, float t0, const float* v0, const float* m0, float t1, const float* v1, const float* m1, bool normalize)
+{
+    float length = t1 - t0;
+    float s = (length != 0) ? (time - t0) * (1 / length) : 0;
+    float s2 = s * s, s3 = s2 * s;
+    float h00 = 2 * s3 - 3 * s2 + 1, h01 = -2 * s3 + 3 * s2, h10 = (s3 - 2 * s2 + s) * length, h11 = (s3 - s2) * length;
+
+    float norm = 0;
+    for (unsigned int j = 0; j < components; ++j)
+    {
+        pOut[j] = v0[j] * h00 + v1[j] * h01 + m0[j] * h10 + m1[j] * h11;
+        norm += pOut[j] * pOut[j];
+    }
+
+    if (normalize && norm != 0)
+    {
+        float scale = 1 / sqrtf(norm);
+        for (unsigned int j = 0; j < components; ++j)
+            pOut[j] *= scale;
+    }
+}
+
+
+////////// ANIMATION CLIP /////////////////////////////////////////////////////
+
+// Keyframe data for all channels of an animation in contiguous streams, one for
+// the keyframe times, one for the keyframe values and one for the in and out
+// tangents of every key. The tangents are baked when the channel is added, so
+// evaluating an interval is one cubic. A channel animates 1 to 4
+// consecutive floats of a pose buffer, for example the pos, rot or scale of a
+// Transform in an array of joint transforms. Add all channels before creating a
+// ClipEvaluator for the clip.
+
+class AnimationClip
+{
+public:
+
+    // CHANNEL_NORMALIZE normalizes the interpolated value, used for quaternions.
+    // CHANNEL_ROOT_MOTION is not written to the pose, its movement is read with
+    // RootMotion instead. One channel per clip, a translation.
+    enum ChannelFlags { CHANNEL_NORMALIZE = 1, CHANNEL_ROOT_MOTION = 2 };
+
+    static const unsigned int MAX_COMPONENTS = 4;
+    static const unsigned int NO_CHANNEL = 0xffffffff;
+
+    struct Channel
+    {
+        unsigned int firstKey;      // into the time stream
+        unsigned int firstValue;    // into the value stream, keys are components floats apart.
+                                    // The tangents start at 2 * firstValue, in and out per key.
+        unsigned int keyCount;
+        unsigned int components;
+        unsigned int poseOffset;    // in floats
+        unsigned int flags;
+    };
+
+    AnimationClip(float length) : m_length(length), m_pTimes(0), m_pValues(0), m_pTangents(0), m_pChannels(0), m_keyCount(0), m_valueCount(0), m_tangentCount(0), m_channelCount(0), m_poseSize(0), m_rootChannel(NO_CHANNEL) {}
+    ~AnimationClip()                                                    { delete[] m_pTimes; delete[] m_pValues; delete[] m_pTangents; delete[] m_pChannels; }
+
+    // pKeyframes holds count keyframes of 1 + components floats: the time followed by the
+    // value. This is the layout of Keyframe<T> and of the channel data in .m3d files.
+    // Keyframe times must not decrease. pTangents holds the in and then the out tangent
+    // of every key, 2 * components floats per key in value per second, for example the
+    // handles of an authored curve. Without it the Catmull-Rom tangents of Track are used.
+    void AddChannel(const float* pKeyframes, unsigned int count, unsigned int components, unsigned int poseOffset, unsigned int flags = 0, const float* pTangents = 0)
+    {
+        Channel channel = { m_keyCount, m_valueCount, count, components, poseOffset, flags };
+        m_rootChannel = (flags & CHANNEL_ROOT_MOTION) ? m_channelCount : m_rootChannel;
+        system::AppendArray(m_pChannels, m_channelCount, &channel, 1);
+
+        float* pTimes = new float[count];
+        float* pValues = new float[count * components];
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            pTimes[i] = pKeyframes[i * (components + 1)];
+            memcpy(pValues + i * components, pKeyframes + i * (components + 1) + 1, components * sizeof(float));
+        }
+
+        float* pBaked = new float[count * 2 * components];
+        if (pTangents)
+            memcpy(pBaked, pTangents, count * 2 * components * sizeof(float));
+        else
+            CatmullRomTangents(pBaked, pTimes, pValues, count, components);
+
+        system::AppendArray(m_pTimes, m_keyCount, pTimes, count);
+        system::AppendArray(m_pValues, m_valueCount, pValues, count * components);
+        system::AppendArray(m_pTangents, m_tangentCount, pBaked, count * 2 * components);
+        delete[] pTimes;
+        delete[] pValues;
+        delete[] pBaked;
+
+        m_poseSize = (poseOffset + components > m_poseSize) ? poseOffset + components : m_poseSize;
+    }
+
+    float GetLength() const                                             { return m_length; }
+    unsigned int GetChannelCount() const                                { return m_channelCount; }
+    const Channel* GetChannels() const                                  { return m_pChannels; }
+    const float* GetTimes() const                                       { return m_pTimes; }
+    const float* GetValues() const                                      { return m_pValues; }
+    const float* GetTangents() const                                    { return m_pTangents; }
+
+    // Number of floats in a pose buffer for this clip
+    unsigned int GetPoseSize() const                                    { return m_poseSize; }
+    unsigned int GetRootMotionChannel() const                           { return m_rootChannel; }
+
+private:
+
+    AnimationClip(const AnimationClip&);
+    AnimationClip& operator =(const AnimationClip&);
+
+    // The slope between the neighbors of each key, zero at the first and last key
+    static void CatmullRomTangents(float* pTangents, const float* pTimes, const float* pValues, unsigned int count, unsigned int components)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            float* pIn = pTangents + i * 2 * components;
+            float* pOut = pIn + components;
+
+            float length = (i > 0 && i < count - 1) ? pTimes[i + 1] - pTimes[i - 1] : 0;
+            float scale = (length != 0) ? 1 / length : 0;
+            for (unsigned int j = 0; j < components; ++j)
+                pIn[j] = pOut[j] = (length != 0) ? (pValues[(i + 1) * components + j] - pValues[(i - 1) * components + j]) * scale : 0;
+        }
+    }
+
+private:
+    float m_length;
+
+    float* m_pTimes;
+    float* m_pValues;
+    float* m_pTangents;
+    Channel* m_pChannels;
+
+    unsigned int m_keyCount;
+    unsigned int m_valueCount;
+    unsigned int m_tangentCount;
+    unsigned int m_channelCount;
+    unsigned int m_poseSize;
+    unsigned int m_rootChannel;
+};
+
+
+////////// CLIP EVALUATOR /////////////////////////////////////////////////////
+
+// Anything that writes a pose for a time, so evaluators and blend nodes can be
+// combined in a BlendSpace.
+struct IClipEvaluator
+{
+    virtual ~IClipEvaluator() {};
+    virtual void Evaluate(float time, float* pPose) = 0;
+    virtual float GetLength() const = 0;
+};
+
+// Evaluates all channels of a clip into a pose buffer in one loop. Interpolation
+// is the Hermite spline of the baked tangents, by default the Catmull-Rom spline
+// Track uses. Times outside the keyframes are clamped.
+// The evaluator remembers the keyframe interval of every channel, so one
+// evaluator per playing instance of the clip. Seeking anywhere is a binary search.
+
+class ClipEvaluator : public IClipEvaluator
+{
+public:
+
+    typedef AnimationClip Clip;
+
+    ClipEvaluator(const AnimationClip* pClip) : m_pClip(pClip), m_pCursors(new unsigned int[pClip->GetChannelCount()])
+    {
+        for (unsigned int i = 0; i < pClip->GetChannelCount(); ++i)
+            m_pCursors[i] = 1;
+    }
+
+    ~ClipEvaluator()                                                    { delete[] m_pCursors; }
+
+    const AnimationClip* GetClip() const                                { return m_pClip; }
+    float GetLength() const                                             { return m_pClip->GetLength(); }
+
+    // Writes every channel at time to pPose, which holds at least GetClip()->GetPoseSize() floats
+    void Evaluate(float time, float* pPose)                             { Evaluate(m_pClip, m_pCursors, time, pPose); }
+
+    // The same for any instance of pClip, pCursors holds its GetChannelCount() keyframe
+    // intervals, initialized to 1. This is how ClipPlayer evaluates its instances.
+    static void Evaluate(const AnimationClip* pClip, unsigned int* pCursors, float time, float* pPose)
+    {
+        const AnimationClip::Channel* pChannels = pClip->GetChannels();
+        for (unsigned int c = 0; c < pClip->GetChannelCount(); ++c)
+            if (!(pChannels[c].flags & AnimationClip::CHANNEL_ROOT_MOTION))
+                EvaluateChannel(pClip, pChannels[c], pCursors[c], time, pPose + pChannels[c].poseOffset);
+    }
+
+    // One channel to pOut, cursor is its keyframe interval
+    static void EvaluateChannel(const AnimationClip* pClip, const AnimationClip::Channel &channel, unsigned int &cursor, float time, float* pOut)
+    {
+        const float* t = pClip->GetTimes() + channel.firstKey;
+        const float* v = pClip->GetValues() + channel.firstValue;
+        const float* m = pClip->GetTangents() + 2 * channel.firstValue;
+        unsigned int n = channel.keyCount;
+        unsigned int components = channel.components;
+
+        // Clamped to the first or last keyframe
+        if (n == 1 || time <= t[0] || time >= t[n - 1])
+        {
+            const float* pKey = v + ((n == 1 || time <= t[0]) ? 0 : (n - 1) * components);
+            for (unsigned int j = 0; j < components; ++j)
+                pOut[j] = pKey[j];
+            return;
+        }
+
+        // Interval [k - 1, k] containing time, searched from the last one
+        unsigned int k = SeekKeyframe(t, sizeof(float), n, time, cursor);
+        cursor = k;
+
+        // Out tangent of key k - 1 and in tangent of key k
+        HermiteKeys(pOut, components, time, t[k - 1], v + (k - 1) * components, m + (2 * k - 1) * components, t[k], v + k * components, m + 2 * k * components,
+                    (channel.flags & AnimationClip::CHANNEL_NORMALIZE) != 0);
+    }
+
+private:
+
+    ClipEvaluator(const ClipEvaluator&);
+    ClipEvaluator& operator =(const ClipEvaluator&);
+
+private:
+    const AnimationClip* m_pClip;
+    unsigned int* m_pCursors;
+};
+
+
+////////// ROOT MOTION ////////////////////////////////////////////////////////
+
+// Movement of the CHANNEL_ROOT_MOTION channel of pClip from time t0 to t1, where
+// playback wrapped from the end to the start of the clip loops times in between
+// (negative when playing backwards). pDelta gets one float per component, zero
+// if the clip has no root motion channel. Evaluator is ClipEvaluator or
+// CompressedClipEvaluator.
+template <typename Evaluator> inline void RootMotion(const typename Evaluator::Clip* pClip, float t0, float t1, int loops, float* pDelta)
+{
+    unsigned int c = pClip->GetRootMotionChannel();
+    if (c == AnimationClip::NO_CHANNEL)
+        return;
+
+    const typename Evaluator::Clip::Channel &channel = pClip->GetChannels()[c];
+    float v0[AnimationClip::MAX_COMPONENTS], v1[AnimationClip::MAX_COMPONENTS];
+    float start[AnimationClip::MAX_COMPONENTS], end[AnimationClip::MAX_COMPONENTS];
+    unsigned int cursor = 1;
+
+    Evaluator::EvaluateChannel(pClip, channel, cursor, t0, v0);
+    Evaluator::EvaluateChannel(pClip, channel, cursor, t1, v1);
+    if (loops != 0)
+    {
+        Evaluator::EvaluateChannel(pClip, channel, cursor, 0.0f, start);
+        Evaluator::EvaluateChannel(pClip, channel, cursor, pClip->GetLength(), end);
+    }
+
+    for (unsigned int j = 0; j < channel.components; ++j)
+        pDelta[j] = v1[j] - v0[j] + ((loops != 0) ? loops * (end[j] - start[j]) : 0);
+}
+
+}
+}
+
+#endif
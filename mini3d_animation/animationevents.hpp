@@ -0,0 +1,176 @@
+
+// Copyright (c) <2009-2013> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MINI3DANIMATIONEVENTS_H
+#define MINI3D_MINI3DANIMATIONEVENTS_H
+
+#include "../mini3d_system/arrays.hpp"
+
+namespace mini3d {
+namespace animation {
+
+
+////////// EVENT BUFFER ///////////////////////////////////////////////////////
+
+// An event that fired for instance of a ClipPlayer, at time in the clip
+struct FiredEvent
+{
+    unsigned int instance;
+    unsigned int id;
+    unsigned int payload;
+    float time;
+};
+
+// Ring buffer of fired events with a fixed capacity, nothing is allocated after
+// construction. When it is full the oldest events are overwritten and counted
+// in GetDroppedCount, so read it every frame or make it larger.
+class EventBuffer
+{
+public:
+
+    EventBuffer(unsigned int capacity) : m_pEvents(new FiredEvent[capacity]), m_capacity(capacity), m_first(0), m_count(0), m_dropped(0) {}
+    ~EventBuffer()                                                      { delete[] m_pEvents; }
+
+    unsigned int GetCount() const                                       { return m_count; }
+    unsigned int GetCapacity() const                                    { return m_capacity; }
+    unsigned int GetDroppedCount() const                                { return m_dropped; }
+    void Clear()                                                        { m_first = m_count = m_dropped = 0; }
+
+    void Push(const FiredEvent &event)
+    {
+        if (m_capacity == 0)
+        {
+            ++m_dropped;
+            return;
+        }
+
+        if (m_count == m_capacity)
+        {
+            m_first = (m_first + 1) % m_capacity;
+            --m_count;
+            ++m_dropped;
+        }
+
+        m_pEvents[(m_first + m_count++) % m_capacity] = event;
+    }
+
+    // Oldest first, returns false when empty
+    bool Pop(FiredEvent &event)
+    {
+        if (m_count == 0)
+            return false;
+
+        event = m_pEvents[m_first];
+        m_first = (m_first + 1) % m_capacity;
+        --m_count;
+        return true;
+    }
+
+private:
+
+    EventBuffer(const EventBuffer&);
+    EventBuffer& operator =(const EventBuffer&);
+
+private:
+    FiredEvent* m_pEvents;
+    unsigned int m_capacity;
+    unsigned int m_first;
+    unsigned int m_count;
+    unsigned int m_dropped;
+};
+
+
+////////// EVENT TRACK ////////////////////////////////////////////////////////
+
+// Events at times in a clip, like footsteps or hits. id and payload mean
+// whatever the game wants them to. Shared by all instances of the clip.
+class EventTrack
+{
+public:
+
+    struct Event
+    {
+        float time;
+        unsigned int id;
+        unsigned int payload;
+    };
+
+    EventTrack() : m_pEvents(0), m_count(0) {}
+    ~EventTrack()                                                       { delete[] m_pEvents; }
+
+    // Events are kept sorted by time, events at the same time in the order they were added
+    void AddEvent(float time, unsigned int id, unsigned int payload = 0)
+    {
+        unsigned int index = LowerBound(time);
+        while (index < m_count && m_pEvents[index].time == time)
+            ++index;
+
+        Event event = { time, id, payload };
+        system::InsertArray(m_pEvents, m_count, index, &event, 1);
+    }
+
+    unsigned int GetCount() const                                       { return m_count; }
+    const Event* GetEvents() const                                      { return m_pEvents; }
+
+    // Pushes the events in [t0, t1) to pBuffer. loops is the number of times playback
+    // wrapped from length back to 0 in between, then the events in [t0, length) and
+    // [0, t1) fire, and one more full pass if it wrapped more than once. Playing
+    // backwards (loops < 0, or t1 < t0 without a loop) fires nothing.
+    void Collect(float t0, float t1, int loops, float length, unsigned int instance, EventBuffer* pBuffer) const
+    {
+        if (loops < 0)
+            return;
+
+        if (loops == 0)
+        {
+            CollectRange(t0, t1, instance, pBuffer);
+            return;
+        }
+
+        CollectRange(t0, length, instance, pBuffer);
+        if (loops > 1)
+            CollectRange(0, length, instance, pBuffer);
+        CollectRange(0, t1, instance, pBuffer);
+    }
+
+private:
+
+    EventTrack(const EventTrack&);
+    EventTrack& operator =(const EventTrack&);
+
+    // First event at or after time
+    unsigned int LowerBound(float time) const
+    {
+        unsigned int low = 0, high = m_count;
+        while (low < high)
+        {
+            unsigned int middle = (low + high) / 2;
+            if (m_pEvents[middle].time < time)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+
+    void CollectRange(float t0, float t1, unsigned int instance, EventBuffer* pBuffer) const
+    {
+        for (unsigned int i = LowerBound(t0); i < m_count && m_pEvents[i].time < t1; ++i)
+        {
+            FiredEvent event = { instance, m_pEvents[i].id, m_pEvents[i].payload, m_pEvents[i].time };
+            pBuffer->Push(event);
+        }
+    }
+
+private:
+    Event* m_pEvents;
+    unsigned int m_count;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,222 @@
+// Copyright (c) <2009-2013> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#include "animationmanager.hpp"
+#include "../mini3d_system/arrays.hpp"
+
+using namespace mini3d::animation;
+using namespace mini3d::system;
+
+// Waking a thread costs more than updating this many animations
+const unsigned int MIN_ANIMATIONS_PER_THREAD = 32;
+
+AnimationManager::AnimationManager(unsigned int threadCount) : m_pEntries(0), m_pJobs(0), m_animationCount(0), m_jobCount(0), m_capacity(0), m_trackBudget(0), m_firstEntry(0), m_stagger(0), m_threadCount(threadCount ? threadCount : 1), m_activeThreads(0), m_pending(0), m_exit(false)
+{
+    m_pRanges = new UpdateRange[m_threadCount];
+    m_pWorkers = new Worker[m_threadCount];
+    m_ppThreads = new IThread*[m_threadCount];
+
+    m_pMutex = IMutex::New();
+    m_pWork = ICondition::New();
+    m_pDone = ICondition::New();
+
+    for (unsigned int i = 0; i < m_threadCount - 1; ++i)
+    {
+        m_pRanges[i].queued = false;
+        m_pWorkers[i].pManager = this;
+        m_pWorkers[i].index = i;
+        m_pWorkers[i].started = false;
+        m_ppThreads[i] = IThread::New(&m_pWorkers[i]);
+    }
+}
+
+AnimationManager::~AnimationManager()
+{
+    EndUpdate();
+
+    {
+        Lock lock(m_pMutex);
+        m_exit = true;
+        m_pWork->Broadcast();
+    }
+
+    for (unsigned int i = 0; i < m_threadCount - 1; ++i)
+    {
+        m_ppThreads[i]->Join();
+        delete m_ppThreads[i];
+    }
+
+    delete m_pDone;
+    delete m_pWork;
+    delete m_pMutex;
+
+    delete[] m_ppThreads;
+    delete[] m_pWorkers;
+    delete[] m_pRanges;
+    delete[] m_pEntries;
+    delete[] m_pJobs;
+}
+
+void AnimationManager::RunWorker(unsigned int index)
+{
+    UpdateRange &range = m_pRanges[index];
+    for (;;)
+    {
+        {
+            Lock lock(m_pMutex);
+            while (!range.queued && !m_exit)
+                m_pWork->Wait(m_pMutex);
+
+            if (!range.queued)
+                return;
+        }
+
+        range.Update();
+
+        Lock lock(m_pMutex);
+        range.queued = false;
+        if (--m_pending == 0)
+            m_pDone->Signal();
+    }
+}
+
+void AnimationManager::AddAnimation(Animation* pAnim)
+{
+    EndUpdate();
+
+    if (m_animationCount == m_capacity)
+    {
+        m_capacity = m_capacity ? m_capacity * 2 : 64;
+        ResizeArray(m_pEntries, m_animationCount, m_capacity);
+        ResizeArray(m_pJobs, 0, m_capacity);
+    }
+
+    Entry entry = { pAnim, 1, 0, 0, false };
+    m_pEntries[m_animationCount++] = entry;
+}
+
+void AnimationManager::RemoveAnimation(Animation* pAnim)
+{
+    EndUpdate();
+
+    for (unsigned int i = 0; i < m_animationCount; ++i)
+        if (m_pEntries[i].pAnimation == pAnim)
+            m_pEntries[i--] = m_pEntries[--m_animationCount];
+
+    m_firstEntry = (m_firstEntry < m_animationCount) ? m_firstEntry : 0;
+}
+
+void AnimationManager::SetUpdateInterval(Animation* pAnim, unsigned int interval)
+{
+    interval = interval ? interval : 1;
+
+    // The frame counters start at different phases so the updates are spread out
+    for (unsigned int i = 0; i < m_animationCount; ++i)
+    {
+        if (m_pEntries[i].pAnimation == pAnim)
+        {
+            m_pEntries[i].interval = interval;
+            m_pEntries[i].frames = m_stagger++ % interval;
+        }
+    }
+}
+
+void AnimationManager::BeginUpdate(float timeStep)
+{
+    mini3d_assert(m_activeThreads == 0, "BeginUpdate called again before EndUpdate");
+
+    // Animations due this frame, from the first one that did not fit in the budget last frame
+    unsigned int tracks = 0, samples = 0;
+    bool full = false;
+    m_jobCount = 0;
+
+    for (unsigned int n = 0, first = m_firstEntry; n < m_animationCount; ++n)
+    {
+        unsigned int i = (first + n) % m_animationCount;
+        Entry &entry = m_pEntries[i];
+        entry.time += timeStep;
+        ++entry.frames;
+
+        // Between samples the tracks blend from the previous sample toward the last one,
+        // covering what is left evenly over the frames left so they reach it in the frame
+        // before the next sample
+        if (entry.frames < entry.interval)
+        {
+            if (entry.sampled)
+            {
+                Job job = { entry.pAnimation, 0, 1.0f / (entry.interval - entry.frames), false };
+                m_pJobs[m_jobCount++] = job;
+            }
+            continue;
+        }
+
+        if (full)
+            continue;
+
+        // At least one animation is updated every frame, however many tracks it has
+        unsigned int cost = entry.pAnimation->GetActiveTrackCount();
+        if (m_trackBudget && samples > 0 && tracks + cost > m_trackBudget)
+        {
+            full = true;
+            m_firstEntry = i;
+            continue;
+        }
+
+        // The first sample is written as is
+        Job job = { entry.pAnimation, entry.time, entry.sampled ? 1.0f / entry.interval : 1.0f, true };
+        m_pJobs[m_jobCount++] = job;
+        tracks += cost;
+        ++samples;
+        entry.time = 0;
+        entry.frames = 0;
+        entry.sampled = true;
+    }
+
+    unsigned int maxThreads = (m_jobCount + MIN_ANIMATIONS_PER_THREAD - 1) / MIN_ANIMATIONS_PER_THREAD;
+    m_activeThreads = (m_threadCount < maxThreads) ? m_threadCount : maxThreads;
+    m_activeThreads = m_activeThreads ? m_activeThreads : 1;
+
+    for (unsigned int i = 0; i < m_activeThreads; ++i)
+    {
+        m_pRanges[i].pJobs = m_pJobs;
+        m_pRanges[i].begin = (unsigned int)((unsigned long long)m_jobCount * i / m_activeThreads);
+        m_pRanges[i].end = (unsigned int)((unsigned long long)m_jobCount * (i + 1) / m_activeThreads);
+    }
+
+    if (m_activeThreads == 1)
+        return;
+
+    // A worker that can not be started leaves its range to EndUpdate
+    for (unsigned int i = 0; i < m_activeThreads - 1; ++i)
+        m_pWorkers[i].started = m_pWorkers[i].started || m_ppThreads[i]->Run();
+
+    Lock lock(m_pMutex);
+    for (unsigned int i = 0; i < m_activeThreads - 1; ++i)
+    {
+        m_pRanges[i].queued = m_pWorkers[i].started;
+        m_pending += m_pWorkers[i].started ? 1 : 0;
+    }
+    m_pWork->Broadcast();
+}
+
+void AnimationManager::EndUpdate()
+{
+    if (m_activeThreads == 0)
+        return;
+
+    // The last range is the calling thread's share
+    m_pRanges[m_activeThreads - 1].Update();
+
+    for (unsigned int i = 0; i < m_activeThreads - 1; ++i)
+        if (!m_pWorkers[i].started)
+            m_pRanges[i].Update();
+
+    {
+        Lock lock(m_pMutex);
+        while (m_pending > 0)
+            m_pDone->Wait(m_pMutex);
+    }
+
+    m_activeThreads = 0;
+}
@@ -1,4 +1,3 @@
-
 // Copyright (c) <2009-2013> Daniel Peterson
 // This file is part of Mini3D <www.mini3d.org>
 // It is distributed under the MIT Software License <www.mini3d.org/license.php>
@@ -8,29 +7,131 @@
 #define MINI3D_MINI3DANIMATIONMANAGER_H
 
 #include "animation.hpp"
+#include "../mini3d_system/threads.hpp"
 
-// TODO: Should be a dynamic array in animation manager for holding animations
-const unsigned int ANIMATION_MANAGER_MAX_ANIMATIONS_COUNT = 256;
+void mini3d_assert(bool expression, const char* text, ...);
 
 namespace mini3d {
 namespace animation {
 
 ////////// ANIMATION MANAGER ///////////////////////////////////////////////////
 
+// Updates all added animations, split in contiguous ranges over threadCount
+// threads including the calling one. Each animation only writes to its own
+// tracks and their targets, so animations must not share target transforms
+// when threadCount > 1. The worker threads are started the first time they
+// are needed and wait for the next frame in between. A range whose thread
+// can not be started is updated on the calling thread.
+//
+// Level of detail: an animation with an update interval of N is sampled every
+// Nth frame with the time of all N, the animations with the same interval are
+// spread over the N frames. Over the N frames after a sample its tracks blend
+// from the previous sample to it, a fraction of the way each frame, so the
+// pose moves smoothly one interval behind. With a track budget, animations that
+// do not fit in a frame wait for the next one and go first then. Fewer tracks
+// per animation is Animation::SetActiveTrackCount.
+
 class AnimationManager
 {
 public:
 
-    AnimationManager() : m_animationCount(0) {}
+    AnimationManager(unsigned int threadCount = 1);
+    ~AnimationManager();
+
+    // Both finish an update in progress first
+    void AddAnimation(Animation* pAnim);
+    void RemoveAnimation(Animation* pAnim);
+    unsigned int GetAnimationCount() const                              { return m_animationCount; }
+    unsigned int GetThreadCount() const                                 { return m_threadCount; }
+
+    // interval 1 updates pAnim every frame, the default
+    void SetUpdateInterval(Animation* pAnim, unsigned int interval);
+
+    // Caps the active tracks updated in one frame, 0 for no cap
+    void SetTrackBudget(unsigned int tracksPerFrame)                    { m_trackBudget = tracksPerFrame; }
+    unsigned int GetTrackBudget() const                                 { return m_trackBudget; }
 
-    void AddAnimation(Animation* pAnim)    { m_animations[m_animationCount++] = pAnim; }
-    void RemoveAnimation(Animation* pAnim) { for (unsigned int i = 0; i < m_animationCount; ++i) if (m_animations[i] == pAnim) m_animations[i] = m_animations[--m_animationCount]; }
-    void Update(float timeStep)            { for (unsigned int i = 0; i < m_animationCount; ++i) m_animations[i]->Update(timeStep, 1.0f); }
+    void Update(float timeStep)                                         { BeginUpdate(timeStep); EndUpdate(); }
+
+    // BeginUpdate wakes the worker threads and returns, EndUpdate updates the
+    // calling thread's range and waits for the workers. In between, animations
+    // must not be changed and their targets must not be read. Every BeginUpdate
+    // is followed by one EndUpdate before the next BeginUpdate.
+    void BeginUpdate(float timeStep);
+    void EndUpdate();
 
 private:
-    Animation* m_animations[ANIMATION_MANAGER_MAX_ANIMATIONS_COUNT];
+
+    AnimationManager(const AnimationManager&);
+    AnimationManager& operator =(const AnimationManager&);
+
+    struct Entry
+    {
+        Animation* pAnimation;
+        unsigned int interval;
+        unsigned int frames;    // since the last update
+        float time;             // since the last update
+        bool sampled;           // updated at least once, there is a sample to blend to
+    };
+
+    // An animation due this frame and the time it moves, or one blending toward its
+    // last sample
+    struct Job
+    {
+        Animation* pAnimation;
+        float timeStep;
+        float weight;
+        bool sample;
+
+        void Update() const                                             { if (sample) pAnimation->Update(timeStep, weight); else pAnimation->Blend(weight); }
+    };
+
+    struct UpdateRange
+    {
+        const Job* pJobs;
+        unsigned int begin, end;
+        bool queued;        // for the worker thread, under m_pMutex
+
+        void Update() const                                             { for (unsigned int i = begin; i < end; ++i) pJobs[i].Update(); }
+    };
+
+    // Waits for its range to be queued, updates it and waits again
+    struct Worker : system::IRunnable
+    {
+        AnimationManager* pManager;
+        unsigned int index;
+        bool started;
+
+        void Run()                                                      { pManager->RunWorker(index); }
+    };
+
+    void RunWorker(unsigned int index);
+
+private:
+    Entry* m_pEntries;
+    Job* m_pJobs;
     unsigned int m_animationCount;
+    unsigned int m_jobCount;
+    unsigned int m_capacity;
+
+    unsigned int m_trackBudget;
+    unsigned int m_firstEntry;  // where the budget starts, after the last entry that fit
+    unsigned int m_stagger;
+
+    // Range i runs on m_ppThreads[i], the last range on the calling thread
+    unsigned int m_threadCount;
+    unsigned int m_activeThreads;
+    UpdateRange* m_pRanges;
+    Worker* m_pWorkers;
+    system::IThread** m_ppThreads;
 
+    // m_pWork wakes the workers for a queued range or to exit, m_pDone the calling
+    // thread when m_pending, the queued ranges not yet updated, drops to 0
+    system::IMutex* m_pMutex;
+    system::ICondition* m_pWork;
+    system::ICondition* m_pDone;
+    unsigned int m_pending;
+    bool m_exit;
 };
 
 
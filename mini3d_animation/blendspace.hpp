@@ -0,0 +1,173 @@
+
+// Copyright (c) <2009-2013> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MINI3DBLENDSPACE_H
+#define MINI3D_MINI3DBLENDSPACE_H
+
+#include "animationclip.hpp"
+#include "posebuffer.hpp"
+
+void mini3d_assert(bool expression, const char* text, ...);
+
+namespace mini3d {
+namespace animation {
+
+
+////////// BLEND SPACE ////////////////////////////////////////////////////////
+
+// Blends clips placed at points in a 1D or 2D parameter space, for example
+// walk and run by speed. The samples are played in sync: time is mapped to a
+// phase of the blended length and each sample is evaluated at the same phase
+// of its own length. A BlendSpace is an IClipEvaluator itself, so blend spaces
+// can be samples of other blend spaces to build a blend tree.
+
+class BlendSpace : public IClipEvaluator
+{
+public:
+
+    static const unsigned int MAX_SAMPLES = 16;
+
+    enum Dimensions { BLEND_1D = 1, BLEND_2D = 2 };
+
+    // The pose layout is the one of PoseBuffer
+    BlendSpace(Dimensions dimensions, unsigned int poseSize, unsigned int quatOffset = 0, unsigned int quatStride = 0) :
+        m_dimensions(dimensions), m_pose(poseSize, quatOffset, quatStride), m_pSample(new float[poseSize]), m_sampleCount(0), m_length(0), m_x(0), m_y(0) {}
+
+    ~BlendSpace()                                                       { delete[] m_pSample; }
+
+    // y is not used by BLEND_1D. A blend space holds up to MAX_SAMPLES samples, the
+    // samples added after that are left out.
+    void AddSample(IClipEvaluator* pEvaluator, float x, float y = 0)
+    {
+        mini3d_assert(m_sampleCount < MAX_SAMPLES, "A blend space holds at most %u samples", MAX_SAMPLES);
+        if (m_sampleCount == MAX_SAMPLES)
+            return;
+
+        m_pSamples[m_sampleCount] = pEvaluator;
+        m_positions[m_sampleCount][0] = x;
+        m_positions[m_sampleCount][1] = y;
+        ++m_sampleCount;
+        SetParameter(m_x, m_y);
+    }
+
+    // Computes the sample weights, call it when the parameter changes
+    void SetParameter(float x, float y = 0)
+    {
+        m_x = x, m_y = y;
+        if (m_dimensions == BLEND_1D)
+            Weights1D(m_weights, m_positions, m_sampleCount, x);
+        else
+            Weights2D(m_weights, m_positions, m_sampleCount, x, y);
+
+        m_length = 0;
+        for (unsigned int i = 0; i < m_sampleCount; ++i)
+            m_length += m_pSamples[i]->GetLength() * m_weights[i];
+    }
+
+    unsigned int GetSampleCount() const                                 { return m_sampleCount; }
+    const float* GetWeights() const                                     { return m_weights; }
+    float GetLength() const                                             { return m_length; }
+
+    // Only samples with a weight are evaluated
+    void Evaluate(float time, float* pPose)
+    {
+        float phase = (m_length != 0) ? time / m_length : 0;
+
+        m_pose.Clear();
+        for (unsigned int i = 0; i < m_sampleCount; ++i)
+        {
+            if (m_weights[i] == 0)
+                continue;
+
+            m_pSamples[i]->Evaluate(phase * m_pSamples[i]->GetLength(), m_pSample);
+            m_pose.Accumulate(m_pSample, m_weights[i]);
+        }
+        m_pose.Normalize();
+
+        memcpy(pPose, m_pose.GetPose(), m_pose.GetSize() * sizeof(float));
+    }
+
+    // Linear between the nearest samples below and above x, clamped to the outermost samples
+    static void Weights1D(float* pWeights, const float (*pPositions)[2], unsigned int count, float x)
+    {
+        unsigned int below = count, above = count;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            pWeights[i] = 0;
+            float p = pPositions[i][0];
+            if (p <= x && (below == count || p > pPositions[below][0]))
+                below = i;
+            if (p >= x && (above == count || p < pPositions[above][0]))
+                above = i;
+        }
+
+        if (below == count || above == count || below == above)
+        {
+            unsigned int nearest = (below != count) ? below : above;
+            if (nearest != count)
+                pWeights[nearest] = 1;
+            return;
+        }
+
+        float t = (x - pPositions[below][0]) / (pPositions[above][0] - pPositions[below][0]);
+        pWeights[below] = 1 - t;
+        pWeights[above] = t;
+    }
+
+    // Gradient band interpolation: each sample's weight falls linearly to 0 towards
+    // every other sample, the smallest of those is kept and the weights are
+    // normalized. A sample has weight 1 at its own position.
+    static void Weights2D(float* pWeights, const float (*pPositions)[2], unsigned int count, float x, float y)
+    {
+        float sum = 0;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            float weight = 1;
+            for (unsigned int j = 0; j < count; ++j)
+            {
+                if (j == i)
+                    continue;
+
+                float dx = pPositions[j][0] - pPositions[i][0], dy = pPositions[j][1] - pPositions[i][1];
+                float lengthSquared = dx * dx + dy * dy;
+                if (lengthSquared == 0)
+                    continue;
+
+                float h = 1 - ((x - pPositions[i][0]) * dx + (y - pPositions[i][1]) * dy) / lengthSquared;
+                h = (h < 0) ? 0 : (h > 1) ? 1 : h;
+                weight = (h < weight) ? h : weight;
+            }
+            pWeights[i] = weight;
+            sum += weight;
+        }
+
+        for (unsigned int i = 0; i < count; ++i)
+            pWeights[i] = (sum != 0) ? pWeights[i] / sum : 0;
+    }
+
+private:
+
+    BlendSpace(const BlendSpace&);
+    BlendSpace& operator =(const BlendSpace&);
+
+private:
+    Dimensions m_dimensions;
+    PoseBuffer m_pose;
+    float* m_pSample;
+
+    IClipEvaluator* m_pSamples[MAX_SAMPLES];
+    float m_positions[MAX_SAMPLES][2];
+    float m_weights[MAX_SAMPLES];
+    unsigned int m_sampleCount;
+
+    float m_length;
+    float m_x, m_y;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,167 @@
+
+// Copyright (c) <2009-2013> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MINI3DCLIPPLAYER_H
+#define MINI3D_MINI3DCLIPPLAYER_H
+
+#include <cstring>
+#include <cmath>
+
+#include "animationclip.hpp"
+#include "compressedclip.hpp"
+#include "animationevents.hpp"
+#include "../mini3d_system/arrays.hpp"
+
+void mini3d_assert(bool expression, const char* text, ...);
+
+namespace mini3d {
+namespace animation {
+
+
+////////// PLAYBACK STATE /////////////////////////////////////////////////////
+
+// Per instance state of a playing clip. weight is not used by the player, it is
+// there for blending the evaluated pose, see PoseBuffer.
+struct PlaybackState
+{
+    float time;
+    float weight;
+};
+
+
+////////// CLIP PLAYER ////////////////////////////////////////////////////////
+
+// Plays many instances of one clip. The clip is shared and never written, each
+// instance is a PlaybackState plus one keyframe cursor per channel, kept in two
+// contiguous arrays that grow by doubling. Adding 1000 instances is a handful of
+// allocations instead of a set of tracks per instance. Instance indices are
+// stable until Remove, which moves the last instance into the removed slot.
+// Evaluator is ClipEvaluator or CompressedClipEvaluator.
+//
+// Advance also does the per frame bookkeeping for all instances in one pass:
+// the events of the clip's EventTrack that were passed go to an EventBuffer, and
+// the movement of the clip's CHANNEL_ROOT_MOTION channel goes to an array.
+
+template <typename Evaluator> class ClipPlayer
+{
+public:
+
+    typedef typename Evaluator::Clip Clip;
+
+    ClipPlayer(const Clip* pClip, bool loop = true, unsigned int capacity = 16) :
+        m_pClip(pClip), m_pEventTrack(0), m_loop(loop), m_pStates(0), m_pCursors(0), m_count(0), m_capacity(0)
+    {
+        Reserve(capacity);
+    }
+
+    ~ClipPlayer()                                                       { delete[] m_pStates; delete[] m_pCursors; }
+
+    const Clip* GetClip() const                                         { return m_pClip; }
+    unsigned int GetCount() const                                       { return m_count; }
+    PlaybackState* GetStates()                                          { return m_pStates; }
+    PlaybackState &GetState(unsigned int index)                         { return m_pStates[index]; }
+
+    void SetEventTrack(const EventTrack* pEventTrack)                   { m_pEventTrack = pEventTrack; }
+    const EventTrack* GetEventTrack() const                             { return m_pEventTrack; }
+
+    // Floats of root motion per instance, 0 if the clip has no root motion channel
+    unsigned int GetRootMotionComponents() const                        { unsigned int c = m_pClip->GetRootMotionChannel(); return (c != AnimationClip::NO_CHANNEL) ? m_pClip->GetChannels()[c].components : 0; }
+
+    // Returns the index of the new instance
+    unsigned int Add(float time = 0, float weight = 1)
+    {
+        if (m_count == m_capacity)
+            Reserve(m_capacity ? m_capacity * 2 : 16);
+
+        PlaybackState state = { time, weight };
+        m_pStates[m_count] = state;
+
+        unsigned int* pCursors = m_pCursors + m_count * m_pClip->GetChannelCount();
+        for (unsigned int i = 0; i < m_pClip->GetChannelCount(); ++i)
+            pCursors[i] = 1;
+
+        return m_count++;
+    }
+
+    void Remove(unsigned int index)
+    {
+        mini3d_assert(index < m_count, "Removing clip player instance %u of %u", index, m_count);
+
+        // The last instance has nothing to move
+        unsigned int channels = m_pClip->GetChannelCount();
+        if (--m_count == index)
+            return;
+
+        m_pStates[index] = m_pStates[m_count];
+        memcpy(m_pCursors + index * channels, m_pCursors + m_count * channels, channels * sizeof(unsigned int));
+    }
+
+    // Moves all instances forward, wrapped into the clip length when looping. The events
+    // passed go to pEvents and the root motion of instance i to pRootMotion +
+    // i * GetRootMotionComponents() floats, either may be 0.
+    void Advance(float timeStep, EventBuffer* pEvents = 0, float* pRootMotion = 0)
+    {
+        float length = m_pClip->GetLength();
+        unsigned int rootComponents = GetRootMotionComponents();
+
+        for (unsigned int i = 0; i < m_count; ++i)
+        {
+            float previous = m_pStates[i].time;
+            float time = previous + timeStep;
+            int loops = 0;
+            if (m_loop && length > 0 && (time >= length || time < 0))
+            {
+                float wraps = floorf(time / length);
+                loops = (int)wraps;
+                time -= wraps * length;
+            }
+            m_pStates[i].time = time;
+
+            if (pEvents && m_pEventTrack)
+                m_pEventTrack->Collect(previous, time, loops, length, i, pEvents);
+            if (pRootMotion && rootComponents)
+                RootMotion<Evaluator>(m_pClip, previous, time, loops, pRootMotion + i * rootComponents);
+        }
+    }
+
+    // pPose holds at least GetClip()->GetPoseSize() floats
+    void Evaluate(unsigned int index, float* pPose)                    { Evaluator::Evaluate(m_pClip, m_pCursors + index * m_pClip->GetChannelCount(), m_pStates[index].time, pPose); }
+
+    // Instance i is written to pPoses + i * poseStride floats
+    void EvaluateAll(float* pPoses, unsigned int poseStride)
+    {
+        for (unsigned int i = 0; i < m_count; ++i)
+            Evaluate(i, pPoses + i * poseStride);
+    }
+
+private:
+
+    ClipPlayer(const ClipPlayer&);
+    ClipPlayer& operator =(const ClipPlayer&);
+
+    void Reserve(unsigned int capacity)
+    {
+        unsigned int channels = m_pClip->GetChannelCount();
+        system::ResizeArray(m_pStates, m_count, capacity);
+        system::ResizeArray(m_pCursors, m_count * channels, capacity * channels);
+        m_capacity = capacity;
+    }
+
+private:
+    const Clip* m_pClip;
+    const EventTrack* m_pEventTrack;
+    bool m_loop;
+
+    PlaybackState* m_pStates;
+    unsigned int* m_pCursors;
+    unsigned int m_count;
+    unsigned int m_capacity;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,366 @@
+
+// Copyright (c) <2009-2013> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MINI3DCOMPRESSEDCLIP_H
+#define MINI3D_MINI3DCOMPRESSEDCLIP_H
+
+#include <stdint.h>
+#include <cstring>
+#include <cmath>
+
+#include "animationclip.hpp"
+#include "../mini3d_system/arrays.hpp"
+
+namespace mini3d {
+namespace animation {
+
+
+////////// COMPRESSED CLIP ////////////////////////////////////////////////////
+
+// AnimationClip with fewer and smaller keyframes. AddChannel removes the keys the
+// spline through the other keys already passes within tolerance of, then stores
+// the rest as 16 bit words:
+//
+//  times               frame index at sampleRate, keys must lie on whole frames
+//  CHANNEL_NORMALIZE   quaternions in 48 bits, smallest three encoding
+//  other channels      16 bits per component inside the channel bounds
+//
+// A rotation key is 8 bytes instead of 20 and a position key 8 instead of 16.
+// Evaluated values are within tolerance of the original keys plus the
+// quantization error, about 3e-5 for quaternions and 8e-6 of the bounds for the
+// other channels. Use a CompressedClipEvaluator to evaluate it.
+
+class CompressedClip
+{
+public:
+
+    enum Encoding { ENCODING_BOUNDS, ENCODING_SMALLEST_THREE };
+
+    struct Channel
+    {
+        unsigned int firstKey;      // into the frame stream
+        unsigned int firstValue;    // into the value stream, keys are stride words apart
+        unsigned int keyCount;
+        unsigned int components;
+        unsigned int poseOffset;    // in floats
+        unsigned int flags;         // AnimationClip::ChannelFlags
+        unsigned int encoding;
+        unsigned int stride;
+        float minimum[AnimationClip::MAX_COMPONENTS];
+        float scale[AnimationClip::MAX_COMPONENTS];    // bounds extent / 65535
+    };
+
+    CompressedClip(float length, float tolerance = 1e-4f, float sampleRate = 30.0f) : m_length(length), m_tolerance(tolerance), m_sampleRate(sampleRate), m_pFrames(0), m_pValues(0), m_pChannels(0), m_keyCount(0), m_valueCount(0), m_channelCount(0), m_poseSize(0), m_rootChannel(AnimationClip::NO_CHANNEL) {}
+    ~CompressedClip()                                                   { delete[] m_pFrames; delete[] m_pValues; delete[] m_pChannels; }
+
+    // Same keyframe layout as AnimationClip::AddChannel. Reducing the keys is
+    // quadratic in the longest run of removed keys, do it once at load time.
+    void AddChannel(const float* pKeyframes, unsigned int count, unsigned int components, unsigned int poseOffset, unsigned int flags = 0)
+    {
+        unsigned int keySize = components + 1;
+        bool smallestThree = GetEncoding(components, flags) == ENCODING_SMALLEST_THREE;
+
+        bool* pKeep = new bool[count];
+        ReduceKeys(pKeep, pKeyframes, count, components, (flags & AnimationClip::CHANNEL_NORMALIZE) != 0);
+
+        Channel channel = { m_keyCount, m_valueCount, 0, components, poseOffset, flags, (unsigned int)GetEncoding(components, flags), GetStride(components, flags), {}, {} };
+        for (unsigned int j = 0; j < components; ++j)
+        {
+            float minimum = pKeyframes[1 + j], maximum = minimum;
+            for (unsigned int i = 1; i < count; ++i)
+            {
+                float value = pKeyframes[i * keySize + 1 + j];
+                minimum = (value < minimum) ? value : minimum;
+                maximum = (value > maximum) ? value : maximum;
+            }
+            channel.minimum[j] = minimum;
+            channel.scale[j] = (maximum - minimum) * (1.0f / 65535);
+        }
+
+        uint16_t* pFrames = new uint16_t[count];
+        uint16_t* pValues = new uint16_t[count * channel.stride];
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (!pKeep[i])
+                continue;
+
+            const float* pKey = pKeyframes + i * keySize;
+            float frame = floorf(pKey[0] * m_sampleRate + 0.5f);
+            pFrames[channel.keyCount] = (uint16_t)((frame < 0) ? 0 : (frame > 65535) ? 65535 : frame);
+
+            uint16_t* pValue = pValues + channel.keyCount * channel.stride;
+            if (smallestThree)
+                QuatToSmallestThree(pValue, pKey + 1);
+            else
+                for (unsigned int j = 0; j < components; ++j)
+                    pValue[j] = (channel.scale[j] != 0) ? (uint16_t)floorf((pKey[1 + j] - channel.minimum[j]) / channel.scale[j] + 0.5f) : 0;
+
+            ++channel.keyCount;
+        }
+
+        AppendChannel(channel, pFrames, pValues);
+        delete[] pKeep;
+        delete[] pFrames;
+        delete[] pValues;
+    }
+
+    // A channel AddChannel compressed before, as stored in a file by the exporter.
+    // pFrames holds keyCount frame indices at GetSampleRate() and pValues keyCount
+    // keys of GetStride words in the encoding GetEncoding picks for components and
+    // flags. minimum and scale are the channel bounds, see Channel.
+    void AddCompressedChannel(const uint16_t* pFrames, const uint16_t* pValues, unsigned int keyCount, unsigned int components, unsigned int poseOffset, unsigned int flags, const float* minimum, const float* scale)
+    {
+        Channel channel = { m_keyCount, m_valueCount, keyCount, components, poseOffset, flags, (unsigned int)GetEncoding(components, flags), GetStride(components, flags), {}, {} };
+        memcpy(channel.minimum, minimum, components * sizeof(float));
+        memcpy(channel.scale, scale, components * sizeof(float));
+        AppendChannel(channel, pFrames, pValues);
+    }
+
+    // How AddChannel stores the keys of a channel, and the number of 16 bit words per key
+    static Encoding GetEncoding(unsigned int components, unsigned int flags)   { return ((flags & AnimationClip::CHANNEL_NORMALIZE) && components == 4) ? ENCODING_SMALLEST_THREE : ENCODING_BOUNDS; }
+    static unsigned int GetStride(unsigned int components, unsigned int flags) { return (GetEncoding(components, flags) == ENCODING_SMALLEST_THREE) ? 3 : components; }
+
+    float GetLength() const                                             { return m_length; }
+    float GetTolerance() const                                          { return m_tolerance; }
+    float GetSampleRate() const                                         { return m_sampleRate; }
+    unsigned int GetChannelCount() const                                { return m_channelCount; }
+    const Channel* GetChannels() const                                  { return m_pChannels; }
+    const uint16_t* GetFrames() const                                   { return m_pFrames; }
+    const uint16_t* GetValues() const                                   { return m_pValues; }
+    unsigned int GetKeyCount() const                                    { return m_keyCount; }
+    unsigned int GetPoseSize() const                                    { return m_poseSize; }
+    unsigned int GetRootMotionChannel() const                           { return m_rootChannel; }
+    unsigned int GetSizeInBytes() const                                 { return sizeof(CompressedClip) + m_channelCount * sizeof(Channel) + (m_keyCount + m_valueCount) * sizeof(uint16_t); }
+
+    // Decodes one key of channel to pOut
+    static void DecodeKey(const Channel &channel, const uint16_t* pKey, float* pOut)
+    {
+        if (channel.encoding == ENCODING_SMALLEST_THREE)
+            SmallestThreeToQuat(pOut, pKey);
+        else
+            for (unsigned int j = 0; j < channel.components; ++j)
+                pOut[j] = channel.minimum[j] + pKey[j] * channel.scale[j];
+    }
+
+    // The three smallest components of the unit quaternion q (x, y, z, w) in 15 bits
+    // each, the index of the largest in the top bits of words 0 and 1 and its sign
+    // in the top bit of word 2. The sign is kept so neighboring keys stay in the
+    // same hemisphere and interpolate the short way.
+    static void QuatToSmallestThree(uint16_t* pOut, const float* q)
+    {
+        unsigned int largest = 0;
+        for (unsigned int j = 1; j < 4; ++j)
+            largest = (fabsf(q[j]) > fabsf(q[largest])) ? j : largest;
+
+        for (unsigned int j = 0, k = 0; j < 4; ++j)
+        {
+            if (j == largest)
+                continue;
+
+            float value = (q[j] * 1.41421356f + 1) * 0.5f;
+            value = (value < 0) ? 0 : (value > 1) ? 1 : value;
+            pOut[k++] = (uint16_t)floorf(value * 32767 + 0.5f);
+        }
+
+        pOut[0] |= (uint16_t)((largest >> 1) << 15);
+        pOut[1] |= (uint16_t)((largest & 1) << 15);
+        pOut[2] |= (uint16_t)((q[largest] < 0) << 15);
+    }
+
+    static void SmallestThreeToQuat(float* q, const uint16_t* pIn)
+    {
+        unsigned int largest = ((pIn[0] >> 15) << 1) | (pIn[1] >> 15);
+
+        float sum = 0;
+        for (unsigned int j = 0, k = 0; j < 4; ++j)
+        {
+            if (j == largest)
+                continue;
+
+            q[j] = ((pIn[k++] & 0x7fff) * (2.0f / 32767) - 1) * 0.707106781f;
+            sum += q[j] * q[j];
+        }
+
+        float w = sqrtf((sum < 1) ? 1 - sum : 0);
+        q[largest] = (pIn[2] >> 15) ? -w : w;
+    }
+
+private:
+
+    CompressedClip(const CompressedClip&);
+    CompressedClip& operator =(const CompressedClip&);
+
+    // Interior keys are removed one at a time, each removal is kept if the spline through
+    // the remaining keys stays within tolerance of every original key it changes.
+    void ReduceKeys(bool* pKeep, const float* pKeyframes, unsigned int count, unsigned int components, bool normalize) const
+    {
+        for (unsigned int i = 0; i < count; ++i)
+            pKeep[i] = true;
+
+        // Removing key i changes the spline from the second kept key before it to the second kept key after it
+        for (unsigned int i = 1; i + 1 < count; ++i)
+        {
+            pKeep[i] = false;
+            unsigned int first = PrevKept(pKeep, PrevKept(pKeep, i));
+            unsigned int last = NextKept(pKeep, count, NextKept(pKeep, count, i));
+            if (MaxError(pKeep, pKeyframes, count, components, normalize, first, last) > m_tolerance)
+                pKeep[i] = true;
+        }
+
+        // A constant channel keeps only its first key
+        if (count > 1 && NextKept(pKeep, count, 0) == count - 1)
+        {
+            bool constant = true;
+            for (unsigned int i = 1; i < count; ++i)
+                for (unsigned int j = 0; j < components; ++j)
+                    constant = constant && fabsf(pKeyframes[i * (components + 1) + 1 + j] - pKeyframes[1 + j]) <= m_tolerance;
+            pKeep[count - 1] = !constant;
+        }
+    }
+
+    void AppendChannel(const Channel &channel, const uint16_t* pFrames, const uint16_t* pValues)
+    {
+        system::AppendArray(m_pFrames, m_keyCount, pFrames, channel.keyCount);
+        system::AppendArray(m_pValues, m_valueCount, pValues, channel.keyCount * channel.stride);
+        m_rootChannel = (channel.flags & AnimationClip::CHANNEL_ROOT_MOTION) ? m_channelCount : m_rootChannel;
+        system::AppendArray(m_pChannels, m_channelCount, &channel, 1);
+
+        m_poseSize = (channel.poseOffset + channel.components > m_poseSize) ? channel.poseOffset + channel.components : m_poseSize;
+    }
+
+    static unsigned int PrevKept(const bool* pKeep, unsigned int i)     { while (i > 0 && !pKeep[--i]) {} return i; }
+    static unsigned int NextKept(const bool* pKeep, unsigned int count, unsigned int i) { while (i < count - 1 && !pKeep[++i]) {} return i; }
+
+    // Largest component difference between the removed keys in [first, last] and the spline through the kept keys
+    static float MaxError(const bool* pKeep, const float* pKeyframes, unsigned int count, unsigned int components, bool normalize, unsigned int first, unsigned int last)
+    {
+        unsigned int keySize = components + 1;
+        float maxError = 0;
+
+        for (unsigned int i = first; i <= last; ++i)
+        {
+            if (pKeep[i])
+                continue;
+
+            unsigned int k0 = PrevKept(pKeep, i), k1 = NextKept(pKeep, count, i);
+            bool hasPrev = k0 > 0, hasNext = k1 < count - 1;
+            const float* pPrev = pKeyframes + PrevKept(pKeep, k0) * keySize;
+            const float* pNext = pKeyframes + NextKept(pKeep, count, k1) * keySize;
+            const float* p0 = pKeyframes + k0 * keySize;
+            const float* p1 = pKeyframes + k1 * keySize;
+            const float* pKey = pKeyframes + i * keySize;
+
+            float value[AnimationClip::MAX_COMPONENTS];
+            CatmullRom(value, components, pKey[0], p0[0], p0 + 1, p1[0], p1 + 1, pPrev[0], hasPrev ? pPrev + 1 : 0, pNext[0], hasNext ? pNext + 1 : 0, normalize);
+
+            for (unsigned int j = 0; j < components; ++j)
+                maxError = (fabsf(value[j] - pKey[1 + j]) > maxError) ? fabsf(value[j] - pKey[1 + j]) : maxError;
+        }
+
+        return maxError;
+    }
+
+private:
+    float m_length;
+    float m_tolerance;
+    float m_sampleRate;
+
+    uint16_t* m_pFrames;
+    uint16_t* m_pValues;
+    Channel* m_pChannels;
+
+    unsigned int m_keyCount;
+    unsigned int m_valueCount;
+    unsigned int m_channelCount;
+    unsigned int m_poseSize;
+    unsigned int m_rootChannel;
+};
+
+
+////////// COMPRESSED CLIP EVALUATOR //////////////////////////////////////////
+
+// ClipEvaluator for a CompressedClip. Only the four keys around the evaluated
+// time are decoded, the spline is evaluated in frames.
+
+class CompressedClipEvaluator : public IClipEvaluator
+{
+public:
+
+    typedef CompressedClip Clip;
+
+    CompressedClipEvaluator(const CompressedClip* pClip) : m_pClip(pClip), m_pCursors(new unsigned int[pClip->GetChannelCount()])
+    {
+        for (unsigned int i = 0; i < pClip->GetChannelCount(); ++i)
+            m_pCursors[i] = 1;
+    }
+
+    ~CompressedClipEvaluator()                                          { delete[] m_pCursors; }
+
+    const CompressedClip* GetClip() const                               { return m_pClip; }
+    float GetLength() const                                             { return m_pClip->GetLength(); }
+
+    // Writes every channel at time to pPose, which holds at least GetClip()->GetPoseSize() floats
+    void Evaluate(float time, float* pPose)                             { Evaluate(m_pClip, m_pCursors, time, pPose); }
+
+    // The same for any instance of pClip, pCursors holds its GetChannelCount() keyframe
+    // intervals, initialized to 1. This is how ClipPlayer evaluates its instances.
+    static void Evaluate(const CompressedClip* pClip, unsigned int* pCursors, float time, float* pPose)
+    {
+        const CompressedClip::Channel* pChannels = pClip->GetChannels();
+        for (unsigned int c = 0; c < pClip->GetChannelCount(); ++c)
+            if (!(pChannels[c].flags & AnimationClip::CHANNEL_ROOT_MOTION))
+                EvaluateChannel(pClip, pChannels[c], pCursors[c], time, pPose + pChannels[c].poseOffset);
+    }
+
+    // One channel to pOut, cursor is its keyframe interval
+    static void EvaluateChannel(const CompressedClip* pClip, const CompressedClip::Channel &channel, unsigned int &cursor, float time, float* pOut)
+    {
+        const uint16_t* f = pClip->GetFrames() + channel.firstKey;
+        const uint16_t* v = pClip->GetValues() + channel.firstValue;
+        float frame = time * pClip->GetSampleRate();
+        unsigned int n = channel.keyCount;
+        unsigned int stride = channel.stride;
+
+        // Clamped to the first or last keyframe
+        if (n == 1 || frame <= f[0] || frame >= f[n - 1])
+        {
+            CompressedClip::DecodeKey(channel, v + ((n == 1 || frame <= f[0]) ? 0 : (n - 1) * stride), pOut);
+            return;
+        }
+
+        // Interval [k - 1, k] containing frame, searched from the last one
+        unsigned int k = SeekKeyframe(f, sizeof(uint16_t), n, frame, cursor);
+        cursor = k;
+
+        float keys[4][AnimationClip::MAX_COMPONENTS];
+        bool hasPrev = k > 1, hasNext = k < n - 1;
+        if (hasPrev)
+            CompressedClip::DecodeKey(channel, v + (k - 2) * stride, keys[0]);
+        CompressedClip::DecodeKey(channel, v + (k - 1) * stride, keys[1]);
+        CompressedClip::DecodeKey(channel, v + k * stride, keys[2]);
+        if (hasNext)
+            CompressedClip::DecodeKey(channel, v + (k + 1) * stride, keys[3]);
+
+        CatmullRom(pOut, channel.components, frame, f[k - 1], keys[1], f[k], keys[2],
+                   hasPrev ? f[k - 2] : 0, hasPrev ? keys[0] : 0,
+                   hasNext ? f[k + 1] : 0, hasNext ? keys[3] : 0,
+                   (channel.flags & AnimationClip::CHANNEL_NORMALIZE) != 0);
+    }
+
+private:
+
+    CompressedClipEvaluator(const CompressedClipEvaluator&);
+    CompressedClipEvaluator& operator =(const CompressedClipEvaluator&);
+
+private:
+    const CompressedClip* m_pClip;
+    unsigned int* m_pCursors;
+};
+
+}
+}
+
+#endif
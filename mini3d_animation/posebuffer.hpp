@@ -0,0 +1,176 @@
+
+// Copyright (c) <2009-2013> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MINI3DPOSEBUFFER_H
+#define MINI3D_MINI3DPOSEBUFFER_H
+
+#include <cstring>
+#include <cmath>
+
+#include "../mini3d_math/quat.hpp"
+
+namespace mini3d {
+namespace animation {
+
+
+////////// POSE BUFFER ////////////////////////////////////////////////////////
+
+// A pose of size floats, as written by ClipEvaluator, with quaternions (x, y, z, w)
+// at quatOffset, quatOffset + quatStride and so on. For an array of Transforms
+// that is PoseBuffer(count * 8, 3, 8). quatStride 0 means no quaternions.
+//
+// Blending several poses: Clear, Accumulate each pose with its weight, then
+// Normalize once. Quaternions are summed in the hemisphere of the first one and
+// normalized only in Normalize. Layers go on top of the normalized pose:
+// Override blends towards a pose, which with a weight going from 0 to 1 is a
+// cross-fade, and Add applies the difference between a pose and a reference pose.
+
+class PoseBuffer
+{
+public:
+
+    PoseBuffer(unsigned int size, unsigned int quatOffset = 0, unsigned int quatStride = 0) : m_pPose(new float[size]), m_size(size), m_quatOffset(quatOffset), m_quatStride(quatStride), m_weight(0)
+    {
+        Clear();
+    }
+
+    ~PoseBuffer()                                                       { delete[] m_pPose; }
+
+    float* GetPose()                                                    { return m_pPose; }
+    const float* GetPose() const                                        { return m_pPose; }
+    unsigned int GetSize() const                                        { return m_size; }
+    unsigned int GetQuatOffset() const                                  { return m_quatOffset; }
+    unsigned int GetQuatStride() const                                  { return m_quatStride; }
+    float GetWeight() const                                             { return m_weight; }
+
+    void Clear()                                                        { memset(m_pPose, 0, m_size * sizeof(float)); m_weight = 0; }
+
+    // Adds weight * pPose
+    void Accumulate(const float* pPose, float weight)
+    {
+        unsigned int nextQuat = FirstQuat();
+        for (unsigned int i = 0; i < m_size;)
+        {
+            if (i == nextQuat)
+            {
+                float w = (Dot(m_pPose + i, pPose + i) < 0) ? -weight : weight;
+                for (unsigned int j = 0; j < 4; ++j)
+                    m_pPose[i + j] += pPose[i + j] * w;
+                i += 4, nextQuat += m_quatStride;
+            }
+            else
+            {
+                m_pPose[i] += pPose[i] * weight;
+                ++i;
+            }
+        }
+        m_weight += weight;
+    }
+
+    // Divides by the accumulated weight and normalizes the quaternions
+    void Normalize()
+    {
+        if (m_weight == 0)
+            return;
+
+        float scale = 1 / m_weight;
+        unsigned int nextQuat = FirstQuat();
+        for (unsigned int i = 0; i < m_size;)
+        {
+            if (i == nextQuat)
+            {
+                NormalizeQuat(m_pPose + i);
+                i += 4, nextQuat += m_quatStride;
+            }
+            else
+            {
+                m_pPose[i] *= scale;
+                ++i;
+            }
+        }
+        m_weight = 1;
+    }
+
+    // pose = pose + (pLayer - pose) * weight, quaternions the short way
+    void Override(const float* pLayer, float weight)
+    {
+        unsigned int nextQuat = FirstQuat();
+        for (unsigned int i = 0; i < m_size;)
+        {
+            if (i == nextQuat)
+            {
+                float w = (Dot(m_pPose + i, pLayer + i) < 0) ? -weight : weight;
+                for (unsigned int j = 0; j < 4; ++j)
+                    m_pPose[i + j] = m_pPose[i + j] * (1 - weight) + pLayer[i + j] * w;
+                NormalizeQuat(m_pPose + i);
+                i += 4, nextQuat += m_quatStride;
+            }
+            else
+            {
+                m_pPose[i] += (pLayer[i] - m_pPose[i]) * weight;
+                ++i;
+            }
+        }
+    }
+
+    // pose = pose + (pLayer - pReference) * weight, quaternions are rotated by the
+    // rotation from pReference to pLayer, scaled by weight
+    void Add(const float* pLayer, const float* pReference, float weight)
+    {
+        unsigned int nextQuat = FirstQuat();
+        for (unsigned int i = 0; i < m_size;)
+        {
+            if (i == nextQuat)
+            {
+                math::Quat delta = math::Quat(pLayer + i) / math::Quat(pReference + i);
+
+                // Identity blended towards delta on the short way
+                float w = (delta.w < 0) ? -weight : weight;
+                delta = math::Quat(delta.x * w, delta.y * w, delta.z * w, delta.w * w + (1 - weight));
+                NormalizeQuat(&delta.x);
+
+                math::Quat q = delta * math::Quat(m_pPose + i);
+                memcpy(m_pPose + i, &q.x, sizeof(q));
+                i += 4, nextQuat += m_quatStride;
+            }
+            else
+            {
+                m_pPose[i] += (pLayer[i] - pReference[i]) * weight;
+                ++i;
+            }
+        }
+    }
+
+private:
+
+    PoseBuffer(const PoseBuffer&);
+    PoseBuffer& operator =(const PoseBuffer&);
+
+    unsigned int FirstQuat() const                                      { return m_quatStride ? m_quatOffset : m_size; }
+
+    static float Dot(const float* a, const float* b)                    { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]; }
+
+    static void NormalizeQuat(float* q)
+    {
+        float norm = Dot(q, q);
+        float scale = (norm != 0) ? 1 / sqrtf(norm) : 0;
+        for (unsigned int j = 0; j < 4; ++j)
+            q[j] *= scale;
+        q[3] = (norm != 0) ? q[3] : 1;
+    }
+
+private:
+    float* m_pPose;
+    unsigned int m_size;
+    unsigned int m_quatOffset;
+    unsigned int m_quatStride;
+    float m_weight;
+};
+
+}
+}
+
+#endif
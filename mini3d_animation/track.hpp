@@ -15,17 +15,72 @@ namespace animation {
 
 template <typename T> struct Keyframe { float time; T value; };
 
-struct ITrack { virtual void Update(float time, float weight = 1.0f) = 0; virtual ~ITrack() {}; };
+// Cubic Hermite spline through p0 and p1 with tangents m0 and m1, t in [0, 1].
+// Types can provide a faster overload in their own namespace, Track finds it by
+// argument dependent lookup. mini3d::math does this for its vectors and quaternions.
+template <typename T> inline T Hermite(T p0, T p1, T m0, T m1, float t)
+{
+    float t2 = t*t;
+    float t3 = t2*t;
+    return (p0 * (2*t3 - 3*t2 + 1)) + (p1 * (-2*t3 + 3*t2)) + (m0 * (t3 - 2*t2 + t)) + (m1 * (t3 - t2));
+}
+
+// value or its equivalent closest to reference, for blending the short way. Only
+// rotations have more than one, mini3d::math overloads it for quaternions.
+template <typename T> inline T SameHemisphere(const T &value, const T &)  { return value; }
+
+// Time of key i when the key times are stride bytes apart
+template <typename Time> inline float KeyframeTime(const Time* pTimes, unsigned int stride, unsigned int i) { return (float)*(const Time*)((const char*)pTimes + i * stride); }
+
+// Index k of the keyframe interval [k - 1, k] containing time, for keys with the time
+// stride bytes apart. Playback moves a few keys forward from the interval hint at the
+// most, anything else (loops, scrubbing, seeks) is a binary search. time must be
+// inside the first and last keyframe times.
+template <typename Time> inline unsigned int SeekKeyframe(const Time* pTimes, unsigned int stride, unsigned int count, float time, unsigned int hint)
+{
+    const unsigned int LINEAR_SEEK_KEYS = 4;
+
+    unsigned int k = (hint < 1) ? 1 : (hint > count - 1) ? count - 1 : hint;
+    if (time >= KeyframeTime(pTimes, stride, k - 1))
+        for (unsigned int i = 0; i < LINEAR_SEEK_KEYS && k < count; ++i, ++k)
+            if (time <= KeyframeTime(pTimes, stride, k))
+                return k;
+
+    // First key at or after time
+    unsigned int low = 1, high = count - 1;
+    while (low < high)
+    {
+        unsigned int middle = (low + high) / 2;
+        if (KeyframeTime(pTimes, stride, middle) < time)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+struct ITrack
+{
+    virtual ~ITrack() {};
+
+    // Writes the value at time to the target, blended with what the target holds by weight
+    virtual void Update(float time, float weight = 1.0f) = 0;
+
+    // Moves the target toward the value of the last Update by weight, without sampling.
+    // Used between the updates of animations with an update interval, see AnimationManager.
+    virtual void Blend(float weight) = 0;
+};
 
 template <typename T, bool normalize = false> struct Track : ITrack { 
 
     Track(T* pTarget, Keyframe<T>* keyframes, unsigned int count);
     ~Track() {};
     void Update(float time, float weight = 1.0f);
-    void SetNormalize(bool value) { m_normalize = value; }
+    void Blend(float weight)                                            { Write(sample, weight); }
 
 private:
     void UpdateIntervalCache();
+    void Write(const T &value, float weight);
     float Clamp(float value, float min, float max) { return (value < min) ? min : (value > max) ? max : value; }
 
 
@@ -41,17 +96,17 @@ private:
     float intervalStartTime;
     float intervalEndTime;
     float invIntervalLength;
-    bool hasM0; // if we are at the first interval, there will be no first derivative!
-    bool hasM1; // if we are at the last interval, there will be no derivative at the end!
-    T m[2]; // derivatives at the edges of the current interval
+    T m[2]; // derivatives at the edges of the current interval, zero at the first and last keyframe
     T p[2]; // values at the edges of the current interval
+
+    T sample; // value of the last Update, before blending
 };
 
 
 ////////// TEMPLATE TYPE IMPLEMENTATIONS //////////////////////////////////////
 
 template <typename T, bool normalize>
-Track<T, normalize>::Track(T* pTarget, Keyframe<T>* keyframes, unsigned int count) : pTarget(pTarget), kf(keyframes), count(count), index(1)
+Track<T, normalize>::Track(T* pTarget, Keyframe<T>* keyframes, unsigned int count) : pTarget(pTarget), kf(keyframes), count(count), index(1), sample(keyframes[0].value)
 {
     startTime = kf[0].time;
     endTime = kf[count - 1].time;
@@ -64,20 +119,10 @@ void Track<T, normalize>::Update(float time, float weight)
 {
     time = Clamp(time, startTime, endTime);
 
-    // if time has started over (if for example we have looped back to the beginning)
-    if (time < intervalStartTime)
-    {
-        index = 0;
-        UpdateIntervalCache();
-    }
-
-    // if we have left the current keyframe interval
-    if (time > intervalEndTime)
+    // if we have left the current keyframe interval, forwards or by looping or seeking
+    if (time < intervalStartTime || time > intervalEndTime)
     {
-        // Fast forward to the correct keyframe interval
-        while(time > kf[index].time)
-            ++index;
-
+        index = SeekKeyframe(&kf[0].time, sizeof(Keyframe<T>), count, time, index);
         UpdateIntervalCache();
     }
 
@@ -85,13 +130,16 @@ void Track<T, normalize>::Update(float time, float weight)
     // http://en.wikipedia.org/wiki/Cubic_Hermite_spline
 
     float t = (time - intervalStartTime) * invIntervalLength;
-    float t2 = t*t;
-    float t3 = t2*t;
-        
-    *pTarget = (p[0] * (2*t3 - 3*t2 + 1)) + (p[1] * (-2*t3 + 3*t2));
 
-    if (hasM0) *pTarget = *pTarget + m[0] * (t3 - 2*t2 + t);
-    if (hasM1) *pTarget = *pTarget + m[1] * (t3 - t2);
+    sample = Hermite(p[0], p[1], m[0], m[1], t);
+    Write(sample, weight);
+}
+
+template <typename T, bool normalize>
+void Track<T, normalize>::Write(const T &value, float weight)
+{
+    // A weight below 1 blends from the value already in the target, quaternions the short way
+    *pTarget = (weight < 1) ? *pTarget + (SameHemisphere(value, *pTarget) - *pTarget) * weight : value;
 
     if (normalize)
         pTarget->Normalize();
@@ -110,27 +158,21 @@ void Track<T, normalize>::UpdateIntervalCache()
     p[0] = kf[index - 1].value;
     p[1] = kf[index].value;
 
-    // keyframe derivatives
-    hasM0 = hasM1 = false;
-        
+    // keyframe derivatives, there is none at the first and the last keyframe
+    m[0] = m[1] = p[0] * 0.0f;
+
     if (index > 1)
     {
         float m0Length = (kf[index].time - kf[index - 2].time);
         if (m0Length)
-        {
-            hasM0 = true;
             m[0] = ((kf[index].value - kf[index - 2].value) / m0Length) * intervalLength;
-        }
     }
 
     if (index < count - 1)
     {
         float m1Length = (kf[index + 1].time - kf[index - 1].time);
         if (m1Length)
-        {
-            hasM1 = true;
             m[1] = ((kf[index + 1].value - kf[index - 1].value) / m1Length) * intervalLength;
-        }
     }
 }
 
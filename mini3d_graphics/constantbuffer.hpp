@@ -24,6 +24,13 @@ struct IConstantBuffer
     virtual ~IConstantBuffer() {};
 
     virtual void SetData(const char* pData) = 0;
+
+    // Updates sizeInBytes bytes of the buffer starting at offsetInBytes, leaving the rest of the data as it is.
+    virtual void SetData(const char* pData, unsigned int offsetInBytes, unsigned int sizeInBytes) = 0;
+
+    // Writes a single value, such as a mini3d::math::Mat4, at offsetInBytes without an intermediate copy.
+    template <typename T> void SetValue(const T &value, unsigned int offsetInBytes) { SetData((const char*)&value, offsetInBytes, sizeof(T)); }
+
     virtual IShaderProgram* GetVertexShader() const = 0;
 };
 
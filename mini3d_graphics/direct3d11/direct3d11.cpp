@@ -332,7 +332,9 @@ struct ShaderInputLayout_D3D11 : IShaderInputLayout
         ID3D11Device* pDevice = pGraphics->GetDevice();
         VertexShader_D3D11* pD3DShader = (VertexShader_D3D11*)pShader->GetVertexShader();
 
-        static const DXGI_FORMAT DATA_TYPE_DXGI[] = { DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT };
+        static const DXGI_FORMAT DATA_TYPE_DXGI[] = { DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT,
+                                                      DXGI_FORMAT_R16G16_FLOAT, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R16G16_SNORM, DXGI_FORMAT_R16G16B16A16_SNORM,
+                                                      DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UINT, DXGI_FORMAT_R10G10B10A2_UNORM }; // Maps to IShaderInputLayout::DataType
 
         m_pElements = new InputElement[count];
         D3D11_INPUT_ELEMENT_DESC* pDesc = new D3D11_INPUT_ELEMENT_DESC[count];
@@ -383,28 +385,47 @@ struct ConstantBuffer_D3D11 : IConstantBuffer
 
         m_sizeInBytes = sizeInBytes;
         m_pShader = pShader;
+
+        // Partial updates need a copy of the data since the buffer is written with MAP_WRITE_DISCARD
+        m_pData = new char[sizeInBytes];
+        memset(m_pData, 0, sizeInBytes);
     }
 
     ~ConstantBuffer_D3D11() 
     { 
         m_pBuffer->Release();
+        delete[] m_pData;
     }
 
     void SetData(const char* pData)
+    {
+        memcpy(m_pData, pData, m_sizeInBytes);
+        Upload();
+    }
+
+    void SetData(const char* pData, unsigned int offsetInBytes, unsigned int sizeInBytes)
+    {
+        mini3d_assert(offsetInBytes + sizeInBytes <= m_sizeInBytes, "Constant buffer update is out of range!");
+        memcpy(m_pData + offsetInBytes, pData, sizeInBytes);
+        Upload();
+    }
+
+private:
+
+    void Upload()
     {
         ID3D11DeviceContext* pContext = m_pGraphicsService->GetContext();
 
         D3D11_MAPPED_SUBRESOURCE resource;
         mini3d_assert(S_OK == pContext->Map(m_pBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource), "Failed to map constant buffer!");
-        memcpy(resource.pData, pData, m_sizeInBytes);
+        memcpy(resource.pData, m_pData, m_sizeInBytes);
         pContext->Unmap(m_pBuffer, 0);
     }
-
-private:
     
     IShaderProgram* m_pShader;
     ID3D11Buffer* m_pBuffer;
     unsigned int m_sizeInBytes;
+    char* m_pData;
 
     GraphicsService_D3D11* m_pGraphicsService;
 };
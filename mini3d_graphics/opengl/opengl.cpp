@@ -54,6 +54,22 @@ const uint MAX_ACTIVE_ATTRIBUTE_INDICES = 32; // How many attributes you can use
 
 const unsigned int mini3d_IndexBuffer_OpenGL_BytesPerIndex[] = { 2, 4 };
 
+// Vertex attribute formats, not in all GL headers. Half floats need OpenGL 3.0 and 10-10-10-2 needs 3.3
+#ifndef GL_SHORT
+#define GL_SHORT                            0x1402
+#endif
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT                       0x140B
+#endif
+#ifndef GL_UNSIGNED_INT_2_10_10_10_REV
+#define GL_UNSIGNED_INT_2_10_10_10_REV      0x8368
+#endif
+
+// Map to IShaderInputLayout::DataType
+const GLint mini3d_ShaderInputLayout_OpenGL_Sizes[] = { 1, 2, 3, 4, 2, 4, 2, 4, 4, 4, 4 };
+const GLenum mini3d_ShaderInputLayout_OpenGL_Types[] = { GL_FLOAT, GL_FLOAT, GL_FLOAT, GL_FLOAT, GL_HALF_FLOAT, GL_HALF_FLOAT, GL_SHORT, GL_SHORT, GL_UNSIGNED_BYTE, GL_UNSIGNED_BYTE, GL_UNSIGNED_INT_2_10_10_10_REV };
+const GLboolean mini3d_ShaderInputLayout_OpenGL_Normalized[] = { GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE, GL_TRUE, GL_TRUE, GL_TRUE, GL_FALSE, GL_TRUE };
+
 // TODO: move these to where they are used!
 struct OpenglBitmapFormat { GLuint internalFormat; GLenum format; GLenum type; };
 OpenglBitmapFormat mini3d_BitmapTexture_Formats[] = { {GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0} };
@@ -385,7 +401,7 @@ private:
 
 struct ShaderInputLayout_OpenGL : IShaderInputLayout
 {
-    struct Attribute { GLint location; GLint size; GLenum type; unsigned int bufferIndex; GLvoid* offsetInBytes; StreamRate rate; };
+    struct Attribute { GLint location; GLint size; GLenum type; GLboolean normalized; unsigned int bufferIndex; GLvoid* offsetInBytes; StreamRate rate; };
 
     unsigned int GetInputElementCount() const { return m_attributeCount; };
     void GetInputElements(InputElement* pElements) const { for(unsigned int i = 0; i < m_attributeCount; ++i) pElements[i]= m_pElements[i]; };
@@ -407,7 +423,9 @@ struct ShaderInputLayout_OpenGL : IShaderInputLayout
             {
                 if (!strcmp(pElements[i].nameGLSL, pActiveAttributes[j].name))
                 {
-                    Attribute att = { pActiveAttributes[j].location, pActiveAttributes[j].size, pActiveAttributes[j].type, pElements[i].vertexBufferIndex, (GLvoid *)pElements[i].offsetInBytes, pElements[i].rate };
+                    // The format in the vertex buffer comes from the element, the shader converts it to its attribute type
+                    DataType type = pElements[i].type;
+                    Attribute att = { pActiveAttributes[j].location, mini3d_ShaderInputLayout_OpenGL_Sizes[type], mini3d_ShaderInputLayout_OpenGL_Types[type], mini3d_ShaderInputLayout_OpenGL_Normalized[type], pElements[i].vertexBufferIndex, (GLvoid *)pElements[i].offsetInBytes, pElements[i].rate };
                     m_pAttributes[i] = att;
                     break;
                 }
@@ -438,7 +456,7 @@ struct ShaderInputLayout_OpenGL : IShaderInputLayout
                 glBindBuffer(GL_ARRAY_BUFFER, pVertexBuffer->GetGLVertexBuffer());
             }
             
-            glVertexAttribPointer(m_pAttributes[i].location, m_pAttributes[i].size, m_pAttributes[i].type, GL_FALSE, pVertexBuffer->GetVertexSizeInBytes(), m_pAttributes[i].offsetInBytes);
+            glVertexAttribPointer(m_pAttributes[i].location, m_pAttributes[i].size, m_pAttributes[i].type, m_pAttributes[i].normalized, pVertexBuffer->GetVertexSizeInBytes(), m_pAttributes[i].offsetInBytes);
             glEnableVertexAttribArray(m_pAttributes[i].location);
             
             if (false) // Todo: Vertex attrib devisor (opengl 3.3 and higher)
@@ -523,6 +541,12 @@ struct ConstantBuffer_OpenGL : IConstantBuffer
     {
         memcpy(m_pData, pData, m_sizeInBytes);
     }
+
+    void SetData(const char* pData, unsigned int offsetInBytes, unsigned int sizeInBytes)
+    {
+        mini3d_assert(offsetInBytes + sizeInBytes <= m_sizeInBytes, "Constant buffer update is out of range!");
+        memcpy(m_pData + offsetInBytes, pData, sizeInBytes);
+    }
     
     void ApplyUniforms()
     {
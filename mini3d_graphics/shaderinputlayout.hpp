@@ -16,7 +16,10 @@ struct IGraphicsService;
 struct IShaderInputLayout
 {
 
-    enum DataType { R32_FLOAT, R32G32_FLOAT, R32G32B32_FLOAT, R32G32B32A32_FLOAT };
+    // SNORM and UNORM types are read as floats in [-1, 1] and [0, 1], UINT as integers (floats in GLSL)
+    enum DataType { R32_FLOAT, R32G32_FLOAT, R32G32B32_FLOAT, R32G32B32A32_FLOAT,
+                    R16G16_FLOAT, R16G16B16A16_FLOAT, R16G16_SNORM, R16G16B16A16_SNORM,
+                    R8G8B8A8_UNORM, R8G8B8A8_UINT, R10G10B10A2_UNORM };
     enum StreamRate { PER_VERTEX = 0, PER_INSTANCE = 1 };
 
     // HLSL shaders bind vertex buffer input on semantic and semantic index.
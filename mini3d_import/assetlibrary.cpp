@@ -6,6 +6,7 @@
 
 #include "assetlibrary.hpp"
 #include "importers/mini3d/mini3dimporter.hpp"
+#include "common/mappedfile.hpp"
 
 #include <cstring>
 #include <cstdio>
@@ -15,6 +16,63 @@ void mini3d_assert(bool expression, const char* text, ...);
 
 using namespace mini3d::import;
 
+namespace {
+
+// Animation rotates every joint rotation by the joint roll, roll * rot / roll, which
+// turns the axis of rot by roll and keeps its angle. The matrix does that in 9
+// multiplications instead of two quaternion products per joint and frame.
+void SetRollBasis(Joint* joint)
+{
+    const float x = joint->roll[0], y = joint->roll[1], z = joint->roll[2], w = joint->roll[3];
+    float n = x*x + y*y + z*z + w*w;
+    float s = (n > 0) ? 2.0f / n : 0;
+
+    float* m = joint->rollBasis;
+    m[0] = 1 - s*(y*y + z*z);   m[1] = s*(x*y - w*z);       m[2] = s*(x*z + w*y);
+    m[3] = s*(x*y + w*z);       m[4] = 1 - s*(x*x + z*z);   m[5] = s*(y*z - w*x);
+    m[6] = s*(x*z - w*y);       m[7] = s*(y*z + w*x);       m[8] = 1 - s*(x*x + y*y);
+}
+
+}
+
+AssetLibrary::~AssetLibrary()
+{
+    // Assets are destroyed after this, which does not touch the data they do not own
+    delete mappedFile;
+}
+
+void AssetLibrary::BuildIndex()
+{
+    // Material textures point to library textures, which are hashed again by their material
+    textures.BuildIndex(&arena);
+    meshes.BuildIndex(&arena);
+    materials.BuildIndex(&arena);
+    armatures.BuildIndex(&arena);
+    actions.BuildIndex(&arena);
+    scenes.BuildIndex(&arena);
+
+    for (unsigned int i = 0; i < materials.count; ++i)
+        materials.array[i].textures.BuildIndex(&arena);
+
+    for (unsigned int i = 0; i < armatures.count; ++i)
+    {
+        armatures.array[i].joints.BuildIndex(&arena);
+        for (unsigned int j = 0; j < armatures.array[i].joints.count; ++j)
+            SetRollBasis(armatures.array[i].joints.array + j);
+    }
+
+    for (unsigned int i = 0; i < actions.count; ++i)
+        for (unsigned int j = 0; j < actions.array[i].channels.count; ++j)
+            actions.array[i].channels.array[j].boneNameHash = NameHash(actions.array[i].channels.array[j].boneName.array);
+
+    for (unsigned int i = 0; i < scenes.count; ++i)
+    {
+        scenes.array[i].objects.BuildIndex(&arena);
+        scenes.array[i].lights.BuildIndex(&arena);
+        scenes.array[i].cameras.BuildIndex(&arena);
+    }
+}
+
 AssetLibrary* AssetLibrary::LoadFromFile(const char* filename)
 {
     // find the file name ending
@@ -22,7 +80,7 @@ AssetLibrary* AssetLibrary::LoadFromFile(const char* filename)
     mini3d_assert(pos != 0, "Faled to identify file ending for file: %s", filename);
 
     // Convert file name ending to upper case
-    AutoString ending(strdup(pos));
+    AutoString ending(strcpy(new char[strlen(pos) + 1], pos));
     for(unsigned int i = 0; i < ending.count; ++i) 
         ending.array[i] = toupper(ending.array[i]);
 
@@ -9,6 +9,8 @@
 
 #include <cstring>
 
+#include "common/arena.hpp"
+
 void mini3d_assert(bool expression, const char* text, ...);
 
 // Vertex Data Structure
@@ -21,19 +23,24 @@ const unsigned int NO_BONE_PARENT = 0xffff;
 
 ////////// HELPER CLASSES ///////////////////////////////////////////////////////
 
+// owner false means array points into memory owned by someone else, like the
+// mapped file or the arena of an AssetLibrary, and is not deleted
 template <typename T> 
 struct AutoArray
 {
-    ~AutoArray()                                                        { delete[] array; }
+    AutoArray() : array(0), count(0), owner(true)                       {}
+    ~AutoArray()                                                        { if (owner) delete[] array; }
 
     T* array; 
     unsigned int count; 
+    bool owner;
 };
 
+// delete[] destroys the objects of an owned array, others are destroyed in place
 template <typename T> 
 struct AutoObjectArray : AutoArray<T>
 {
-    ~AutoObjectArray()                                                  { for (unsigned int i = 0; i < count; ++i) (array + i)->~T(); }
+    ~AutoObjectArray()                                                  { if (!this->owner) for (unsigned int i = 0; i < this->count; ++i) (this->array + i)->~T(); }
 };
 
 struct AutoString : AutoArray<char>
@@ -47,17 +54,100 @@ struct AutoString : AutoArray<char>
     bool operator == (AutoString &rhs)                                  { return !strcmp(array, rhs.array); }
 };
 
+// 32 bit FNV-1a hash of a name. Names are looked up and bound by their hash and
+// only compared as strings when the hashes match.
+inline unsigned int NameHash(const char* name)
+{
+    unsigned int hash = 2166136261u;
+    for (; *name; ++name)
+        hash = (hash ^ (unsigned char)*name) * 16777619u;
+    return hash;
+}
+
 struct NamedResource 
 { 
     AutoString name; 
+    unsigned int nameHash;
     unsigned int index; 
 };
 
+// Finds assets by name through an open addressing hash table of element indices,
+// built by BuildIndex once the array is filled and again after adding or renaming
+// elements. An array without an index, or with a different count than when it
+// was indexed, is searched front to back. With duplicate names the first one is
+// found. T is a NamedResource or a pointer to one.
 template <typename T> 
 struct AssetArray : AutoObjectArray<T>
 { 
-    T* Find(const char* name)                                           { return (T*) bsearch(name, array, count, sizeof(T), &cmp); }
-    static int cmp(const void* a, const void* b)                        { return strcmp((const char*)a, ((NamedResource*)b)->name.array); }
+    AssetArray() : pIndex(0), indexMask(0), indexCount(0), indexOwner(true) {}
+    ~AssetArray()                                                       { if (indexOwner) delete[] pIndex; }
+
+    T* Find(const char* name)                                           { return Find(NameHash(name), name); }
+
+    // name can be 0 to match on the hash alone
+    T* Find(unsigned int hash, const char* name)
+    {
+        if (pIndex == 0 || indexCount != this->count)
+        {
+            for (unsigned int i = 0; i < this->count; ++i)
+                if (Resource(this->array[i]) && NameHash(Resource(this->array[i])->name.array) == hash && Matches(Resource(this->array[i]), name))
+                    return this->array + i;
+            return 0;
+        }
+
+        for (unsigned int slot = hash & indexMask; pIndex[slot] != EMPTY_SLOT; slot = (slot + 1) & indexMask)
+            if (Resource(this->array[pIndex[slot]])->nameHash == hash && Matches(Resource(this->array[pIndex[slot]]), name))
+                return this->array + pIndex[slot];
+        return 0;
+    }
+
+    // Hashes the names of the elements and indexes them, at most half of the slots are
+    // used. The index is allocated in pArena when there is one.
+    void BuildIndex(Arena* pArena = 0)
+    {
+        if (indexOwner)
+            delete[] pIndex;
+        pIndex = 0;
+        indexCount = this->count;
+        indexOwner = (pArena == 0);
+        if (this->count == 0)
+            return;
+
+        unsigned int slots = 2;
+        while (slots < this->count * 2)
+            slots *= 2;
+
+        pIndex = pArena ? (unsigned int*)pArena->Allocate(slots * sizeof(unsigned int), sizeof(unsigned int)) : new unsigned int[slots];
+        memset(pIndex, 0xff, slots * sizeof(unsigned int));
+        indexMask = slots - 1;
+
+        for (unsigned int i = 0; i < this->count; ++i)
+        {
+            NamedResource* resource = Resource(this->array[i]);
+            if (resource == 0)
+                continue;
+
+            resource->nameHash = NameHash(resource->name.array);
+
+            unsigned int slot = resource->nameHash & indexMask;
+            while (pIndex[slot] != EMPTY_SLOT)
+                slot = (slot + 1) & indexMask;
+            pIndex[slot] = i;
+        }
+    }
+
+private:
+    static const unsigned int EMPTY_SLOT = 0xffffffff;
+
+    // Arrays of pointers can hold 0, like a material texture slot without a texture
+    static NamedResource* Resource(NamedResource &resource)             { return &resource; }
+    static NamedResource* Resource(NamedResource* resource)             { return resource; }
+    static bool Matches(NamedResource* resource, const char* name)      { return name == 0 || !strcmp(resource->name.array, name); }
+
+    unsigned int* pIndex;
+    unsigned int indexMask;
+    unsigned int indexCount;
+    bool indexOwner;
 };
 
 
@@ -66,6 +156,7 @@ struct AssetArray : AutoObjectArray<T>
 struct Mesh;
 struct Material;
 struct Texture;
+class MappedFile;
 
 struct Object: public NamedResource
 {
@@ -123,6 +214,11 @@ struct Mesh : public NamedResource
 
     unsigned int indexSizeInBytes;
 	AutoArray<char> indexData;
+
+    // Model space bounds of the POSITION attribute, computed at load time
+    float boundsMin[3];
+    float boundsMax[3];
+    float boundingSphere[4]; // center x, y, z and radius
 };
 
 struct Material : public NamedResource
@@ -140,6 +236,7 @@ struct Joint : public NamedResource
     Joint* parent;
 	float offset[4];
     float roll[4];
+    float rollBasis[9];     // roll as a row major rotation matrix, set by AssetLibrary::BuildIndex
 };
 
 struct Armature : public NamedResource
@@ -147,11 +244,31 @@ struct Armature : public NamedResource
     AssetArray<Joint> joints;
 };
 
+// Keys of a Channel compressed by the exporter, see CompressedClip. frames holds
+// keyCount 16 bit frame indices at sampleRate, values the 16 bit words of every key.
+// keyCount is 0 when the file has none and the keys are compressed at load time.
+struct CompressedKeys
+{
+    CompressedKeys() : keyCount(0)                                      {}
+
+    unsigned int keyCount;
+    unsigned int encoding;      // CompressedClip::Encoding
+    float sampleRate;
+    float tolerance;
+    float minimum[4];
+    float scale[4];
+    AutoArray<char> frames;
+    AutoArray<char> values;
+};
+
 struct Channel
 {
     AutoString boneName;
+    unsigned int boneNameHash;  // NameHash of boneName, to find the joint in Armature::joints
     enum Type { POSITION, ROTATION, SCALE } type;
     AutoArray<char> animationData;
+    AutoArray<char> tangents;   // in and out tangent of every key, empty when the file has none
+    CompressedKeys compressed;
 };
 
 struct Action : public NamedResource
@@ -163,8 +280,24 @@ struct Action : public NamedResource
 struct AssetLibrary
 {
     static AssetLibrary* LoadFromFile(const char* filename);
-    
-    // true means autodelete array contents in array destructor
+
+    AssetLibrary() : mappedFile(0)                                      {}
+    ~AssetLibrary();
+
+    // Hashes all names and builds the name index of every AssetArray in the arena, and
+    // sets Joint::rollBasis from Joint::roll. The importers call it after loading, call
+    // it again after adding or renaming assets or changing a joint roll.
+    void BuildIndex();
+
+    // The file the library was loaded from when it is kept mapped, vertex, index and
+    // animation data that are not owned by their AutoArray point into it
+    MappedFile* mappedFile;
+
+    // Holds the asset arrays, the names and data that are not in the mapped file and
+    // the name indices of a loaded library. It is freed after the assets are destroyed
+    // in place, in one delete per block.
+    Arena arena;
+
     AssetArray<Scene> scenes;
     AssetArray<Mesh> meshes;
     AssetArray<Material> materials;
@@ -0,0 +1,321 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#include "assetstreamer.hpp"
+#include "assetlibrary.hpp"
+
+#include "common/mappedfile.hpp"
+#include "importers/mini3d/mini3dimporter.hpp"
+#include "../mini3d_system/arrays.hpp"
+
+#include <cstring>
+
+using namespace mini3d::import;
+using namespace mini3d::system;
+
+
+////////// JOB QUEUE ////////////////////////////////////////////////////////////
+
+void AssetStreamer::JobQueue::Push(StreamJob* pJob)
+{
+    if (m_count == m_capacity)
+    {
+        m_capacity = m_capacity ? m_capacity * 2 : 32;
+        ResizeArray(m_ppJobs, m_count, m_capacity);
+    }
+
+    Place(pJob, m_count++);
+    SiftUp(m_count - 1);
+}
+
+StreamJob* AssetStreamer::JobQueue::Pop()
+{
+    if (m_count == 0)
+        return 0;
+
+    StreamJob* pJob = m_ppJobs[0];
+    Remove(pJob);
+    return pJob;
+}
+
+void AssetStreamer::JobQueue::Remove(StreamJob* pJob)
+{
+    unsigned int index = pJob->m_heapIndex;
+    --m_count;
+    if (index == m_count)
+        return;
+
+    Place(m_ppJobs[m_count], index);
+    Reorder(m_ppJobs[index]);
+}
+
+void AssetStreamer::JobQueue::Reorder(StreamJob* pJob)
+{
+    SiftUp(pJob->m_heapIndex);
+    SiftDown(pJob->m_heapIndex);
+}
+
+void AssetStreamer::JobQueue::SiftUp(unsigned int index)
+{
+    StreamJob* pJob = m_ppJobs[index];
+    while (index > 0 && Before(pJob, m_ppJobs[(index - 1) / 2]))
+    {
+        Place(m_ppJobs[(index - 1) / 2], index);
+        index = (index - 1) / 2;
+    }
+    Place(pJob, index);
+}
+
+void AssetStreamer::JobQueue::SiftDown(unsigned int index)
+{
+    StreamJob* pJob = m_ppJobs[index];
+    for (;;)
+    {
+        unsigned int child = index * 2 + 1;
+        if (child >= m_count)
+            break;
+        if (child + 1 < m_count && Before(m_ppJobs[child + 1], m_ppJobs[child]))
+            ++child;
+        if (!Before(m_ppJobs[child], pJob))
+            break;
+
+        Place(m_ppJobs[child], index);
+        index = child;
+    }
+    Place(pJob, index);
+}
+
+
+////////// STAGE ////////////////////////////////////////////////////////////////
+
+void AssetStreamer::Stage::Init(AssetStreamer* pStreamer, JobQueue* pInput, JobQueue* pOutput, ICondition* pWork, ICondition* pOutputWork, bool decode)
+{
+    this->pStreamer = pStreamer;
+    this->pInput = pInput;
+    this->pOutput = pOutput;
+    this->pWork = pWork;
+    this->pOutputWork = pOutputWork;
+    this->decode = decode;
+    started = false;
+    pThread = IThread::New(this);
+}
+
+void AssetStreamer::Stage::Run()
+{
+    for (;;)
+    {
+        StreamJob* pJob;
+        {
+            Lock lock(pStreamer->m_pMutex);
+            while (pInput->GetCount() == 0 && !pStreamer->m_exit)
+                pWork->Wait(pStreamer->m_pMutex);
+
+            // The destructor cancels what is left in the queues
+            if (pStreamer->m_exit)
+                return;
+
+            pJob = pInput->Pop();
+        }
+
+        // Failed and cancelled jobs pass through to Update, which discards them
+        if (!pJob->m_failed && !pJob->m_cancelled)
+            pJob->m_failed = decode ? !pJob->Decode() : !pJob->Read();
+
+        Lock lock(pStreamer->m_pMutex);
+        pOutput->Push(pJob);
+        if (pOutputWork)
+            pOutputWork->Signal();
+    }
+}
+
+
+////////// ASSET STREAMER ///////////////////////////////////////////////////////
+
+AssetStreamer::AssetStreamer(unsigned int workerCount) : m_exit(false), m_workerCount(workerCount ? workerCount : 1), m_sequence(0), m_pendingCount(0)
+{
+    m_pMutex = IMutex::New();
+    m_pReadWork = ICondition::New();
+    m_pDecodeWork = ICondition::New();
+
+    m_ioStage.Init(this, &m_reading, &m_decoding, m_pReadWork, m_pDecodeWork, false);
+
+    m_pWorkerStages = new Stage[m_workerCount];
+    for (unsigned int i = 0; i < m_workerCount; ++i)
+        m_pWorkerStages[i].Init(this, &m_decoding, &m_loaded, m_pDecodeWork, 0, true);
+}
+
+AssetStreamer::~AssetStreamer()
+{
+    {
+        Lock lock(m_pMutex);
+        m_exit = true;
+        m_pReadWork->Broadcast();
+        m_pDecodeWork->Broadcast();
+    }
+
+    m_ioStage.pThread->Join();
+    for (unsigned int i = 0; i < m_workerCount; ++i)
+        m_pWorkerStages[i].pThread->Join();
+
+    JobQueue* queues[3] = { &m_reading, &m_decoding, &m_loaded };
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        for (StreamJob* pJob; (pJob = queues[i]->Pop()) != 0; )
+        {
+            pJob->Discard();
+            pJob->m_state = StreamJob::CANCELLED;
+        }
+    }
+
+    delete m_ioStage.pThread;
+    for (unsigned int i = 0; i < m_workerCount; ++i)
+        delete m_pWorkerStages[i].pThread;
+
+    delete[] m_pWorkerStages;
+    delete m_pDecodeWork;
+    delete m_pReadWork;
+    delete m_pMutex;
+}
+
+void AssetStreamer::Request(StreamJob* pJob, int priority)
+{
+    mini3d_assert(pJob->m_state != StreamJob::QUEUED, "Requesting a stream job that is already queued");
+
+    pJob->m_state = StreamJob::QUEUED;
+    pJob->m_failed = false;
+    pJob->m_cancelled = false;
+    ++m_pendingCount;
+
+    {
+        Lock lock(m_pMutex);
+        m_reading.Push(pJob, priority, m_sequence++);
+        m_pReadWork->Signal();
+    }
+
+    StartStages();
+}
+
+void AssetStreamer::SetPriority(StreamJob* pJob, int priority)
+{
+    Lock lock(m_pMutex);
+
+    // A job that is being read or decoded keeps its new priority for the next step
+    if (m_reading.Contains(pJob))
+        m_reading.Reorder(pJob, priority);
+    else if (m_decoding.Contains(pJob))
+        m_decoding.Reorder(pJob, priority);
+    else if (m_loaded.Contains(pJob))
+        m_loaded.Reorder(pJob, priority);
+    else
+        pJob->m_priority = priority;
+}
+
+void AssetStreamer::Cancel(StreamJob* pJob)
+{
+    if (pJob->m_state != StreamJob::QUEUED)
+        return;
+
+    bool removed = true;
+    {
+        Lock lock(m_pMutex);
+        if (m_reading.Contains(pJob))
+            m_reading.Remove(pJob);
+        else if (m_decoding.Contains(pJob))
+            m_decoding.Remove(pJob);
+        else if (m_loaded.Contains(pJob))
+            m_loaded.Remove(pJob);
+        else
+            removed = false;
+
+        pJob->m_cancelled = true;
+    }
+
+    if (removed)
+    {
+        pJob->Discard();
+        pJob->m_state = StreamJob::CANCELLED;
+        --m_pendingCount;
+    }
+}
+
+unsigned int AssetStreamer::Update(unsigned int maxFinalize)
+{
+    unsigned int finalized = 0;
+    while (maxFinalize == 0 || finalized < maxFinalize)
+    {
+        StreamJob* pJob;
+        {
+            Lock lock(m_pMutex);
+            pJob = m_loaded.Pop();
+        }
+
+        if (pJob == 0)
+            break;
+
+        --m_pendingCount;
+
+        if (pJob->m_cancelled || pJob->m_failed)
+        {
+            pJob->Discard();
+            pJob->m_state = pJob->m_cancelled ? StreamJob::CANCELLED : StreamJob::FAILED;
+            continue;
+        }
+
+        pJob->Finalize();
+        pJob->m_state = StreamJob::READY;
+        ++finalized;
+    }
+
+    return finalized;
+}
+
+void AssetStreamer::StartStages()
+{
+    // A thread that can not be started is tried again with the next Request, its
+    // jobs wait in the queue until then
+    m_ioStage.started = m_ioStage.started || m_ioStage.pThread->Run();
+    for (unsigned int i = 0; i < m_workerCount; ++i)
+        m_pWorkerStages[i].started = m_pWorkerStages[i].started || m_pWorkerStages[i].pThread->Run();
+}
+
+
+////////// LIBRARY STREAM JOB ///////////////////////////////////////////////////
+
+LibraryStreamJob::LibraryStreamJob(const char* filename) : m_pMappedFile(0), m_pLibrary(0)
+{
+    m_pFilename = strcpy(new char[strlen(filename) + 1], filename);
+}
+
+LibraryStreamJob::~LibraryStreamJob()
+{
+    delete[] m_pFilename;
+}
+
+bool LibraryStreamJob::Read()
+{
+    m_pMappedFile = MappedFile::Open(m_pFilename);
+    if (m_pMappedFile == 0)
+        return false;
+
+    m_pMappedFile->Prefetch();
+    return true;
+}
+
+bool LibraryStreamJob::Decode()
+{
+    // The library takes over the mapping, also when it fails
+    Mini3dImporter importer;
+    m_pLibrary = importer.LoadSceneFromMappedFile(m_pMappedFile);
+    m_pMappedFile = 0;
+    return m_pLibrary != 0;
+}
+
+void LibraryStreamJob::Discard()
+{
+    delete m_pMappedFile;
+    delete m_pLibrary;
+    m_pMappedFile = 0;
+    m_pLibrary = 0;
+}
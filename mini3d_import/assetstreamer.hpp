@@ -0,0 +1,212 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_ASSETSTREAMER_H
+#define MINI3D_ASSETSTREAMER_H
+
+#include "../mini3d_system/threads.hpp"
+
+#include <atomic>
+
+namespace mini3d {
+namespace import {
+
+struct AssetLibrary;
+class MappedFile;
+
+
+////////// STREAM JOB ///////////////////////////////////////////////////////////
+
+// One asset loaded by an AssetStreamer in three steps: Read on the I/O thread,
+// Decode on a worker thread and Finalize on the thread calling Update, which is
+// where GPU resources are created. Read and Decode return false when they fail,
+// the job then skips to Discard. Discard is called on the Update thread instead
+// of Finalize for failed and cancelled jobs, to free what Read and Decode made.
+//
+// The job is its own handle: poll GetState after Update. The streamer never
+// deletes jobs, and a job must not be deleted or requested again while QUEUED.
+class StreamJob
+{
+public:
+
+    enum State { IDLE = 0, QUEUED = 1, READY = 2, FAILED = 3, CANCELLED = 4 };
+
+    StreamJob() : m_state(IDLE), m_priority(0), m_sequence(0), m_heapIndex(0), m_failed(false), m_cancelled(false) {}
+    virtual ~StreamJob() {};
+
+    State GetState() const                                              { return m_state; }
+    int GetPriority() const                                             { return m_priority; }
+
+protected:
+
+    virtual bool Read()                                                 { return true; }
+    virtual bool Decode()                                               { return true; }
+    virtual void Finalize()                                             {}
+    virtual void Discard()                                              {}
+
+    // Long Read and Decode steps can poll this and return early. Cancel sets it on the
+    // calling thread while the step runs, so it is atomic.
+    bool IsCancelled() const                                            { return m_cancelled; }
+
+private:
+
+    friend class AssetStreamer;
+
+    StreamJob(const StreamJob&);
+    StreamJob& operator =(const StreamJob&);
+
+    State m_state;
+    int m_priority;
+    unsigned int m_sequence;
+    unsigned int m_heapIndex;
+    bool m_failed;
+    std::atomic<bool> m_cancelled;
+};
+
+
+////////// ASSET STREAMER ///////////////////////////////////////////////////////
+
+// Loads StreamJobs in the background. One I/O thread reads files in priority
+// order so the disk is never asked for two things at once, workerCount threads
+// decode, and Update finalizes the loaded jobs on the calling thread. Every step
+// takes the job with the highest priority first, jobs with the same priority in
+// the order they were requested. Give what is visible a higher priority than
+// what is not, and raise it with SetPriority when that changes.
+//
+// The threads are started by the first Request and wait for work when there is
+// none, a job is read and decoded as soon as a thread is free for it and waits
+// for the next Update to be finalized. Request, SetPriority, Cancel and Update
+// must be called from the same thread.
+
+class AssetStreamer
+{
+public:
+
+    AssetStreamer(unsigned int workerCount = 1);
+
+    // Waits for the threads to finish the step they are running and cancels
+    // everything queued
+    ~AssetStreamer();
+
+    void Request(StreamJob* pJob, int priority = 0);
+    void SetPriority(StreamJob* pJob, int priority);
+
+    // A job waiting for a thread is CANCELLED right away, one that is being read
+    // or decoded when its thread is done with it, in a later Update
+    void Cancel(StreamJob* pJob);
+
+    // Finalizes at most maxFinalize loaded jobs, 0 for all of them, so that GPU
+    // uploads can be spread over frames. Returns the number finalized.
+    unsigned int Update(unsigned int maxFinalize = 0);
+
+    // Jobs requested and not yet READY, FAILED or CANCELLED
+    unsigned int GetPendingCount() const                                { return m_pendingCount; }
+
+    // Binary heap of jobs, highest priority and then lowest sequence on top. The
+    // streamer has one for each step, it is public so it can be tested on its own.
+    class JobQueue
+    {
+    public:
+        JobQueue() : m_ppJobs(0), m_count(0), m_capacity(0) {}
+        ~JobQueue()                                                     { delete[] m_ppJobs; }
+
+        unsigned int GetCount() const                                   { return m_count; }
+        void Push(StreamJob* pJob, int priority, unsigned int sequence) { pJob->m_priority = priority; pJob->m_sequence = sequence; Push(pJob); }
+        void Push(StreamJob* pJob);
+        StreamJob* Pop();
+        bool Contains(const StreamJob* pJob) const                      { return pJob->m_heapIndex < m_count && m_ppJobs[pJob->m_heapIndex] == pJob; }
+        void Remove(StreamJob* pJob);
+        void Reorder(StreamJob* pJob, int priority)                     { pJob->m_priority = priority; Reorder(pJob); }
+        void Reorder(StreamJob* pJob);
+
+    private:
+        static bool Before(const StreamJob* a, const StreamJob* b)      { return (a->m_priority != b->m_priority) ? a->m_priority > b->m_priority : (int)(a->m_sequence - b->m_sequence) < 0; }
+        void Place(StreamJob* pJob, unsigned int index)                 { m_ppJobs[index] = pJob; pJob->m_heapIndex = index; }
+        void SiftUp(unsigned int index);
+        void SiftDown(unsigned int index);
+
+        StreamJob** m_ppJobs;
+        unsigned int m_count;
+        unsigned int m_capacity;
+    };
+
+private:
+
+    AssetStreamer(const AssetStreamer&);
+    AssetStreamer& operator =(const AssetStreamer&);
+
+    // Takes jobs from pInput, runs one step on them and passes them to pOutput,
+    // signalling pOutputWork. Waits on pWork while pInput is empty, until the
+    // streamer exits.
+    struct Stage : system::IRunnable
+    {
+        AssetStreamer* pStreamer;
+        JobQueue* pInput;
+        JobQueue* pOutput;
+        system::ICondition* pWork;
+        system::ICondition* pOutputWork;    // 0 for the last step
+        bool decode;
+        bool started;
+        system::IThread* pThread;
+
+        void Init(AssetStreamer* pStreamer, JobQueue* pInput, JobQueue* pOutput, system::ICondition* pWork, system::ICondition* pOutputWork, bool decode);
+        void Run();
+    };
+
+    void StartStages();
+
+    // The queues, m_exit and the jobs in the queues are guarded by m_pMutex.
+    // m_pReadWork wakes the I/O thread, m_pDecodeWork a worker.
+    system::IMutex* m_pMutex;
+    system::ICondition* m_pReadWork;
+    system::ICondition* m_pDecodeWork;
+    JobQueue m_reading;
+    JobQueue m_decoding;
+    JobQueue m_loaded;
+    bool m_exit;
+
+    Stage m_ioStage;
+    Stage* m_pWorkerStages;
+    unsigned int m_workerCount;
+
+    unsigned int m_sequence;
+    unsigned int m_pendingCount;
+};
+
+
+////////// LIBRARY STREAM JOB ///////////////////////////////////////////////////
+
+// Loads a .m3d file into an AssetLibrary. Read maps the file and brings its pages
+// into memory, Decode parses it with Mini3dImporter. The library is the caller's
+// once the job is READY.
+class LibraryStreamJob : public StreamJob
+{
+public:
+
+    LibraryStreamJob(const char* filename);
+    ~LibraryStreamJob();
+
+    const char* GetFilename() const                                     { return m_pFilename; }
+
+    // 0 until the job is READY
+    AssetLibrary* GetLibrary() const                                    { return (GetState() == READY) ? m_pLibrary : 0; }
+
+protected:
+
+    bool Read();
+    bool Decode();
+    void Discard();
+
+private:
+
+    char* m_pFilename;
+    MappedFile* m_pMappedFile;
+    AssetLibrary* m_pLibrary;
+};
+
+}
+}
+
+#endif
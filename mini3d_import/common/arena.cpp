@@ -0,0 +1,73 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#include "arena.hpp"
+
+#include <stdint.h>
+
+using namespace mini3d::import;
+
+// Alignment of the first allocation in a block
+const size_t BLOCK_ALIGNMENT = 16;
+
+// alignment is a power of two
+inline char* Align(char* p, size_t alignment) { return (char*)(((uintptr_t)p + alignment - 1) & ~(uintptr_t)(alignment - 1)); }
+
+Arena::~Arena()
+{
+    while (m_pBlocks)
+    {
+        Block* pNext = m_pBlocks->pNext;
+        delete[] (char*)m_pBlocks;
+        m_pBlocks = pNext;
+    }
+}
+
+void Arena::Reserve(size_t size)
+{
+    if (m_pBlocks == 0 || (size_t)(m_pBlocks->pEnd - m_pBlocks->pCursor) < size)
+        AddBlock(size, false);
+}
+
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+    if (m_pBlocks)
+    {
+        char* p = Align(m_pBlocks->pCursor, alignment);
+        if (p <= m_pBlocks->pEnd && size <= (size_t)(m_pBlocks->pEnd - p))
+        {
+            m_pBlocks->pCursor = p + size;
+            return p;
+        }
+    }
+
+    // A new block is only aligned to BLOCK_ALIGNMENT, so an allocation that might not fit
+    // in DEFAULT_BLOCK_SIZE once aligned gets a block of its own. It goes behind the
+    // current block, which keeps the rest of its room for the allocations after it.
+    // Otherwise the rest of the current block is left unused.
+    Block* pBlock = (size + alignment > DEFAULT_BLOCK_SIZE) ? AddBlock(size + alignment, true) : AddBlock(DEFAULT_BLOCK_SIZE, false);
+    char* p = Align(pBlock->pCursor, alignment);
+    pBlock->pCursor = p + size;
+    return p;
+}
+
+Arena::Block* Arena::AddBlock(size_t size, bool behind)
+{
+    // The block header is at the start of its own allocation
+    size_t headerSize = (sizeof(Block) + BLOCK_ALIGNMENT - 1) & ~(BLOCK_ALIGNMENT - 1);
+    char* pMemory = new char[headerSize + size];
+
+    Block* pBlock = (Block*)pMemory;
+    pBlock->pCursor = pMemory + headerSize;
+    pBlock->pEnd = pMemory + headerSize + size;
+
+    Block** ppLink = (behind && m_pBlocks) ? &m_pBlocks->pNext : &m_pBlocks;
+    pBlock->pNext = *ppLink;
+    *ppLink = pBlock;
+
+    ++m_blockCount;
+    m_size += size;
+    return pBlock;
+}
@@ -0,0 +1,74 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_ARENA_H
+#define MINI3D_ARENA_H
+
+#include <cstddef>
+#include <new>
+
+namespace mini3d {
+namespace import {
+
+// Hands out memory from a few large blocks by moving a pointer and frees all of it
+// at once when it is deleted. Memory is never given back one allocation at a time,
+// and objects in the arena are not destroyed by it, whoever places them destroys
+// them in place. Reserve sizes the next block up front, so that what is known to
+// go in fits in one allocation. Blocks added when it runs out are DEFAULT_BLOCK_SIZE,
+// an allocation that does not fit in one with its alignment gets a block of its own
+// and the current block stays current.
+class Arena
+{
+public:
+
+    static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    Arena() : m_pBlocks(0), m_blockCount(0), m_size(0)                {}
+    ~Arena();
+
+    // Makes sure size bytes can be allocated without adding another block
+    void Reserve(size_t size);
+
+    // alignment is a power of two
+    void* Allocate(size_t size, size_t alignment);
+
+    // Default constructs count Ts, 16 byte aligned
+    template <typename T> T* New(unsigned int count)
+    {
+        T* p = (T*)Allocate(count * sizeof(T), 16);
+        for (unsigned int i = 0; i < count; ++i)
+            new (p + i) T();
+        return p;
+    }
+
+    unsigned int GetBlockCount() const                                  { return m_blockCount; }
+
+    // Bytes in all blocks
+    size_t GetSize() const                                              { return m_size; }
+
+private:
+
+    Arena(const Arena&);
+    Arena& operator =(const Arena&);
+
+    struct Block
+    {
+        Block* pNext;
+        char* pCursor;
+        char* pEnd;
+    };
+
+    // A block of its own for one allocation goes behind the current block
+    Block* AddBlock(size_t size, bool behind);
+
+    Block* m_pBlocks;   // the current block first
+    unsigned int m_blockCount;
+    size_t m_size;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,112 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#include "mappedfile.hpp"
+
+using namespace mini3d::import;
+
+// Smallest page size of the supported platforms
+const size_t PAGE_SIZE_IN_BYTES = 4096;
+
+void MappedFile::Prefetch() const
+{
+    volatile char sink = 0;
+    for (size_t i = 0; i < m_size; i += PAGE_SIZE_IN_BYTES)
+        sink = m_pData[i];
+    (void)sink;
+}
+
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+MappedFile* MappedFile::Open(const char* filename)
+{
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (file == INVALID_HANDLE_VALUE)
+        return 0;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return 0;
+    }
+
+    // An empty file can not be mapped
+    if (size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return new MappedFile(0, 0);
+    }
+
+    // The view keeps the mapping and the file open by itself
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+    CloseHandle(file);
+    if (mapping == 0)
+        return 0;
+
+    char* pData = (char*)MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mapping);
+    if (pData == 0)
+        return 0;
+
+    return new MappedFile(pData, (size_t)size.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_pData)
+        UnmapViewOfFile(m_pData);
+}
+
+#endif
+
+
+#if defined(__linux__) || defined(ANDROID) || defined(__APPLE__)
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+MappedFile* MappedFile::Open(const char* filename)
+{
+    int file = open(filename, O_RDONLY);
+    if (file < 0)
+        return 0;
+
+    struct stat info;
+    if (fstat(file, &info) != 0)
+    {
+        close(file);
+        return 0;
+    }
+
+    // An empty file can not be mapped
+    if (info.st_size == 0)
+    {
+        close(file);
+        return new MappedFile(0, 0);
+    }
+
+    // The mapping keeps the file open by itself
+    void* pData = mmap(0, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    close(file);
+    if (pData == MAP_FAILED)
+        return 0;
+
+    return new MappedFile((char*)pData, (size_t)info.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_pData)
+        munmap(m_pData, m_size);
+}
+
+#endif
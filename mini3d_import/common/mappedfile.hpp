@@ -0,0 +1,44 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MAPPEDFILE_H
+#define MINI3D_MAPPEDFILE_H
+
+#include <cstddef>
+
+namespace mini3d {
+namespace import {
+
+// A whole file mapped into memory, mmap on unix and a file mapping on Windows.
+// The mapping is copy on write: the pages are read from the file when they are
+// first touched and writing to them changes this process's copy only, never
+// the file. Pointers into GetData stay valid until the MappedFile is deleted.
+class MappedFile
+{
+public:
+    // Returns 0 if the file can not be opened or mapped
+    static MappedFile* Open(const char* filename);
+    ~MappedFile();
+
+    char* GetData() const                                               { return m_pData; }
+    size_t GetSize() const                                              { return m_size; }
+
+    // Touches every page so the data is in memory before it is parsed, for loading
+    // on one thread and parsing on another without the parser waiting for the disk
+    void Prefetch() const;
+
+private:
+    MappedFile(char* pData, size_t size) : m_pData(pData), m_size(size) {}
+    MappedFile(const MappedFile&);
+    MappedFile& operator =(const MappedFile&);
+
+    char* m_pData;
+    size_t m_size;
+};
+
+}
+}
+
+#endif
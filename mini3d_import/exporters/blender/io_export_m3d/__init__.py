@@ -8,7 +8,7 @@ bl_info = {
     "name": "Export Mini3d file (.m3d)",
     "description": "This script exports file data to a format that can be used with the Mini3d game enigne framework",
     "author": "Daniel Peterson",
-    "version": (0, 5),
+    "version": (0, 6),
     "blender": (2, 66, 0),
     "location": "File > Export > Mini3d (.m3d)",
     "warning": "Constantly changing format, visit Mini3d website for info", # used for warning icon and text in addons panel
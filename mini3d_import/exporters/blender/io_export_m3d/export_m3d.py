@@ -20,17 +20,101 @@ import mathutils
 from operator import itemgetter
 
 
+########### M3D WRITER ########################################################
+
+# Version 2 .m3d layout, see mini3d_import/importers/mini3d/mini3dformat.hpp
+M3D_MAGIC = 0x3244334d
+M3D_VERSION = 2
+M3D_NONE = 0xffffffff
+M3D_ALIGNMENT = 16
+
+SECTION_STRINGS = 0
+SECTION_DATA = 1
+SECTION_MESHES = 2
+SECTION_ARMATURES = 3
+SECTION_JOINTS = 4
+SECTION_ACTIONS = 5
+SECTION_CHANNELS = 6
+SECTION_TEXTURES = 7
+SECTION_MATERIALS = 8
+SECTION_MATERIAL_TEXTURES = 9
+SECTION_SCENES = 10
+SECTION_OBJECTS = 11
+SECTION_LIGHTS = 12
+SECTION_CAMERAS = 13
+SECTION_COMPRESSED_CHANNELS = 14
+SECTION_CHANNEL_TANGENTS = 15
+SECTION_COUNT = 16
+
+# Collects the records of every section, the string table and the data blobs,
+# and lays them out when the file is saved
+class M3dWriter:
+
+    def __init__(self):
+        self.sections = [bytearray() for i in range(0, SECTION_COUNT)]
+        self.counts = [0] * SECTION_COUNT
+        self.stringOffsets = {}
+        
+        # Asset name to record index, for references between assets
+        self.meshIndices = {}
+        self.materialIndices = {}
+
+    # Offset of the string in the string table, equal strings are stored once
+    def string(self, string):
+        if string not in self.stringOffsets:
+            self.stringOffsets[string] = len(self.sections[SECTION_STRINGS])
+            self.sections[SECTION_STRINGS] += string.encode('UTF-8') + b'\0'
+        return self.stringOffsets[string]
+
+    # Appends the bytes 16 byte aligned to the data section, returns the packed blob
+    def blob(self, bytes):
+        data = self.sections[SECTION_DATA]
+        data += b'\0' * (-len(data) % M3D_ALIGNMENT)
+        offset = len(data)
+        data += bytes
+        return struct.pack('=2Q', offset, len(bytes))
+
+    # Appends a record to a section, returns its index
+    def record(self, section, bytes):
+        self.sections[section] += bytes
+        self.counts[section] += 1
+        return self.counts[section] - 1
+
+    def count(self, section):
+        return self.counts[section]
+
+    def save(self, filename):
+        file = open(filename, 'wb')
+        fw = file.write
+        
+        fw(struct.pack('=4I', M3D_MAGIC, M3D_VERSION, SECTION_COUNT, 0))
+
+        # table of contents, every section 16 byte aligned after it
+        offset = 16 + SECTION_COUNT * 24
+        offsets = []
+        for section in range(0, SECTION_COUNT):
+            offset += -offset % M3D_ALIGNMENT
+            offsets.append(offset)
+            count = 0 if section in (SECTION_STRINGS, SECTION_DATA) else self.counts[section]
+            fw(struct.pack('=2I2Q', section, count, offset, len(self.sections[section])))
+            offset += len(self.sections[section])
+
+        position = 16 + SECTION_COUNT * 24
+        for section in range(0, SECTION_COUNT):
+            fw(b'\0' * (offsets[section] - position))
+            fw(self.sections[section])
+            position = offsets[section] + len(self.sections[section])
+
+        file.close()
+
+        
 ########### WRITE MESH ########################################################
 
-def writeMesh(mesh, file):
-    fw = file.write
+def writeMesh(mesh, writer):
     
     #make sure mesh has tesselated faces
     mesh.update(calc_tessface=True)
     
-    # write name
-    writeLengthPrefixedString(mesh.name, file)
-    
     #find the vertex attributes for this mesh
     attributes = None
 
@@ -73,7 +157,7 @@ def writeMesh(mesh, file):
                 col[face.vertices[3]] = faceData.color4
 
                 
-    # write the size of a vertex in bytes
+    # the size of a vertex in bytes
     vertexSizeInBytes = 0;
     for i in range(0, len(attributes)):
         if attributes[i] == 'POSITION': 
@@ -87,22 +171,18 @@ def writeMesh(mesh, file):
         elif attributes[i] == 'COLOR': 
             vertexSizeInBytes += 3 * 4
             
-    fw(struct.pack('=H', vertexSizeInBytes))
-
-    # write the number of vertices
-    fw(struct.pack('=H', len(mesh.vertices)))
-    
-    # write vertex data
+    # vertex data
+    vertices = bytearray()
     for i in range(0, len(mesh.vertices)):
         for j in range(0, len(attributes)):
             if attributes[j] == 'POSITION':
                 co = mesh.vertices[i].co
-                fw(struct.pack('=3f', co[0], co[1], co[2]))
+                vertices += struct.pack('=3f', co[0], co[1], co[2])
             elif attributes[j] == 'NORMAL': 
                 norm = mesh.vertices[i].normal
-                fw(struct.pack('=3f', norm[0], norm[1], norm[2]))
+                vertices += struct.pack('=3f', norm[0], norm[1], norm[2])
             elif attributes[j] == 'TEXTURE': 
-                fw(struct.pack('=2f', texCo[i][0], texCo[i][1]))
+                vertices += struct.pack('=2f', texCo[i][0], texCo[i][1])
             elif attributes[j] == 'GROUPS':
                 vertex_groups = [(grp.group, grp.weight) for grp in mesh.vertices[i].groups]
                 
@@ -112,24 +192,19 @@ def writeMesh(mesh, file):
                 
                 sorted_vertex_groups = sorted(vertex_groups, key=itemgetter(1), reverse=True)
 
-                for grp in sorted_vertex_groups:
-                    print("grp: ", grp)
-
-                print ("Sum: ", sorted_vertex_groups[0][1] + sorted_vertex_groups[1][1] + sorted_vertex_groups[2][1] + sorted_vertex_groups[3][1])
-                    
-                fw(struct.pack('=4f',
+                vertices += struct.pack('=4f',
                     float(sorted_vertex_groups[0][0]),
                     float(sorted_vertex_groups[1][0]),
                     float(sorted_vertex_groups[2][0]),
-                    float(sorted_vertex_groups[3][0])))
-                fw(struct.pack('=4f',
+                    float(sorted_vertex_groups[3][0]))
+                vertices += struct.pack('=4f',
                     sorted_vertex_groups[0][1],
                     sorted_vertex_groups[1][1],
                     sorted_vertex_groups[2][1],
-                    sorted_vertex_groups[3][1]))
+                    sorted_vertex_groups[3][1])
                     
             elif attributes[j] == 'COLOR':
-                fw(struct.pack('=3f', col[i][0], col[i][1], col[i][2]))
+                vertices += struct.pack('=3f', col[i][0], col[i][1], col[i][2])
                 
     # set indices
     indices=[]
@@ -143,74 +218,204 @@ def writeMesh(mesh, file):
             indices.append(face.vertices[2])
             indices.append(face.vertices[3])
 
-    # write number of indices
-    fw(struct.pack('=H', len(indices)))
-    for index in indices:
-        fw(struct.pack('=H', index))
+    # 16 bit indices unless there are more vertices than they can address
+    indexFormat = 'H' if len(mesh.vertices) <= 0x10000 else 'I'
+    indexSizeInBytes = struct.calcsize('=' + indexFormat)
+    indexData = struct.pack('=%d%s' % (len(indices), indexFormat), *indices)
+
+    writer.meshIndices[mesh.name] = writer.record(SECTION_MESHES,
+        struct.pack('=4I', writer.string(mesh.name), vertexSizeInBytes, indexSizeInBytes, 0) +
+        writer.blob(vertices) +
+        writer.blob(indexData))
         
     
 ########### WRITE ARMATURE ####################################################
 			
-def writeArmature(armature, file):
-    fw = file.write
+def writeArmature(armature, writer):
     
-    # write name
-    writeLengthPrefixedString(armature.name, file)
-    
-	# get indices for all bones
-    bones = armature.bones
+	# order the bones parents first
+    bones = []
+    def addBone(bone):
+        bones.append(bone)
+        for child in bone.children:
+            addBone(child)
+
+    for bone in armature.bones:
+        if not bone.parent:
+            addBone(bone)
+
     bone_indices = {}
     for bone in bones:
-        bone_indices[bone] = len(bone_indices)
+        bone_indices[bone.name] = len(bone_indices)
         
-    # write bone count
-    fw(struct.pack('=H', len(bones)))
+    writer.record(SECTION_ARMATURES, struct.pack('=3I', writer.string(armature.name), writer.count(SECTION_JOINTS), len(bones)))
 
     # write bone data
     for bone in bones:
 
-        offset = mathutils.Vector([0,0,0])
-        
-        #write name
-        writeLengthPrefixedString(bone.name, file)
-    
-        # write parent index
-        if bone.parent:
-            fw(struct.pack('=H', bone_indices[bone.parent]))
-        else:
-            fw(struct.pack('=H', 0xffff))
+        # parent index
+        parent = bone_indices[bone.parent.name] if bone.parent else M3D_NONE
         
-        # write bone coordinates
+        # bone coordinates and roll
         pos = bone.matrix_local.to_translation();
-        fw(struct.pack('=3f', pos[0], pos[1], pos[2]))
-        
-
-        # write bone roll
         roll = bone.matrix_local.to_3x3().to_quaternion();
-        fw(struct.pack('=4f', roll[1], roll[2], roll[3], roll[0]))
+
+        writer.record(SECTION_JOINTS, struct.pack('=2I3f4f', 
+            writer.string(bone.name), 
+            parent,
+            pos[0], pos[1], pos[2],
+            roll[1], roll[2], roll[3], roll[0]))
 
         
 
 ########### WRITE ACTION ######################################################
 
-def writeAction(action, file):
-    fw = file.write
+CHANNEL_TYPES = { 'location' : 0, 'rotation_quaternion' : 1, 'scale' : 2 }
+CHANNEL_ROTATION = 1
+
+
+########### COMPRESS CHANNEL ##################################################
+
+# The key reduction and quantization of CompressedClip::AddChannel, see
+# mini3d_animation/compressedclip.hpp. Keys are (time, values) pairs.
+COMPRESS_TOLERANCE = 1e-4
+COMPRESS_SAMPLE_RATE = 30.0
+
+ENCODING_BOUNDS = 0
+ENCODING_SMALLEST_THREE = 1
+
+def catmullRom(time, t0, v0, t1, v1, tPrev, vPrev, tNext, vNext, normalize):
+    length = t1 - t0
+    s = (time - t0) / length if length != 0 else 0
+    s2 = s * s
+    s3 = s2 * s
+    h00, h01, h10, h11 = 2 * s3 - 3 * s2 + 1, -2 * s3 + 3 * s2, s3 - 2 * s2 + s, s3 - s2
+
+    m0Scale = length / (t1 - tPrev) if vPrev is not None and t1 != tPrev else 0
+    m1Scale = length / (tNext - t0) if vNext is not None and tNext != t0 else 0
+    vPrev = vPrev if vPrev is not None else v0
+    vNext = vNext if vNext is not None else v1
+
+    out = [v0[j] * h00 + v1[j] * h01 + (v1[j] - vPrev[j]) * m0Scale * h10 + (vNext[j] - v0[j]) * m1Scale * h11 for j in range(0, len(v0))]
+    norm = math.sqrt(sum(value * value for value in out))
+    if normalize and norm != 0:
+        out = [value / norm for value in out]
+    return out
+
+def reduceKeys(keys, tolerance, normalize):
+    count = len(keys)
+    keep = [True] * count
+
+    def prevKept(i):
+        while i > 0:
+            i -= 1
+            if keep[i]:
+                break
+        return i
+
+    def nextKept(i):
+        while i < count - 1:
+            i += 1
+            if keep[i]:
+                break
+        return i
+
+    def maxError(first, last):
+        error = 0
+        for i in range(first, last + 1):
+            if keep[i]:
+                continue
+            k0, k1 = prevKept(i), nextKept(i)
+            prev, next = keys[prevKept(k0)], keys[nextKept(k1)]
+            value = catmullRom(keys[i][0], keys[k0][0], keys[k0][1], keys[k1][0], keys[k1][1],
+                prev[0], prev[1] if k0 > 0 else None, next[0], next[1] if k1 < count - 1 else None, normalize)
+            error = max([error] + [abs(value[j] - keys[i][1][j]) for j in range(0, len(value))])
+        return error
+
+    # Removing key i changes the spline from the second kept key before it to the second kept key after it
+    for i in range(1, count - 1):
+        keep[i] = False
+        if maxError(prevKept(prevKept(i)), nextKept(nextKept(i))) > tolerance:
+            keep[i] = True
+
+    # A constant channel keeps only its first key
+    if count > 1 and nextKept(0) == count - 1:
+        keep[count - 1] = not all(abs(key[1][j] - keys[0][1][j]) <= tolerance for key in keys for j in range(0, len(key[1])))
+
+    return keep
+
+def quatToSmallestThree(q):
+    largest = max(range(0, 4), key=lambda j: abs(q[j]))
+    words = [int(math.floor(min(max((q[j] * 1.41421356 + 1) * 0.5, 0), 1) * 32767 + 0.5)) for j in range(0, 4) if j != largest]
+    words[0] |= (largest >> 1) << 15
+    words[1] |= (largest & 1) << 15
+    words[2] |= (q[largest] < 0) << 15
+    return words
+
+# Returns the CompressedChannelRecord of the keys
+def compressChannel(keys, normalize, writer):
+    if not keys:
+        return struct.pack('=2I10f', 0, ENCODING_BOUNDS, *([0.0] * 10)) + writer.blob(b'') + writer.blob(b'')
+
+    components = len(keys[0][1])
+    smallestThree = normalize and components == 4
+    keys = [key for key, kept in zip(keys, reduceKeys(keys, COMPRESS_TOLERANCE, normalize)) if kept]
+
+    minimum = [min(key[1][j] for key in keys) for j in range(0, components)]
+    scale = [(max(key[1][j] for key in keys) - minimum[j]) / 65535 for j in range(0, components)]
+
+    frames = bytearray()
+    values = bytearray()
+    for time, value in keys:
+        frames += struct.pack('=H', int(min(max(math.floor(time * COMPRESS_SAMPLE_RATE + 0.5), 0), 65535)))
+        if smallestThree:
+            values += struct.pack('=3H', *quatToSmallestThree(value))
+        else:
+            values += struct.pack('=%dH' % components, *[int(math.floor((value[j] - minimum[j]) / scale[j] + 0.5)) if scale[j] != 0 else 0 for j in range(0, components)])
+
+    pad = [0.0] * (4 - components)
+    return (struct.pack('=2I2f4f4f', len(keys), ENCODING_SMALLEST_THREE if smallestThree else ENCODING_BOUNDS, COMPRESS_SAMPLE_RATE, COMPRESS_TOLERANCE, *(minimum + pad + scale + pad)) +
+        writer.blob(frames) + writer.blob(values))
 
-    # write name
-    writeLengthPrefixedString(action.name, file)
 
-    #write length
-    fw(struct.pack('=f', action.frame_range[1] / 30.0))
-    
+########### KEY TANGENTS ######################################################
+
+# In and out slope of an fcurve at frame in value per frame. A Bezier key gives the
+# slopes of its handles, anywhere else the evaluated curve is differentiated.
+TANGENT_STEP = 0.01
+
+def keyTangents(fcurve, frame):
+    points = list(fcurve.keyframe_points)
+    slopes = [(fcurve.evaluate(frame) - fcurve.evaluate(frame - TANGENT_STEP)) / TANGENT_STEP,
+              (fcurve.evaluate(frame + TANGENT_STEP) - fcurve.evaluate(frame)) / TANGENT_STEP]
+
+    for i, point in enumerate(points):
+        if point.co[0] != frame:
+            continue
+
+        # The interpolation of a key is that of the segment after it
+        if i > 0 and points[i - 1].interpolation == 'BEZIER' and point.handle_left[0] != frame:
+            slopes[0] = (point.co[1] - point.handle_left[1]) / (frame - point.handle_left[0])
+        if point.interpolation == 'BEZIER' and point.handle_right[0] != frame:
+            slopes[1] = (point.handle_right[1] - point.co[1]) / (point.handle_right[0] - frame)
+        break
+
+    return slopes
+
+
+def writeAction(action, writer):
+
     #group fcurves by data_path name
     channels = { fcurve.data_path : [] for fcurve in action.fcurves }
     
     for fcurve in action.fcurves:
         channels[fcurve.data_path].append(fcurve)
     
-    fw(struct.pack('=H', len(channels)))
+    #channel records of the action, written after it to keep them together
+    records = []
+    compressedRecords = []
+    tangentRecords = []
     
-    #write channels to file
     for channelName in channels:
 
         boneName = ""
@@ -223,9 +428,9 @@ def writeAction(action, file):
         else:
             target = channelName
 
-        #write track bone name
-        writeLengthPrefixedString(boneName, file)
-        writeLengthPrefixedString(target, file)
+        if target not in CHANNEL_TYPES:
+            print("Skipping channel ", channelName, ". Only location, rotation_quaternion and scale are exported")
+            continue
 
         #find all keyframes for all channels in group    
         fcurves = channels[channelName]
@@ -236,106 +441,104 @@ def writeAction(action, file):
 
         keyframes = sorted(keyframes)
 
-        #write subindices count
         zero = [i for i in range(0, len(fcurves))]
-        fw(struct.pack('=H', len(zero)))
         
-        #write keyframe count
-        fw(struct.pack('=H', len(keyframes)))
-
-        #evaluate animated value for all collected keyframes
+        #evaluate animated value for all collected keyframes, the time followed by the value
+        #and the in and out tangents of every key in value per second
+        data = bytearray()
+        tangents = bytearray()
+        keys = []
         for keyframe in keyframes:
             values = list(zero)
+            slopes = [list(zero), list(zero)]
 
             for fcurve in fcurves:
                 values[fcurve.array_index] = fcurve.evaluate(keyframe)
-            
-            fw(struct.pack('=f', keyframe / 30.0))
-            print("Keyframe: ", keyframe, " Value: ", values)
-            
+                slopes[0][fcurve.array_index], slopes[1][fcurve.array_index] = keyTangents(fcurve, keyframe)
+
             if len(values) == 4:
-                fw(struct.pack('=f', values[1]))
-                fw(struct.pack('=f', values[2]))
-                fw(struct.pack('=f', values[3]))
-                fw(struct.pack('=f', values[0]))
-                
-            else:
-                for value in values:
-                    fw(struct.pack('=f', value))
+                values = [values[1], values[2], values[3], values[0]]
+                slopes = [[slope[1], slope[2], slope[3], slope[0]] for slope in slopes]
 
+            data += struct.pack('=f', keyframe / 30.0)
+            for value in values:
+                data += struct.pack('=f', value)
+
+            for slope in slopes:
+                tangents += struct.pack('=%df' % len(slope), *[value * 30.0 for value in slope])
+
+            keys.append((keyframe / 30.0, values))
+
+        records.append(struct.pack('=2I', writer.string(boneName), CHANNEL_TYPES[target]) + writer.blob(data))
+        compressedRecords.append(compressChannel(keys, CHANNEL_TYPES[target] == CHANNEL_ROTATION, writer))
+        tangentRecords.append(writer.blob(tangents))
+
+    writer.record(SECTION_ACTIONS, struct.pack('=If2I', writer.string(action.name), action.frame_range[1] / 30.0, writer.count(SECTION_CHANNELS), len(records)))
+    for record in records:
+        writer.record(SECTION_CHANNELS, record)
+    for record in compressedRecords:
+        writer.record(SECTION_COMPRESSED_CHANNELS, record)
+    for record in tangentRecords:
+        writer.record(SECTION_CHANNEL_TANGENTS, record)
 
                 
 ########### WRITE MATERIAL ####################################################
 			
-def writeMaterial(material, file):
-    fw = file.write
-        
-    # write name
-    writeLengthPrefixedString(material.name, file)        
+def writeMaterial(material, writer):
         
-    # write texture count
     texture_slots = [bpy.data.textures[x.name] for x in material.texture_slots if x]
     print("texture slots: ", len(texture_slots))
-    fw(struct.pack('=H', len(texture_slots)))
 
-    # write textures data
+    writer.materialIndices[material.name] = writer.record(SECTION_MATERIALS,
+        struct.pack('=3I', writer.string(material.name), writer.count(SECTION_MATERIAL_TEXTURES), len(texture_slots)))
+
+    # texture links
     for texture in texture_slots:
         if texture.type == 'IMAGE' and texture.image:
-            fw(struct.pack('=H', bpy.data.images.find(texture.image.name)))
+            writer.record(SECTION_MATERIAL_TEXTURES, struct.pack('=I', bpy.data.images.find(texture.image.name)))
         else:
-            fw(struct.pack('=H', 0xffff))
+            writer.record(SECTION_MATERIAL_TEXTURES, struct.pack('=I', M3D_NONE))
 
             
 ########### WRITE IMAGE #######################################################
 			
-def writeImage(image, file):
+def writeImage(image, writer):
 
-    # write name
-    writeLengthPrefixedString(image.name, file)
-        
-    # write image name
-    writeLengthPrefixedString(image.name, file)
+    # name and image name
+    writer.record(SECTION_TEXTURES, struct.pack('=2I', writer.string(image.name), writer.string(image.name)))
 
    
 ########### WRITE LAMP ########################################################
 
-def safeRead(object, field, default):
-    data = object.bl_rna.properties.get(field)
-    if data:
-        return data
-    else:
-        return default
+LIGHT_TYPES = { 'SUN' : 0, 'POINT' : 1, 'SPOT' : 2 }
 
-def writeLamp(lampObject, file):
-    fw = file.write
+def writeLamp(lampObject, writer):
 
     lamp = lampObject.data
 
-    # write name
-    writeLengthPrefixedString(lamp.name, file)
+    spot_size = getattr(lamp, "spot_size", 0)
+    spot_blend = getattr(lamp, "spot_blend", 0)
+        
+    writer.record(SECTION_LIGHTS, struct.pack('=2I3f4f4f3f',
+        writer.string(lamp.name),
+        LIGHT_TYPES.get(lamp.type, LIGHT_TYPES['POINT']),
 
-    # position and rotation
-    fw(struct.pack('=7f', 
+        # position and rotation
         lampObject.location[0],
         lampObject.location[1],
         lampObject.location[2],
         lampObject.rotation_quaternion[1],
         lampObject.rotation_quaternion[2],
         lampObject.rotation_quaternion[3],
-        lampObject.rotation_quaternion[0]))
+        lampObject.rotation_quaternion[0],
 
-    spot_size = safeRead(lamp, "spot_size", 0)
-    spot_blend = safeRead(lamp, "spot_blend", 0)
-        
-    # shadow buffer settings
-    fw(struct.pack('=4f',
+        # shadow buffer settings
         spot_size - spot_size * spot_blend,
         spot_size,
         lamp.shadow_buffer_clip_start,
-        lamp.shadow_buffer_clip_end))
+        lamp.shadow_buffer_clip_end,
         
-    # colors
-    fw(struct.pack('=3f',
+        # colors
         lamp.color[0],
         lamp.color[1],
         lamp.color[2]))
@@ -343,26 +546,23 @@ def writeLamp(lampObject, file):
 
 ########### WRITE CAMERA ######################################################
 
-def writeCamera(cameraObject, file):
-    fw = file.write
+def writeCamera(cameraObject, writer):
     
     camera = cameraObject.data
 
-    # write name
-    writeLengthPrefixedString(camera.name, file)
+    writer.record(SECTION_CAMERAS, struct.pack('=I3f4f4f', 
+        writer.string(camera.name),
 
-    # position and rotation
-    fw(struct.pack('=fffffff', 
+        # position and rotation
         cameraObject.location[0],
         cameraObject.location[1],
         cameraObject.location[2],
         cameraObject.rotation_quaternion[1],
         cameraObject.rotation_quaternion[2],
         cameraObject.rotation_quaternion[3],
-        cameraObject.rotation_quaternion[0]))
+        cameraObject.rotation_quaternion[0],
 
-    # render target information
-    fw (struct.pack('=ffff', 
+        # render target information
         getFov(camera.lens.real, camera.sensor_width)[0],
         float(camera.clip_start),
         float(camera.clip_end),
@@ -375,14 +575,17 @@ def getFov(focal_length, sensor_size):
         
 ########### WRITE OBJECT ######################################################
 
-def writeObject(meshObject, file):
-    fw = file.write
+def writeObject(meshObject, writer):
 
-    # write name
-    writeLengthPrefixedString(meshObject.name, file)
-    
-    # position and rotation
-    fw(struct.pack('=10f', 
+    # material index information
+    material = M3D_NONE
+    if len(meshObject.material_slots) > 0 and meshObject.material_slots[0].material:
+        material = writer.materialIndices.get(meshObject.material_slots[0].material.name, M3D_NONE)
+
+    writer.record(SECTION_OBJECTS, struct.pack('=I10f2I', 
+        writer.string(meshObject.name),
+
+        # position and rotation
         meshObject.location[0],
         meshObject.location[1],
         meshObject.location[2],
@@ -392,149 +595,92 @@ def writeObject(meshObject, file):
         meshObject.rotation_quaternion[0],
         meshObject.scale[0],
         meshObject.scale[1],
-        meshObject.scale[2]))
-
-    # mesh index information
-    fw (struct.pack('=H', bpy.data.meshes.find(meshObject.data.name)))	
+        meshObject.scale[2],
 
-    # material index information
-    if len(meshObject.material_slots) > 0:
-        fw (struct.pack('=H', bpy.data.materials.find(meshObject.material_slots[0].material.name)))
-    else:
-        fw (struct.pack('=H', 0xffff))
+        # mesh index information
+        writer.meshIndices.get(meshObject.data.name, M3D_NONE),
+        material))
 
 
 ########### WRITE SCENE ######################################################
 
-def writeScene(scene, file):
-    fw = file.write
+def writeScene(scene, writer):
+
+    objects = [obj for obj in scene.objects if obj.type == 'MESH' and obj.data.export == True]
+    lamps = [obj for obj in scene.objects if obj.type == 'LAMP' and obj.data.export == True]
+    cameras = [obj for obj in scene.objects if obj.type == 'CAMERA' and obj.data.export == True]	
 
-    # write name
-    writeLengthPrefixedString(scene.name, file)    
+    writer.record(SECTION_SCENES, struct.pack('=7I',
+        writer.string(scene.name),
+        writer.count(SECTION_OBJECTS), len(objects),
+        writer.count(SECTION_LIGHTS), len(lamps),
+        writer.count(SECTION_CAMERAS), len(cameras)))
     
     ## MESH OBJECTS ##
     print("Mesh Objects")
 
-    # write objects in scene
-    objects = [obj for obj in scene.objects if obj.type == 'MESH' and obj.data.export == True]
-    fw(struct.pack('=H', len(objects)))
-
     for obj in objects:
-        writeObject(obj, file)		
+        writeObject(obj, writer)		
 
         
     ## LAMP OBJECTS ##
     print("Lamp Objects")
 
-    # write lamps in scene
-    lamps = [obj for obj in scene.objects if obj.type == 'LAMP' and obj.data.export == True]
-    fw(struct.pack('=H', len(lamps)))
-
     for lamp in lamps:
-        writeLamp(lamp, file)
+        writeLamp(lamp, writer)
 
 
     ## CAMERA OBJECTS ##
     print("Camera Objects")
 
-    #write cameras in scene
-    cameras = [obj for obj in scene.objects if obj.type == 'CAMERA' and obj.data.export == True]	
-    fw(struct.pack('=H', len(cameras)))
-
     for camera in cameras:
-        writeCamera(camera, file)
+        writeCamera(camera, writer)
 
         
 ########### EXPORTER ##########################################################
 
 def save(context, filename):
-    file = open(filename, 'wb')
-    fw = file.write
+    writer = M3dWriter()
 
     ## MESHES ##
     print("Meshes")
 
-    # write meshes
-    meshes = [mesh for mesh in bpy.data.meshes if mesh.export == True]
-    fw(struct.pack('=H', len(meshes)))
-    
-    for mesh in meshes:
-        writeMesh(mesh, file)
+    for mesh in [mesh for mesh in bpy.data.meshes if mesh.export == True]:
+        writeMesh(mesh, writer)
 
         
     ## ARMATURES ##
     print("Armatures")
 
-    # write armatures
-    armatures = [arm for arm in bpy.data.armatures if arm.export == True]
-    fw(struct.pack('=H', len(armatures)))
-    
-    for armature in armatures:
-        writeArmature(armature, file)
+    for armature in [arm for arm in bpy.data.armatures if arm.export == True]:
+        writeArmature(armature, writer)
 
 
     ## ACTIONS ##
     print("Actions")
         
-    # write actions
-    actions = [action for action in bpy.data.actions if action.export == True]
-    fw(struct.pack('=H', len(actions)))
-        
-    for action in actions:
-        writeAction(action, file)
+    for action in [action for action in bpy.data.actions if action.export == True]:
+        writeAction(action, writer)
 
-    writeLengthPrefixedString("MAT", file)
     
-    
-    ## MATERIALS ##
-    print("Materials")
-        
-    # write actions
-    materials = [mat for mat in bpy.data.materials if mat.export == True]
-    fw(struct.pack('=H', len(materials)))
-        
-    for material in materials:
-        writeMaterial(material, file)
-
-        
     ## IMAGES ##
     print("Images")
         
-    # write images
-    images = [image for image in bpy.data.images]
-    fw(struct.pack('=H', len(images)))
+    for image in bpy.data.images:
+        writeImage(image, writer)
+
         
-    for image in images:
-        writeImage(image, file)
+    ## MATERIALS ##
+    print("Materials")
+        
+    for material in [mat for mat in bpy.data.materials if mat.export == True]:
+        writeMaterial(material, writer)
 
         
     ## SCENES ##
     print("Scenes")
         
-    # write scenes
-    scenes = [scene for scene in bpy.data.scenes if scene.export == True]
-    fw(struct.pack('=H', len(scenes)))
-    
-    for scene in scenes:
-        writeScene(scene, file)
-
-    file.close()
-
-def writeNameIndexMap(name_index_map, file):
-    fw = file.write
-    fw(struct.pack('=H', len(name_index_map)))
-    i = 0;
-    for obj in name_index_map:
-        bytes = obj.name.encode('UTF-8')
-        fw(struct.pack('=H', len(bytes)))
-        fw(bytes)
-        fw(struct.pack('=H', i))
-        i += 1
-	
-def writeLengthPrefixedString(string, file):
-    fw = file.write
-    bytes = string.encode('UTF-8')
-    fw(struct.pack('=H', len(bytes)))
-    fw(bytes)
-    
-    
\ No newline at end of file
+    for scene in [scene for scene in bpy.data.scenes if scene.export == True]:
+        writeScene(scene, writer)
+
+    writer.save(filename)
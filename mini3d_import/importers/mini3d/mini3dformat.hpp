@@ -0,0 +1,209 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MINI3DFORMAT_H
+#define MINI3D_MINI3DFORMAT_H
+
+#include <stdint.h>
+
+namespace mini3d {
+namespace import {
+namespace m3d {
+
+// Layout of version 2 .m3d files, written by the Blender exporter in export_m3d.py.
+// Everything is little endian.
+//
+// The file starts with a Header and a table of contents of sectionCount Sections.
+// A section is an array of count records of one type, at a 16 byte aligned offset
+// from the start of the file. Sections can come in any order and a missing section
+// is empty, so a loader can skip to the sections it needs.
+//
+// Records refer to each other by index into their section, NONE for no reference.
+// Names are offsets into SECTION_STRINGS, which holds zero terminated UTF-8
+// strings. Vertex, index and keyframe data are Blobs in SECTION_DATA, each 16 byte
+// aligned so it can be used in place or uploaded to the GPU as is. Counts and
+// indices are 32 bit, file offsets and sizes 64 bit.
+//
+// Version 1 files have no header and are a stream of 16 bit counts and length
+// prefixed strings, Mini3dImporter reads both.
+
+const uint32_t MAGIC = 0x3244334d; // "M3D2"
+const uint32_t VERSION = 2;
+const uint32_t NONE = 0xffffffff;
+const unsigned int ALIGNMENT = 16;
+
+enum SectionType
+{
+    SECTION_STRINGS = 0,            // char
+    SECTION_DATA = 1,               // bytes
+    SECTION_MESHES = 2,             // MeshRecord
+    SECTION_ARMATURES = 3,          // ArmatureRecord
+    SECTION_JOINTS = 4,             // JointRecord
+    SECTION_ACTIONS = 5,            // ActionRecord
+    SECTION_CHANNELS = 6,           // ChannelRecord
+    SECTION_TEXTURES = 7,           // TextureRecord
+    SECTION_MATERIALS = 8,          // MaterialRecord
+    SECTION_MATERIAL_TEXTURES = 9,  // uint32_t index into SECTION_TEXTURES
+    SECTION_SCENES = 10,            // SceneRecord
+    SECTION_OBJECTS = 11,           // ObjectRecord
+    SECTION_LIGHTS = 12,            // LightRecord
+    SECTION_CAMERAS = 13,           // CameraRecord
+    SECTION_COMPRESSED_CHANNELS = 14, // CompressedChannelRecord, one per ChannelRecord or none
+    SECTION_CHANNEL_TANGENTS = 15,  // ChannelTangentsRecord, one per ChannelRecord or none
+    SECTION_COUNT = 16
+};
+
+struct Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sectionCount;
+    uint32_t flags;                 // 0
+};
+
+struct Section
+{
+    uint32_t type;
+    uint32_t count;                 // records, 0 for SECTION_STRINGS and SECTION_DATA
+    uint64_t offset;                // from the start of the file
+    uint64_t size;                  // in bytes
+};
+
+// offset is from the start of SECTION_DATA
+struct Blob
+{
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct MeshRecord
+{
+    uint32_t name;
+    uint32_t vertexSizeInBytes;
+    uint32_t indexSizeInBytes;      // 2 or 4
+    uint32_t reserved;
+    Blob vertexData;
+    Blob indexData;
+};
+
+// Joints are stored parents first
+struct ArmatureRecord
+{
+    uint32_t name;
+    uint32_t firstJoint;
+    uint32_t jointCount;
+};
+
+struct JointRecord
+{
+    uint32_t name;
+    uint32_t parent;                // index in the armature
+    float offset[3];
+    float roll[4];
+};
+
+struct ActionRecord
+{
+    uint32_t name;
+    float length;
+    uint32_t firstChannel;
+    uint32_t channelCount;
+};
+
+// keyframes holds the time followed by the value of every key, see Channel::Type
+struct ChannelRecord
+{
+    uint32_t boneName;
+    uint32_t type;
+    Blob keyframes;
+};
+
+// The keys of the ChannelRecord with the same index, reduced and quantized by the
+// exporter the way CompressedClip::AddChannel does it. frames holds keyCount 16 bit
+// frame indices at sampleRate, values keyCount keys of 16 bit words in encoding,
+// CompressedClip::Encoding. minimum and scale are the bounds of ENCODING_BOUNDS.
+struct CompressedChannelRecord
+{
+    uint32_t keyCount;
+    uint32_t encoding;
+    float sampleRate;
+    float tolerance;
+    float minimum[4];
+    float scale[4];
+    Blob frames;
+    Blob values;
+};
+
+// The authored tangents of the ChannelRecord with the same index, the in and then the
+// out tangent of every key in value per second, see AnimationClip::AddChannel. An empty
+// blob for a channel without them, it is interpolated with Catmull-Rom tangents.
+struct ChannelTangentsRecord
+{
+    Blob tangents;
+};
+
+struct TextureRecord
+{
+    uint32_t name;
+    uint32_t filename;
+};
+
+struct MaterialRecord
+{
+    uint32_t name;
+    uint32_t firstTexture;          // into SECTION_MATERIAL_TEXTURES
+    uint32_t textureCount;
+};
+
+struct SceneRecord
+{
+    uint32_t name;
+    uint32_t firstObject;
+    uint32_t objectCount;
+    uint32_t firstLight;
+    uint32_t lightCount;
+    uint32_t firstCamera;
+    uint32_t cameraCount;
+};
+
+struct ObjectRecord
+{
+    uint32_t name;
+    float position[3];
+    float rotation[4];
+    float scale[3];
+    uint32_t mesh;
+    uint32_t material;
+};
+
+struct LightRecord
+{
+    uint32_t name;
+    uint32_t type;                  // Light::Type
+    float position[3];
+    float rotation[4];
+    float angleInnerCone;
+    float angleOuterCone;
+    float clipPlaneNear;
+    float clipPlaneFar;
+    float color[3];
+};
+
+struct CameraRecord
+{
+    uint32_t name;
+    float position[3];
+    float rotation[4];
+    float horizontalFov;
+    float clipPlaneNear;
+    float clipPlaneFar;
+    float aspectRatio;
+};
+
+}
+}
+}
+
+#endif
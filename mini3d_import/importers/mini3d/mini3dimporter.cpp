@@ -7,69 +7,150 @@
 #include "mini3dimporter.hpp"
 #include "../../assetlibrary.hpp"
 
+#include "../../common/mappedfile.hpp"
+#include "../../common/arena.hpp"
+#include "mini3dformat.hpp"
+
 #include <stdint.h>
+#include <cstring>
+#include <cmath>
 
 using namespace mini3d::import;
 
-template <typename T> void Read(FILE* file, T* t, unsigned int count = 1) { fread(t, sizeof(T), count, file); }
-unsigned short ReadShort(FILE* file) { uint16_t t; Read<uint16_t>(file, &t); return t; }
-unsigned int ReadInt32(FILE* file) { uint32_t t; Read<uint32_t>(file, &t); return t; }
-float ReadFloat(FILE* file) { float t; Read<float>(file, &t); return t; }
-char* ReadString(FILE* file) 
+// Reads the mapped file front to back. A read past the end of the file asserts
+// and reads what is left, so a broken file can not make the parser overrun the mapping.
+struct Reader
+{
+    char* pCursor;
+    char* pEnd;
+
+    char* Take(unsigned int &size)
+    {
+        unsigned int left = (unsigned int)(pEnd - pCursor);
+        mini3d_assert(size <= left, "Unexpected end of file. This indicates a parsing error!");
+        size = (size <= left) ? size : left;
+
+        char* p = pCursor;
+        pCursor += size;
+        return p;
+    }
+};
+
+// Values in the file are not aligned, so they are copied out. Take shortens size at the
+// end of the file, so it is called before size is read.
+template <typename T> T Read(Reader &reader) { T t = T(); unsigned int size = sizeof(T); const char* p = reader.Take(size); memcpy(&t, p, size); return t; }
+unsigned short ReadShort(Reader &reader) { return Read<uint16_t>(reader); }
+unsigned int ReadInt32(Reader &reader) { return Read<uint32_t>(reader); }
+float ReadFloat(Reader &reader) { return Read<float>(reader); }
+
+// Everything the importers allocate for a library goes in its arena, the arrays and
+// strings do not own their memory
+template <typename T> void Allocate(Arena &arena, AutoArray<T> &array, unsigned int count) { array.array = arena.New<T>(count); array.count = count; array.owner = false; }
+
+// Version 1 strings are not zero terminated in the file, so they are copied
+void ReadString(Reader &reader, Arena &arena, AutoString &string)
 { 
-    unsigned int length = ReadShort(file);
-    char* string = new char[length + 1];
-    string[length] = 0;
-    Read<char>(file, string, length);
-    return string;
+    unsigned int length = ReadShort(reader);
+    const char* pChars = reader.Take(length);
+    string.array = (char*)arena.Allocate(length + 1, 1);
+    string.array[length] = 0;
+    memcpy(string.array, pChars, length);
+    string.count = length;
+    string.owner = false;
 }
 
-char* ReadBytes(FILE* file, unsigned int size)
+// Points data at the bytes without copying. Blobs that are not 4 byte aligned for the
+// floats in them are copied to the arena.
+void MapBytes(Arena &arena, AutoArray<char> &data, char* pBytes, unsigned int size)
 {
-    char* data = new char[size];
-    Read<char>(file, data, size);
-    return data;
+    data.count = size;
+    data.owner = false;
+    data.array = ((uintptr_t)pBytes % sizeof(float) == 0) ? pBytes : (char*)memcpy(arena.Allocate(size, sizeof(float)), pBytes, size);
 }
 
-AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
+// The next size bytes of the mapping
+void ReadBytes(Reader &reader, Arena &arena, AutoArray<char> &data, unsigned int size)
+{
+    char* pBytes = reader.Take(size);
+    MapBytes(arena, data, pBytes, size);
+}
+
+// Positions are expected to be the first vertex attribute (3 floats), as written by the exporter by default
+void ComputeMeshBounds(Mesh* mesh)
+{
+    unsigned int vertexCount = (mesh->vertexSizeInBytes != 0) ? mesh->vertexData.count / mesh->vertexSizeInBytes : 0;
+
+    for (unsigned int i = 0; i < 3; ++i)
+        mesh->boundsMin[i] = mesh->boundsMax[i] = mesh->boundingSphere[i] = 0;
+    mesh->boundingSphere[3] = 0;
+
+    if (vertexCount == 0 || mesh->vertexSizeInBytes < 3 * sizeof(float))
+        return;
+
+    const float* p = (const float*)mesh->vertexData.array;
+    for (unsigned int i = 0; i < 3; ++i)
+        mesh->boundsMin[i] = mesh->boundsMax[i] = p[i];
+
+    for (unsigned int v = 1; v < vertexCount; ++v)
+    {
+        p = (const float*)(mesh->vertexData.array + v * mesh->vertexSizeInBytes);
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+            if (p[i] < mesh->boundsMin[i]) mesh->boundsMin[i] = p[i];
+            if (p[i] > mesh->boundsMax[i]) mesh->boundsMax[i] = p[i];
+        }
+    }
+
+    // Sphere centered on the bounding box
+    float* c = mesh->boundingSphere;
+    for (unsigned int i = 0; i < 3; ++i)
+        c[i] = (mesh->boundsMin[i] + mesh->boundsMax[i]) * 0.5f;
+
+    float radius2 = 0;
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        p = (const float*)(mesh->vertexData.array + v * mesh->vertexSizeInBytes);
+        float d2 = (p[0] - c[0]) * (p[0] - c[0]) + (p[1] - c[1]) * (p[1] - c[1]) + (p[2] - c[2]) * (p[2] - c[2]);
+        if (d2 > radius2) radius2 = d2;
+    }
+    c[3] = sqrt(radius2);
+}
+
+
+////////// VERSION 1 //////////////////////////////////////////////////////////
+
+void ReadVersion1(AssetLibrary* pI, Reader &file)
 {
-    AssetLibrary* pI = new AssetLibrary();
-    
-	FILE *file = fopen(filename, "rb");
-    mini3d_assert(file != 0, "Failed to open file %s", filename);
-	
     ////////// MESHES /////////////////////////////////////////////////////////
 
     // Read mesh count
-    pI->meshes.count = ReadShort(file);
+    Allocate(pI->arena, pI->meshes, ReadShort(file));
 
     // read meshes
-    pI->meshes.array = new Mesh[pI->meshes.count];
     for (unsigned int i = 0; i < pI->meshes.count; ++i)
     {
         Mesh* mesh = pI->meshes.array + i;
         mesh->index = i;
 
         // Name
-        mesh->name = ReadString(file);
+        ReadString(file, pI->arena, mesh->name);
 
         // Get vertex data
         mesh->vertexSizeInBytes = ReadShort(file);
-        mesh->vertexData.count = ReadInt32(file);
-        mesh->vertexData.array = ReadBytes(file, mesh->vertexData.count);
+        ReadBytes(file, pI->arena, mesh->vertexData, ReadInt32(file));
         
         // Get index data
         mesh->indexSizeInBytes = ReadShort(file);
-        mesh->indexData.count = ReadInt32(file);
-        mesh->indexData.array = ReadBytes(file, mesh->indexData.count);
+        ReadBytes(file, pI->arena, mesh->indexData, ReadInt32(file));
+
+        ComputeMeshBounds(mesh);
     }
 
 
     ////////// ARMATURES //////////////////////////////////////////////////////
 
     // Read armature count
-    pI->armatures.count = ReadShort(file);
-    pI->armatures.array = new Armature[pI->armatures.count];
+    Allocate(pI->arena, pI->armatures, ReadShort(file));
 
     // read armature joints
     for (unsigned int i = 0; i < pI->armatures.count; ++i)
@@ -78,11 +159,10 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
         armature->index = i;
 
         // Name
-        armature->name = ReadString(file);
+        ReadString(file, pI->arena, armature->name);
 
         // Get the number of joints
-        armature->joints.count = ReadShort(file);
-        armature->joints.array = new Joint[armature->joints.count];
+        Allocate(pI->arena, armature->joints, ReadShort(file));
         
         // Get joints
         for (unsigned int j = 0; j < armature->joints.count; ++j)
@@ -90,7 +170,7 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
             Joint* joint = armature->joints.array + j;
             joint->index = j;
 
-            joint->name = ReadString(file);
+            ReadString(file, pI->arena, joint->name);
 
             unsigned int parentIndex = ReadShort(file);
             joint->parent = (parentIndex != NO_BONE_PARENT) ? armature->joints.array + parentIndex : 0;
@@ -110,8 +190,7 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
     ////////// ACTIONS ////////////////////////////////////////////////////////
 
     // Read action count
-    pI->actions.count = ReadShort(file);
-    pI->actions.array = new Action[pI->actions.count];
+    Allocate(pI->arena, pI->actions, ReadShort(file));
 
     // read actions
     for (unsigned int i = 0; i < pI->actions.count; ++i)
@@ -119,23 +198,21 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
         Action* action = pI->actions.array + i;
         action->index = i;
 
-        action->name = ReadString(file);
+        ReadString(file, pI->arena, action->name);
         action->length = ReadFloat(file);
         
         
-        action->channels.count = ReadShort(file);
-        action->channels.array = new Channel[action->channels.count];
+        Allocate(pI->arena, action->channels, ReadShort(file));
         
         // Read all channels
         for (unsigned int i = 0; i < action->channels.count; ++i)
         {
             Channel* channel = action->channels.array + i;
 
-            channel->boneName = ReadString(file);
+            ReadString(file, pI->arena, channel->boneName);
             channel->type = (Channel::Type)ReadShort(file);
 
-            channel->animationData.count = ReadShort(file);
-            channel->animationData.array = ReadBytes(file, channel->animationData.count);
+            ReadBytes(file, pI->arena, channel->animationData, ReadShort(file));
         }
     }
 
@@ -143,8 +220,7 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
     ////////// TEXTURES (IMAGES) //////////////////////////////////////////////
 
     // Read texture count
-    pI->textures.count = ReadShort(file);
-    pI->textures.array = new Texture[pI->textures.count];
+    Allocate(pI->arena, pI->textures, ReadShort(file));
 
     // read texture file names
     
@@ -153,16 +229,15 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
         Texture* texture = pI->textures.array + i;
         texture->index = i;
 
-        texture->name = ReadString(file);
-        texture->filename = ReadString(file);
+        ReadString(file, pI->arena, texture->name);
+        ReadString(file, pI->arena, texture->filename);
     }
 
 
     ////////// MATERIALS //////////////////////////////////////////////////////
 
     // Read material count
-    pI->materials.count = ReadShort(file);
-    pI->materials.array = new Material[pI->materials.count];
+    Allocate(pI->arena, pI->materials, ReadShort(file));
 
     // read materials
     for (unsigned int i = 0; i < pI->materials.count; ++i)
@@ -170,16 +245,15 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
         Material* material = pI->materials.array + i;
         material->index = i;
 
-        material->name = ReadString(file);
+        ReadString(file, pI->arena, material->name);
 
-        material->textures.count = ReadShort(file);
-        material->textures.array = new Texture*[material->textures.count];
+        Allocate(pI->arena, material->textures, ReadShort(file));
 
         // Get texture links
         for (unsigned int j = 0; j < material->textures.count; ++j)
         {
             unsigned int index = ReadShort(file);
-            material->textures.array[i] = pI->textures.array + index;
+            material->textures.array[j] = pI->textures.array + index;
         }
     }
 
@@ -187,8 +261,7 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
     ////////// SCENES /////////////////////////////////////////////////////////
 
     // Read scene count
-    pI->scenes.count = ReadShort(file);
-    pI->scenes.array = new Scene[pI->scenes.count];
+    Allocate(pI->arena, pI->scenes, ReadShort(file));
     
     // Read scenes
     for (unsigned int i = 0; i < pI->scenes.count; ++i)
@@ -196,20 +269,19 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
         Scene* scene = pI->scenes.array + i;
         scene->index = i;
 
-        scene->name = ReadString(file);
+        ReadString(file, pI->arena, scene->name);
 
         
         ////////// OBJECTS ////////////////////////////////////////////////////
         
-        scene->objects.count = ReadShort(file);
-        scene->objects.array = new Object[scene->objects.count];
+        Allocate(pI->arena, scene->objects, ReadShort(file));
 
         for (unsigned int j = 0; j < scene->objects.count; ++j)
         {
             Object* object = scene->objects.array + j;
             object->index = j;
 
-            object->name = ReadString(file);
+            ReadString(file, pI->arena, object->name);
 
             object->position[0] = ReadFloat(file);
             object->position[1] = ReadFloat(file);
@@ -232,15 +304,14 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
 
         ////////// LIGHTS /////////////////////////////////////////////////////
 
-        scene->lights.count = ReadShort(file);
-        scene->lights.array = new Light[scene->lights.count];
+        Allocate(pI->arena, scene->lights, ReadShort(file));
 
         for (unsigned int j = 0; j < scene->lights.count; ++j)
         {
             Light* light = scene->lights.array + j;
             light->index = j;
 
-            light->name = ReadString(file);
+            ReadString(file, pI->arena, light->name);
 
             light->position[0] = ReadFloat(file);
             light->position[1] = ReadFloat(file);
@@ -265,15 +336,14 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
 
         ////////// CAMERA /////////////////////////////////////////////////////
 
-        scene->cameras.count = ReadShort(file);
-        scene->cameras.array = new Camera[scene->cameras.count];
+        Allocate(pI->arena, scene->cameras, ReadShort(file));
 
         for (unsigned int j = 0; j < scene->cameras.count; ++j)
         {
             Camera* camera = scene->cameras.array + j;
             camera->index = j;
 
-            camera->name = ReadString(file);
+            ReadString(file, pI->arena, camera->name);
 
             camera->position[0] = ReadFloat(file);
             camera->position[1] = ReadFloat(file);
@@ -293,12 +363,418 @@ AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
     }
 
     // test that we have read the entire file
-    
-    long pos = ftell(file);
-    fseek (file, 0, SEEK_END);
-    mini3d_assert (pos == ftell(file), "Entire file was not parsed. This indicates a parsing error!");
+    mini3d_assert(file.pCursor == file.pEnd, "Entire file was not parsed. This indicates a parsing error!");
+}
+
+
+////////// VERSION 2 //////////////////////////////////////////////////////////
+
+bool Check(bool expression, const char* text) { mini3d_assert(expression, text); return expression; }
+
+// first + count <= total without overflow
+bool InRange(uint64_t first, uint64_t count, uint64_t total) { return first <= total && count <= total - first; }
+
+// The sections of a version 2 file. Validate checks the whole table of contents
+// against the file once, after that records and strings can be used in place.
+struct SectionTable
+{
+    char* pFile;
+    uint64_t fileSize;
+    Arena* pArena;
+    m3d::Section sections[m3d::SECTION_COUNT];
+
+    bool Validate()
+    {
+        // 0 for the sections that are not records
+        const unsigned int RECORD_SIZES[m3d::SECTION_COUNT] = {
+            0, 0, sizeof(m3d::MeshRecord), sizeof(m3d::ArmatureRecord), sizeof(m3d::JointRecord), sizeof(m3d::ActionRecord), sizeof(m3d::ChannelRecord),
+            sizeof(m3d::TextureRecord), sizeof(m3d::MaterialRecord), sizeof(uint32_t), sizeof(m3d::SceneRecord), sizeof(m3d::ObjectRecord), sizeof(m3d::LightRecord), sizeof(m3d::CameraRecord),
+            sizeof(m3d::CompressedChannelRecord), sizeof(m3d::ChannelTangentsRecord) };
+
+        memset(sections, 0, sizeof(sections));
+
+        m3d::Header header;
+        memcpy(&header, pFile, sizeof(header));
+        if (!Check(header.magic == m3d::MAGIC && header.version == m3d::VERSION, "Unsupported .m3d version") ||
+            !Check(InRange(sizeof(header), (uint64_t)header.sectionCount * sizeof(m3d::Section), fileSize), "The table of contents is outside the file"))
+            return false;
+
+        // Unknown section types are skipped, they are for newer loaders
+        for (unsigned int i = 0; i < header.sectionCount; ++i)
+        {
+            m3d::Section section;
+            memcpy(&section, pFile + sizeof(header) + i * sizeof(m3d::Section), sizeof(section));
+            if (section.type >= m3d::SECTION_COUNT)
+                continue;
+
+            if (!Check(section.offset % m3d::ALIGNMENT == 0, "Section is not aligned") ||
+                !Check(InRange(section.offset, section.size, fileSize), "Section is outside the file") ||
+                !Check(RECORD_SIZES[section.type] == 0 || section.size == (uint64_t)section.count * RECORD_SIZES[section.type], "Section size does not match its record count"))
+                return false;
+
+            sections[section.type] = section;
+        }
 
-    fclose(file);
+        const m3d::Section &strings = sections[m3d::SECTION_STRINGS];
+        return Check(strings.size == 0 || pFile[strings.offset + strings.size - 1] == 0, "String table is not terminated");
+    }
+
+    template <typename T> const T* Records(m3d::SectionType type) const    { return (const T*)(pFile + sections[type].offset); }
+    unsigned int Count(m3d::SectionType type) const                         { return sections[type].count; }
+
+    // At most what the assets take in the arena, split over arrays arrays with their
+    // name index. An index has at most 4 slots per asset.
+    template <typename T> size_t ArraySize(m3d::SectionType type, unsigned int arrays) const { return Count(type) * (sizeof(T) + 4 * sizeof(unsigned int)) + arrays * 2 * m3d::ALIGNMENT; }
+
+    // Names and data are used in place, so the arena only holds the arrays. Unaligned
+    // blobs are not counted and are copied to another block.
+    size_t ArenaSize() const
+    {
+        return ArraySize<Mesh>(m3d::SECTION_MESHES, 1) +
+            ArraySize<Armature>(m3d::SECTION_ARMATURES, 1) + ArraySize<Joint>(m3d::SECTION_JOINTS, Count(m3d::SECTION_ARMATURES)) +
+            ArraySize<Action>(m3d::SECTION_ACTIONS, 1) + ArraySize<Channel>(m3d::SECTION_CHANNELS, Count(m3d::SECTION_ACTIONS)) +
+            ArraySize<Texture>(m3d::SECTION_TEXTURES, 1) +
+            ArraySize<Material>(m3d::SECTION_MATERIALS, 1) + ArraySize<Texture*>(m3d::SECTION_MATERIAL_TEXTURES, Count(m3d::SECTION_MATERIALS)) +
+            ArraySize<Scene>(m3d::SECTION_SCENES, 1) + ArraySize<Object>(m3d::SECTION_OBJECTS, Count(m3d::SECTION_SCENES)) +
+            ArraySize<Light>(m3d::SECTION_LIGHTS, Count(m3d::SECTION_SCENES)) + ArraySize<Camera>(m3d::SECTION_CAMERAS, Count(m3d::SECTION_SCENES));
+    }
+
+    // Names are used in place, the string table is zero terminated
+    bool MapString(AutoString &string, uint32_t offset) const
+    {
+        if (!Check(offset < sections[m3d::SECTION_STRINGS].size, "String is outside the string table"))
+            return false;
+
+        string = pFile + sections[m3d::SECTION_STRINGS].offset + offset;
+        string.owner = false;
+        return true;
+    }
+
+    // Blobs are used in place, unaligned ones are copied to pArena
+    bool MapBlob(AutoArray<char> &data, const m3d::Blob &blob) const
+    {
+        if (!Check(InRange(blob.offset, blob.size, sections[m3d::SECTION_DATA].size) && blob.size <= 0xffffffff, "Data is outside the data section"))
+            return false;
+
+        MapBytes(*pArena, data, pFile + sections[m3d::SECTION_DATA].offset + blob.offset, (unsigned int)blob.size);
+        return true;
+    }
+};
+
+
+bool ReadVersion2(AssetLibrary* pI, char* pFile, uint64_t fileSize)
+{
+    SectionTable table;
+    table.pFile = pFile;
+    table.fileSize = fileSize;
+    table.pArena = &pI->arena;
+    if (!table.Validate())
+        return false;
+
+    // The whole library in one block
+    pI->arena.Reserve(table.ArenaSize());
+
+
+    ////////// MESHES /////////////////////////////////////////////////////////
+
+    const m3d::MeshRecord* pMeshes = table.Records<m3d::MeshRecord>(m3d::SECTION_MESHES);
+    Allocate(pI->arena, pI->meshes, table.Count(m3d::SECTION_MESHES));
+
+    for (unsigned int i = 0; i < pI->meshes.count; ++i)
+    {
+        Mesh* mesh = pI->meshes.array + i;
+        mesh->index = i;
+        mesh->vertexSizeInBytes = pMeshes[i].vertexSizeInBytes;
+        mesh->indexSizeInBytes = pMeshes[i].indexSizeInBytes;
+
+        if (!table.MapString(mesh->name, pMeshes[i].name) || !table.MapBlob(mesh->vertexData, pMeshes[i].vertexData) || !table.MapBlob(mesh->indexData, pMeshes[i].indexData))
+            return false;
+
+        ComputeMeshBounds(mesh);
+    }
+
+
+    ////////// ARMATURES //////////////////////////////////////////////////////
+
+    const m3d::ArmatureRecord* pArmatures = table.Records<m3d::ArmatureRecord>(m3d::SECTION_ARMATURES);
+    const m3d::JointRecord* pJoints = table.Records<m3d::JointRecord>(m3d::SECTION_JOINTS);
+    Allocate(pI->arena, pI->armatures, table.Count(m3d::SECTION_ARMATURES));
+
+    for (unsigned int i = 0; i < pI->armatures.count; ++i)
+    {
+        Armature* armature = pI->armatures.array + i;
+        armature->index = i;
+
+        const m3d::ArmatureRecord &record = pArmatures[i];
+        if (!table.MapString(armature->name, record.name) || !Check(InRange(record.firstJoint, record.jointCount, table.Count(m3d::SECTION_JOINTS)), "Armature joints are outside the joint section"))
+            return false;
+
+        Allocate(pI->arena, armature->joints, record.jointCount);
+        for (unsigned int j = 0; j < armature->joints.count; ++j)
+        {
+            Joint* joint = armature->joints.array + j;
+            const m3d::JointRecord &jointRecord = pJoints[record.firstJoint + j];
+            joint->index = j;
+
+            if (!table.MapString(joint->name, jointRecord.name) || !Check(jointRecord.parent == m3d::NONE || jointRecord.parent < j, "Joint parent does not come before the joint"))
+                return false;
+
+            joint->parent = (jointRecord.parent != m3d::NONE) ? armature->joints.array + jointRecord.parent : 0;
+            memcpy(joint->offset, jointRecord.offset, sizeof(jointRecord.offset));
+            joint->offset[3] = 0;
+            memcpy(joint->roll, jointRecord.roll, sizeof(jointRecord.roll));
+        }
+    }
+
+
+    ////////// ACTIONS ////////////////////////////////////////////////////////
+
+    const m3d::ActionRecord* pActions = table.Records<m3d::ActionRecord>(m3d::SECTION_ACTIONS);
+    const m3d::ChannelRecord* pChannels = table.Records<m3d::ChannelRecord>(m3d::SECTION_CHANNELS);
+    const m3d::CompressedChannelRecord* pCompressed = table.Records<m3d::CompressedChannelRecord>(m3d::SECTION_COMPRESSED_CHANNELS);
+    bool compressed = table.Count(m3d::SECTION_COMPRESSED_CHANNELS) != 0;
+    if (!Check(!compressed || table.Count(m3d::SECTION_COMPRESSED_CHANNELS) == table.Count(m3d::SECTION_CHANNELS), "Compressed channels do not match the channel section"))
+        return false;
+
+    const m3d::ChannelTangentsRecord* pTangents = table.Records<m3d::ChannelTangentsRecord>(m3d::SECTION_CHANNEL_TANGENTS);
+    bool tangents = table.Count(m3d::SECTION_CHANNEL_TANGENTS) != 0;
+    if (!Check(!tangents || table.Count(m3d::SECTION_CHANNEL_TANGENTS) == table.Count(m3d::SECTION_CHANNELS), "Channel tangents do not match the channel section"))
+        return false;
+
+    Allocate(pI->arena, pI->actions, table.Count(m3d::SECTION_ACTIONS));
+
+    for (unsigned int i = 0; i < pI->actions.count; ++i)
+    {
+        Action* action = pI->actions.array + i;
+        action->index = i;
+        action->length = pActions[i].length;
+
+        const m3d::ActionRecord &record = pActions[i];
+        if (!table.MapString(action->name, record.name) || !Check(InRange(record.firstChannel, record.channelCount, table.Count(m3d::SECTION_CHANNELS)), "Action channels are outside the channel section"))
+            return false;
+
+        Allocate(pI->arena, action->channels, record.channelCount);
+        for (unsigned int j = 0; j < action->channels.count; ++j)
+        {
+            Channel* channel = action->channels.array + j;
+            const m3d::ChannelRecord &channelRecord = pChannels[record.firstChannel + j];
+            channel->type = (Channel::Type)channelRecord.type;
+
+            if (!table.MapString(channel->boneName, channelRecord.boneName) || !table.MapBlob(channel->animationData, channelRecord.keyframes))
+                return false;
+
+            // The tangent count is checked against the keys when a clip is made from them
+            if (tangents && !table.MapBlob(channel->tangents, pTangents[record.firstChannel + j].tangents))
+                return false;
+
+            if (!compressed)
+                continue;
+
+            // The key sizes are checked against the channel when a clip is made from it
+            const m3d::CompressedChannelRecord &compressedRecord = pCompressed[record.firstChannel + j];
+            CompressedKeys &keys = channel->compressed;
+            if (!table.MapBlob(keys.frames, compressedRecord.frames) || !table.MapBlob(keys.values, compressedRecord.values) ||
+                !Check(keys.frames.count == compressedRecord.keyCount * sizeof(uint16_t), "Compressed frames do not match the key count"))
+                return false;
+
+            keys.keyCount = compressedRecord.keyCount;
+            keys.encoding = compressedRecord.encoding;
+            keys.sampleRate = compressedRecord.sampleRate;
+            keys.tolerance = compressedRecord.tolerance;
+            memcpy(keys.minimum, compressedRecord.minimum, sizeof(compressedRecord.minimum));
+            memcpy(keys.scale, compressedRecord.scale, sizeof(compressedRecord.scale));
+        }
+    }
+
+
+    ////////// TEXTURES (IMAGES) //////////////////////////////////////////////
+
+    const m3d::TextureRecord* pTextures = table.Records<m3d::TextureRecord>(m3d::SECTION_TEXTURES);
+    Allocate(pI->arena, pI->textures, table.Count(m3d::SECTION_TEXTURES));
+
+    for (unsigned int i = 0; i < pI->textures.count; ++i)
+    {
+        Texture* texture = pI->textures.array + i;
+        texture->index = i;
+
+        if (!table.MapString(texture->name, pTextures[i].name) || !table.MapString(texture->filename, pTextures[i].filename))
+            return false;
+    }
+
+
+    ////////// MATERIALS //////////////////////////////////////////////////////
+
+    const m3d::MaterialRecord* pMaterials = table.Records<m3d::MaterialRecord>(m3d::SECTION_MATERIALS);
+    const uint32_t* pMaterialTextures = table.Records<uint32_t>(m3d::SECTION_MATERIAL_TEXTURES);
+    Allocate(pI->arena, pI->materials, table.Count(m3d::SECTION_MATERIALS));
+
+    for (unsigned int i = 0; i < pI->materials.count; ++i)
+    {
+        Material* material = pI->materials.array + i;
+        material->index = i;
+
+        const m3d::MaterialRecord &record = pMaterials[i];
+        if (!table.MapString(material->name, record.name) || !Check(InRange(record.firstTexture, record.textureCount, table.Count(m3d::SECTION_MATERIAL_TEXTURES)), "Material textures are outside the material texture section"))
+            return false;
+
+        // A texture slot without an image links to no texture
+        Allocate(pI->arena, material->textures, record.textureCount);
+        for (unsigned int j = 0; j < material->textures.count; ++j)
+        {
+            uint32_t index = pMaterialTextures[record.firstTexture + j];
+            if (!Check(index == m3d::NONE || index < pI->textures.count, "Material texture is outside the texture section"))
+                return false;
+
+            material->textures.array[j] = (index != m3d::NONE) ? pI->textures.array + index : 0;
+        }
+    }
+
+
+    ////////// SCENES /////////////////////////////////////////////////////////
+
+    const m3d::SceneRecord* pScenes = table.Records<m3d::SceneRecord>(m3d::SECTION_SCENES);
+    const m3d::ObjectRecord* pObjects = table.Records<m3d::ObjectRecord>(m3d::SECTION_OBJECTS);
+    const m3d::LightRecord* pLights = table.Records<m3d::LightRecord>(m3d::SECTION_LIGHTS);
+    const m3d::CameraRecord* pCameras = table.Records<m3d::CameraRecord>(m3d::SECTION_CAMERAS);
+    Allocate(pI->arena, pI->scenes, table.Count(m3d::SECTION_SCENES));
+
+    for (unsigned int i = 0; i < pI->scenes.count; ++i)
+    {
+        Scene* scene = pI->scenes.array + i;
+        scene->index = i;
+
+        const m3d::SceneRecord &record = pScenes[i];
+        if (!table.MapString(scene->name, record.name) ||
+            !Check(InRange(record.firstObject, record.objectCount, table.Count(m3d::SECTION_OBJECTS)), "Scene objects are outside the object section") ||
+            !Check(InRange(record.firstLight, record.lightCount, table.Count(m3d::SECTION_LIGHTS)), "Scene lights are outside the light section") ||
+            !Check(InRange(record.firstCamera, record.cameraCount, table.Count(m3d::SECTION_CAMERAS)), "Scene cameras are outside the camera section"))
+            return false;
+
+
+        ////////// OBJECTS ////////////////////////////////////////////////////
+
+        Allocate(pI->arena, scene->objects, record.objectCount);
+        for (unsigned int j = 0; j < scene->objects.count; ++j)
+        {
+            Object* object = scene->objects.array + j;
+            const m3d::ObjectRecord &objectRecord = pObjects[record.firstObject + j];
+            object->index = j;
+
+            if (!table.MapString(object->name, objectRecord.name) ||
+                !Check(objectRecord.mesh == m3d::NONE || objectRecord.mesh < pI->meshes.count, "Object mesh is outside the mesh section") ||
+                !Check(objectRecord.material == m3d::NONE || objectRecord.material < pI->materials.count, "Object material is outside the material section"))
+                return false;
+
+            memcpy(object->position, objectRecord.position, sizeof(objectRecord.position));
+            object->position[3] = 0;
+            memcpy(object->rotation, objectRecord.rotation, sizeof(objectRecord.rotation));
+            memcpy(object->scale, objectRecord.scale, sizeof(objectRecord.scale));
+            object->scale[3] = 0;
+
+            object->mesh = (objectRecord.mesh != m3d::NONE) ? pI->meshes.array + objectRecord.mesh : 0;
+            object->material = (objectRecord.material != m3d::NONE) ? pI->materials.array + objectRecord.material : 0;
+        }
+
+
+        ////////// LIGHTS /////////////////////////////////////////////////////
+
+        Allocate(pI->arena, scene->lights, record.lightCount);
+        for (unsigned int j = 0; j < scene->lights.count; ++j)
+        {
+            Light* light = scene->lights.array + j;
+            const m3d::LightRecord &lightRecord = pLights[record.firstLight + j];
+            light->index = j;
+
+            if (!table.MapString(light->name, lightRecord.name))
+                return false;
+
+            light->type = (Light::Type)lightRecord.type;
+            memcpy(light->position, lightRecord.position, sizeof(lightRecord.position));
+            light->position[3] = 0;
+            memcpy(light->rotation, lightRecord.rotation, sizeof(lightRecord.rotation));
+
+            light->angleInnerCone = lightRecord.angleInnerCone;
+            light->angleOuterCone = lightRecord.angleOuterCone;
+            light->clipPlaneNear = lightRecord.clipPlaneNear;
+            light->clipPlaneFar = lightRecord.clipPlaneFar;
+            memcpy(light->color, lightRecord.color, sizeof(lightRecord.color));
+
+            // Not in the file, no attenuation
+            light->attenuationConstant = 1;
+            light->attenuationLinear = 0;
+            light->attenuationQuadratic = 0;
+            light->aspectRatio = 1;
+        }
+
+
+        ////////// CAMERA /////////////////////////////////////////////////////
+
+        Allocate(pI->arena, scene->cameras, record.cameraCount);
+        for (unsigned int j = 0; j < scene->cameras.count; ++j)
+        {
+            Camera* camera = scene->cameras.array + j;
+            const m3d::CameraRecord &cameraRecord = pCameras[record.firstCamera + j];
+            camera->index = j;
+
+            if (!table.MapString(camera->name, cameraRecord.name))
+                return false;
+
+            memcpy(camera->position, cameraRecord.position, sizeof(cameraRecord.position));
+            camera->position[3] = 0;
+            memcpy(camera->rotation, cameraRecord.rotation, sizeof(cameraRecord.rotation));
+
+            camera->horizontalFov = cameraRecord.horizontalFov;
+            camera->clipPlaneNear = cameraRecord.clipPlaneNear;
+            camera->clipPlaneFar = cameraRecord.clipPlaneFar;
+            camera->aspectRatio = cameraRecord.aspectRatio;
+        }
+    }
+
+    return true;
+}
+
+
+////////// MINI3D IMPORTER ////////////////////////////////////////////////////
+
+AssetLibrary* Mini3dImporter::LoadSceneFromFile(const char* filename)
+{
+    MappedFile* mappedFile = MappedFile::Open(filename);
+    mini3d_assert(mappedFile != 0, "Failed to open file %s", filename);
+    if (mappedFile == 0)
+        return 0;
+
+    return LoadSceneFromMappedFile(mappedFile);
+}
+
+AssetLibrary* Mini3dImporter::LoadSceneFromMappedFile(MappedFile* mappedFile)
+{
+    // The library keeps the file mapped, the vertex, index and animation data point into it
+    AssetLibrary* pI = new AssetLibrary();
+    pI->mappedFile = mappedFile;
+
+    // Version 1 files have no header and start with the mesh count. Later versions start
+    // with "M3D" and their version character, the ones this loader does not know fail
+    // instead of being read as version 1.
+    uint32_t magic = 0;
+    if (mappedFile->GetSize() >= sizeof(m3d::Header))
+        memcpy(&magic, mappedFile->GetData(), sizeof(magic));
+
+    if ((magic & 0x00ffffff) == (m3d::MAGIC & 0x00ffffff))
+    {
+        if (!ReadVersion2(pI, mappedFile->GetData(), mappedFile->GetSize()))
+        {
+            delete pI;
+            return 0;
+        }
+    }
+    else
+    {
+        // Version 1 has no counts up front, the arena adds blocks as the file is read
+        // instead of reserving room for a copy of the whole file
+        Reader file = { mappedFile->GetData(), mappedFile->GetData() + mappedFile->GetSize() };
+        ReadVersion1(pI, file);
+    }
 
+    pI->BuildIndex();
     return pI;
 }
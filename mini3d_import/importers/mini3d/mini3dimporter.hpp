@@ -15,12 +15,19 @@ namespace mini3d {
 namespace import {
 
 struct AssetLibrary;
+class MappedFile;
 
 class Mini3dImporter
 {
 public:
+    // Reads version 1 and version 2 files, see mini3dformat.hpp. Returns 0 if the
+    // file can not be opened or is not a valid version 2 file.
     AssetLibrary* LoadSceneFromFile(const char* filename);
 
+    // Same as LoadSceneFromFile for a file that is already mapped. The library takes
+    // over mappedFile, which is deleted if loading fails.
+    AssetLibrary* LoadSceneFromMappedFile(MappedFile* mappedFile);
+
 };
 
 }
@@ -0,0 +1,103 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_BONEPALETTE_H
+#define MINI3D_MATH_BONEPALETTE_H
+
+#include "simd.hpp"
+#include "transform.hpp"
+#include "transformbatch.hpp"
+
+#include <cstring>
+
+namespace mini3d {
+namespace math {
+
+
+////////// BONE PALETTE ///////////////////////////////////////////////////////
+
+// Builds skinning matrix palettes from joint transforms of any joint count.
+// Matrices are row major with column vectors like Transform::ToMatrix and are
+// written back to back, so the output can be uploaded to a constant buffer as is.
+// LAYOUT_3X4 drops the constant (0, 0, 0, 1) bottom row.
+
+struct BonePalette
+{
+    // The value is the number of floats per matrix
+    enum Layout { LAYOUT_3X4 = 12, LAYOUT_4X4 = 16 };
+
+    // child = parent * child
+    static void Concatenate(Transform &child, const Transform &parent)
+    {
+        simd::v128 rot = parent.rot.Load();
+        simd::v128 pos = simd::Mul(simd::Load3(&child.pos.x), simd::Splat(parent.scale));
+        simd::Store3(&child.pos.x, simd::Add(simd::Load3(&parent.pos.x), simd::QuatTransform(rot, pos)));
+        simd::Store(&child.rot.x, simd::QuatMul(rot, child.rot.Load()));
+        child.scale = parent.scale * child.scale;
+    }
+
+    // Turns joint local transforms into model space transforms in place. pParents[i] is
+    // the index of the parent of joint i or -1 for a root, parents must come before children.
+    static void LocalToModel(Transform* pTransforms, const int* pParents, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+            if (pParents[i] >= 0)
+                Concatenate(pTransforms[i], pTransforms[pParents[i]]);
+    }
+
+    // Writes count matrices to pOut, 4 transforms per iteration
+    static void ToMatrices(float* pOut, const Transform* pTransforms, unsigned int count, Layout layout)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4)
+            StoreMatrices(pOut + i * layout, pTransforms + i, layout);
+
+        if (i < count)
+        {
+            // Pad the last group with identity transforms and copy out the used matrices
+            Transform t[4] = { Transform::Identity(), Transform::Identity(), Transform::Identity(), Transform::Identity() };
+            for (unsigned int j = 0; i + j < count; ++j)
+                t[j] = pTransforms[i + j];
+
+            float m[4 * LAYOUT_4X4];
+            StoreMatrices(m, t, layout);
+            memcpy(pOut + i * layout, m, (count - i) * layout * sizeof(float));
+        }
+    }
+
+    // LocalToModel followed by ToMatrices
+    static void Build(float* pOut, Transform* pTransforms, const int* pParents, unsigned int count, Layout layout)
+    {
+        LocalToModel(pTransforms, pParents, count);
+        ToMatrices(pOut, pTransforms, count, layout);
+    }
+
+private:
+
+    static void StoreMatrices(float* pOut, const Transform* t, Layout layout)
+    {
+        simd::v128 pos[4] = { simd::Load3(&t[0].pos.x), simd::Load3(&t[1].pos.x), simd::Load3(&t[2].pos.x), simd::Load3(&t[3].pos.x) };
+        simd::v128 rot[4] = { t[0].rot.Load(), t[1].rot.Load(), t[2].rot.Load(), t[3].rot.Load() };
+        simd::Transpose(pos[0], pos[1], pos[2], pos[3]);
+        simd::Transpose(rot[0], rot[1], rot[2], rot[3]);
+
+        simd::v128 rows[3][4];
+        TransformBatch::MatrixRows(rows, pos, rot, simd::Set(t[0].scale, t[1].scale, t[2].scale, t[3].scale));
+
+        for (unsigned int j = 0; j < 4; ++j, pOut += layout)
+        {
+            simd::Store(pOut, rows[0][j]);
+            simd::Store(pOut + 4, rows[1][j]);
+            simd::Store(pOut + 8, rows[2][j]);
+            if (layout == LAYOUT_4X4)
+                simd::Store(pOut + 12, simd::Set(0, 0, 0, 1));
+        }
+    }
+};
+
+}
+}
+
+#endif
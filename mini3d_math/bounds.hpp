@@ -0,0 +1,98 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_BOUNDS_H
+#define MINI3D_MATH_BOUNDS_H
+
+#include "vec3.hpp"
+#include "mat4.hpp"
+#include "transform.hpp"
+
+#include <cmath>
+
+namespace mini3d {
+namespace math {
+
+
+////////// AXIS ALIGNED BOUNDING BOX //////////////////////////////////////////
+
+struct AABB
+{
+    Vec3 minimum;
+    Vec3 maximum;
+
+    AABB() {}
+    AABB(const Vec3 &minimum, const Vec3 &maximum) : minimum(minimum), maximum(maximum) {}
+
+    // Positions are read as 3 floats at the start of every stride bytes, like the POSITION attribute of a vertex
+    static AABB FromPoints(const void* pData, unsigned int count, unsigned int strideInBytes)
+    {
+        if (count == 0)
+            return AABB(Vec3(0.0f), Vec3(0.0f));
+
+        Vec3 first((const float*)pData);
+        AABB box(first, first);
+
+        for (unsigned int i = 1; i < count; ++i)
+        {
+            const float* p = (const float*)((const char*)pData + i * strideInBytes);
+            box.minimum = Vec3(fmin(box.minimum.x, p[0]), fmin(box.minimum.y, p[1]), fmin(box.minimum.z, p[2]));
+            box.maximum = Vec3(fmax(box.maximum.x, p[0]), fmax(box.maximum.y, p[1]), fmax(box.maximum.z, p[2]));
+        }
+        return box;
+    }
+
+    Vec3 Center() const                                                 { return (minimum + maximum) * 0.5f; }
+    Vec3 Extents() const                                                { return (maximum - minimum) * 0.5f; }
+
+    bool Contains(const Vec3 &p) const                                  { return p.x >= minimum.x && p.y >= minimum.y && p.z >= minimum.z && p.x <= maximum.x && p.y <= maximum.y && p.z <= maximum.z; }
+
+    // Bounds of the transformed box (Arvo's method)
+    AABB Transformed(const Mat4 &m) const
+    {
+        Vec3 c = m * Center();
+        Vec3 e = Extents();
+        Vec3 r( fabs(m.m[0]) * e.x + fabs(m.m[1]) * e.y + fabs(m.m[2]) * e.z,
+                fabs(m.m[4]) * e.x + fabs(m.m[5]) * e.y + fabs(m.m[6]) * e.z,
+                fabs(m.m[8]) * e.x + fabs(m.m[9]) * e.y + fabs(m.m[10]) * e.z);
+        return AABB(c - r, c + r);
+    }
+};
+
+
+////////// BOUNDING SPHERE ////////////////////////////////////////////////////
+
+// Packs into 4 floats (x, y, z, radius) so four spheres load as one 4x4 block
+struct BoundingSphere
+{
+    Vec3 center;
+    float radius;
+
+    BoundingSphere() {}
+    BoundingSphere(const Vec3 &center, float radius) : center(center), radius(radius) {}
+
+    // Sphere centered on the bounding box of the points
+    static BoundingSphere FromPoints(const void* pData, unsigned int count, unsigned int strideInBytes)
+    {
+        Vec3 center = AABB::FromPoints(pData, count, strideInBytes).Center();
+        float radius2 = 0.0f;
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            float d2 = (Vec3((const float*)((const char*)pData + i * strideInBytes)) - center).Norm();
+            radius2 = (d2 > radius2) ? d2 : radius2;
+        }
+        return BoundingSphere(center, sqrt(radius2));
+    }
+
+    bool Contains(const Vec3 &p) const                                  { return (p - center).Norm() <= radius * radius; }
+
+    BoundingSphere Transformed(const Transform &t) const                { return BoundingSphere(t * center, radius * fabs(t.scale)); }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,79 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_DUALQUAT_H
+#define MINI3D_MATH_DUALQUAT_H
+
+#include "simd.hpp"
+#include "vec3.hpp"
+#include "quat.hpp"
+#include "transform.hpp"
+
+namespace mini3d {
+namespace math {
+
+
+////////// DUAL QUATERNION ////////////////////////////////////////////////////
+
+// Rigid transform as real + dual e, where real is the rotation and dual is
+// 0.5 t real for the translation t. Dual quaternions can be blended linearly
+// and normalized without the shrinking of blended matrices, see Skinning.
+// They have no scale, FromTransform drops Transform::scale.
+
+class DualQuat
+{
+public:
+
+    Quat real;
+    Quat dual;
+
+    inline DualQuat()                                                   {}
+    inline DualQuat(const Quat &real, const Quat &dual) : real(real), dual(dual) {}
+
+    static DualQuat Identity()                                          { return DualQuat(Quat(0.0f, 0.0f, 0.0f, 1.0f), Quat(0.0f)); }
+
+    static DualQuat FromTransform(const Transform &t)
+    {
+        simd::v128 r = t.rot.Load();
+        simd::v128 p = simd::Load3(&t.pos.x);
+        return DualQuat(t.rot, Quat(simd::Mul(simd::QuatMul(p, r), simd::Splat(0.5f))));
+    }
+
+    // Unit scale, the real part must be normalized
+    Transform ToTransform() const                                       { Transform t; t.pos = Translation(); t.rot = real; t.scale = 1.0f; return t; }
+
+    // t = 2 dual real*
+    inline Vec3 Translation() const
+    {
+        Vec3 t;
+        simd::Store3(&t.x, simd::Mul(simd::QuatMul(dual.Load(), simd::QuatConjugate(real.Load())), simd::Splat(2.0f)));
+        return t;
+    }
+
+    // Applies d first and then this, like Transform::operator *
+    inline const DualQuat operator *(const DualQuat &d) const
+    {
+        simd::v128 r = real.Load();
+        return DualQuat(Quat(simd::QuatMul(r, d.real.Load())), Quat(simd::Add(simd::QuatMul(r, d.dual.Load()), simd::QuatMul(dual.Load(), d.real.Load()))));
+    }
+
+    inline const DualQuat operator +(const DualQuat &d) const           { return DualQuat(real + d.real, dual + d.dual); }
+    inline const DualQuat operator *(float s) const                     { return DualQuat(real * s, dual * s); }
+
+    inline void Normalize()                                             { *this = Normalized(); }
+    inline const DualQuat Normalized() const
+    {
+        simd::v128 r = real.Load();
+        simd::v128 n = simd::Dot4(r, r);
+        return DualQuat(Quat(DivSqrt(r, n)), Quat(DivSqrt(dual.Load(), n)));
+    }
+
+    inline Vec3 operator *(const Vec3 &v) const                         { return real.Transform(v) + Translation(); }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,153 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_FASTMATH_H
+#define MINI3D_MATH_FASTMATH_H
+
+// Polynomial approximations of the transcendental functions, 4 values at a
+// time on the simd kernels. The float versions run the same code on one lane.
+// Error bounds are the largest differences to the double precision C library
+// functions measured by mini3d_test/math/bfastmath.hpp:
+//
+//  SinCos(x)       |x| <= 8192     4e-7 absolute (2e-7 for |x| <= 2pi)
+//  Tan(x)          |x| < pi/2      3e-7 / |cos x| relative, it is sin / cos
+//  Rsqrt(x)        x > 0           3e-7 relative, exact in the scalar backend
+//  Acos(x)         |x| <= 1        5e-7 absolute
+//  Atan2(y, x)     all x, y        6e-7 absolute
+//
+// This is 2-4 float ulps around 1, meant for animation and camera code rather
+// than for accumulating long sums. With SSE they are 5-10x faster than the C
+// library, in the scalar backend about 1.5-2x.
+//
+// Define MINI3D_MATH_FAST to make Quat::FromAxisAngle, the projection matrix
+// builders and the Normalize functions use them.
+
+#include "simd.hpp"
+
+namespace mini3d {
+namespace math {
+namespace fast {
+
+
+////////// VECTOR FUNCTIONS ///////////////////////////////////////////////////
+
+// Both results in one pass. The argument is reduced to [-pi, pi] with a two part
+// 2pi (Cody-Waite), then folded into [0, pi/2] where minimax polynomials are used.
+inline void SinCos(simd::v128 x, simd::v128 &s, simd::v128 &c)
+{
+    using namespace simd;
+
+    v128 k = Round(Mul(x, Splat(0.159154943f)));
+    v128 y = Sub(Sub(x, Mul(k, Splat(6.28125f))), Mul(k, Splat(1.93530717958647692e-3f)));
+
+    // sin(y) = sign(y) sin(z) and cos(y) = sign(pi/2 - |y|) cos(z), z = min(|y|, pi - |y|)
+    v128 a = Abs(y);
+    v128 z = Min(a, Sub(Splat(3.14159265f), a));
+    v128 z2 = Mul(z, z);
+
+    v128 ps = MulAdd(z2, Splat(2.59048916e-6f), Splat(-1.98008982e-4f));
+    ps = MulAdd(z2, ps, Splat(8.33289983e-3f));
+    ps = MulAdd(z2, ps, Splat(-1.66666476e-1f));
+    ps = MulAdd(z2, ps, Splat(9.99999977e-1f));
+
+    v128 pc = MulAdd(z2, Splat(2.31540781e-5f), Splat(-1.38537124e-3f));
+    pc = MulAdd(z2, pc, Splat(4.16635862e-2f));
+    pc = MulAdd(z2, pc, Splat(-4.99999054e-1f));
+    pc = MulAdd(z2, pc, Splat(9.99999954e-1f));
+
+    s = MulSign(Mul(z, ps), y);
+    c = MulSign(pc, Sub(Splat(1.57079633f), a));
+}
+
+inline simd::v128 Tan(simd::v128 x)
+{
+    simd::v128 s, c;
+    SinCos(x, s, c);
+    return simd::Div(s, c);
+}
+
+inline simd::v128 Rsqrt(simd::v128 x)                                   { return simd::Rsqrt(x); }
+
+// sqrt(1 - |x|) P(|x|), Abramowitz and Stegun 4.4.46, reflected for x < 0
+inline simd::v128 Acos(simd::v128 x)
+{
+    using namespace simd;
+
+    v128 a = Min(Abs(x), Splat(1.0f));
+    v128 p = MulAdd(a, Splat(-0.0012624911f), Splat(0.0066700901f));
+    p = MulAdd(a, p, Splat(-0.0170881256f));
+    p = MulAdd(a, p, Splat(0.0308918810f));
+    p = MulAdd(a, p, Splat(-0.0501743046f));
+    p = MulAdd(a, p, Splat(0.0889789874f));
+    p = MulAdd(a, p, Splat(-0.2145988016f));
+    p = MulAdd(a, p, Splat(1.5707963050f));
+
+    // x < 0 gives pi - r, written as pi/2 + sign(x) (r - pi/2)
+    v128 r = Mul(Sqrt(Sub(Splat(1.0f), a)), p);
+    return Add(Splat(1.57079633f), MulSign(Sub(r, Splat(1.57079633f)), x));
+}
+
+// Minimax polynomial for atan on [0, 1] applied to min(|x|, |y|) / max(|x|, |y|),
+// then moved to the right octant. Atan2(0, 0) is 0.
+inline simd::v128 Atan2(simd::v128 y, simd::v128 x)
+{
+    using namespace simd;
+
+    v128 ax = Abs(x), ay = Abs(y);
+    v128 t = Div(Min(ax, ay), Max(Max(ax, ay), Splat(1e-30f)));
+    v128 t2 = Mul(t, t);
+
+    v128 p = MulAdd(t2, Splat(0.00681178204f), Splat(-0.0336041922f));
+    p = MulAdd(t2, p, Splat(0.0796236503f));
+    p = MulAdd(t2, p, Splat(-0.132333419f));
+    p = MulAdd(t2, p, Splat(0.198078160f));
+    p = MulAdd(t2, p, Splat(-0.333173682f));
+    p = MulAdd(t2, p, Splat(0.999996112f));
+    v128 r = Mul(t, p);
+
+    // pi/2 - r above the diagonal, pi - r for x < 0, then the sign of y
+    r = Add(Splat(0.785398163f), MulSign(Sub(r, Splat(0.785398163f)), Sub(ax, ay)));
+    r = Add(Splat(1.57079633f), MulSign(Sub(r, Splat(1.57079633f)), x));
+    return MulSign(r, y);
+}
+
+
+////////// SCALAR FUNCTIONS ///////////////////////////////////////////////////
+
+inline void SinCos(float x, float &s, float &c)                         { simd::v128 vs, vc; SinCos(simd::Splat(x), vs, vc); s = simd::GetX(vs), c = simd::GetX(vc); }
+inline float Tan(float x)                                               { return simd::GetX(Tan(simd::Splat(x))); }
+inline float Rsqrt(float x)                                             { return simd::GetX(simd::Rsqrt(simd::Splat(x))); }
+inline float Acos(float x)                                              { return simd::GetX(Acos(simd::Splat(x))); }
+inline float Atan2(float y, float x)                                    { return simd::GetX(Atan2(simd::Splat(y), simd::Splat(x))); }
+
+}
+
+
+////////// MATH CLASS FUNCTIONS ///////////////////////////////////////////////
+
+// The trigonometric and square root calls the math classes make. DivSqrt(v, d)
+// is v / sqrt(d), used by the Normalize functions.
+
+#if defined(MINI3D_MATH_FAST)
+
+inline void SinCos(float x, float &s, float &c)                         { fast::SinCos(x, s, c); }
+inline float Tan(float x)                                               { return fast::Tan(x); }
+inline simd::v128 DivSqrt(simd::v128 v, simd::v128 d)                   { return simd::Mul(v, fast::Rsqrt(d)); }
+template <typename T> inline T DivSqrt(T v, T d)                        { return v / (T)sqrt(d); }
+inline float DivSqrt(float v, float d)                                  { return v * fast::Rsqrt(d); }
+
+#else
+
+inline void SinCos(float x, float &s, float &c)                         { s = (float)sin(x), c = (float)cos(x); }
+inline float Tan(float x)                                               { return (float)tan(x); }
+inline simd::v128 DivSqrt(simd::v128 v, simd::v128 d)                   { return simd::Div(v, simd::Sqrt(d)); }
+template <typename T> inline T DivSqrt(T v, T d)                        { return v / (T)sqrt(d); }
+
+#endif
+
+}
+}
+
+#endif
@@ -0,0 +1,173 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_FRUSTUM_H
+#define MINI3D_MATH_FRUSTUM_H
+
+#include <cstddef>
+
+#include "simd.hpp"
+#include "vec4.hpp"
+#include "bounds.hpp"
+
+namespace mini3d {
+namespace math {
+
+
+////////// FRUSTUM ////////////////////////////////////////////////////////////
+
+// View frustum extracted from a view projection matrix in the layout written by
+// Transform::ToViewProjectionMatrix (row major, column vectors, depth in [0, 1]).
+// Plane normals point into the frustum, a point p is inside a plane if
+// dot(plane.xyz, p) + plane.w >= 0.
+
+class Frustum
+{
+public:
+
+    enum Plane { PLANE_LEFT, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR, PLANE_COUNT };
+
+    Vec4 planes[PLANE_COUNT];
+
+    Frustum() {}
+
+    Frustum(const float m[16])
+    {
+        // Gribb & Hartmann: http://www.cs.otago.ac.nz/postgrads/alexis/planeExtraction.pdf
+        Vec4 r0(m), r1(m + 4), r2(m + 8), r3(m + 12);
+
+        planes[PLANE_LEFT] = r3 + r0;
+        planes[PLANE_RIGHT] = r3 - r0;
+        planes[PLANE_BOTTOM] = r3 + r1;
+        planes[PLANE_TOP] = r3 - r1;
+        planes[PLANE_NEAR] = r2;
+        planes[PLANE_FAR] = r3 - r2;
+
+        for (unsigned int i = 0; i < PLANE_COUNT; ++i)
+            planes[i] /= Vec3(planes[i].x, planes[i].y, planes[i].z).Length();
+    }
+
+    bool Intersects(const BoundingSphere &s) const
+    {
+        for (unsigned int i = 0; i < PLANE_COUNT; ++i)
+            if (planes[i].x * s.center.x + planes[i].y * s.center.y + planes[i].z * s.center.z + planes[i].w <= -s.radius)
+                return false;
+        return true;
+    }
+
+    bool Intersects(const AABB &b) const
+    {
+        Vec3 c = b.Center(), e = b.Extents();
+        for (unsigned int i = 0; i < PLANE_COUNT; ++i)
+        {
+            const Vec4 &p = planes[i];
+            float r = fabs(p.x) * e.x + fabs(p.y) * e.y + fabs(p.z) * e.z;
+            if (p.x * c.x + p.y * c.y + p.z * c.z + p.w <= -r)
+                return false;
+        }
+        return true;
+    }
+
+    // Tests 4 spheres per iteration. Writes the indices of the spheres that are at least
+    // partially inside the frustum to pVisibleIndices and returns how many there are.
+    unsigned int Cull(const BoundingSphere* pSpheres, unsigned int count, unsigned int* pVisibleIndices) const
+    {
+        PlaneLanes pl[PLANE_COUNT];
+        LoadPlaneLanes(pl);
+
+        unsigned int visibleCount = 0;
+        unsigned int i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            // 4 spheres are one 4x4 block, transpose to x, y, z and radius lanes
+            static_assert(sizeof(BoundingSphere) == 4 * sizeof(float) && offsetof(BoundingSphere, radius) == 3 * sizeof(float), "BoundingSphere must be center x, y, z and radius, unpadded");
+            simd::v128 x = simd::Load(&pSpheres[i].center.x), y = simd::Load(&pSpheres[i + 1].center.x), z = simd::Load(&pSpheres[i + 2].center.x), r = simd::Load(&pSpheres[i + 3].center.x);
+            simd::Transpose(x, y, z, r);
+            simd::v128 negR = simd::Neg(r);
+
+            int mask = 0xF;
+            for (unsigned int j = 0; j < PLANE_COUNT && mask; ++j)
+                mask &= simd::GreaterMask(PlaneDistance(pl[j], x, y, z), negR);
+
+            visibleCount += AppendVisible(mask, i, pVisibleIndices + visibleCount);
+        }
+
+        for (; i < count; ++i)
+            if (Intersects(pSpheres[i]))
+                pVisibleIndices[visibleCount++] = i;
+
+        return visibleCount;
+    }
+
+    // Tests 4 boxes per iteration, otherwise the same as the sphere version
+    unsigned int Cull(const AABB* pBoxes, unsigned int count, unsigned int* pVisibleIndices) const
+    {
+        PlaneLanes pl[PLANE_COUNT];
+        LoadPlaneLanes(pl);
+
+        simd::v128 half = simd::Splat(0.5f);
+        unsigned int visibleCount = 0;
+        unsigned int i = 0;
+
+        for (; i + 4 <= count; i += 4)
+        {
+            simd::v128 minX = simd::Load3(&pBoxes[i].minimum.x), minY = simd::Load3(&pBoxes[i + 1].minimum.x), minZ = simd::Load3(&pBoxes[i + 2].minimum.x), min3 = simd::Load3(&pBoxes[i + 3].minimum.x);
+            simd::v128 maxX = simd::Load3(&pBoxes[i].maximum.x), maxY = simd::Load3(&pBoxes[i + 1].maximum.x), maxZ = simd::Load3(&pBoxes[i + 2].maximum.x), max3 = simd::Load3(&pBoxes[i + 3].maximum.x);
+            simd::Transpose(minX, minY, minZ, min3);
+            simd::Transpose(maxX, maxY, maxZ, max3);
+
+            simd::v128 cx = simd::Mul(simd::Add(minX, maxX), half), cy = simd::Mul(simd::Add(minY, maxY), half), cz = simd::Mul(simd::Add(minZ, maxZ), half);
+            simd::v128 ex = simd::Mul(simd::Sub(maxX, minX), half), ey = simd::Mul(simd::Sub(maxY, minY), half), ez = simd::Mul(simd::Sub(maxZ, minZ), half);
+
+            int mask = 0xF;
+            for (unsigned int j = 0; j < PLANE_COUNT && mask; ++j)
+            {
+                simd::v128 r = simd::Add(simd::Add(simd::Mul(pl[j].absX, ex), simd::Mul(pl[j].absY, ey)), simd::Mul(pl[j].absZ, ez));
+                mask &= simd::GreaterMask(PlaneDistance(pl[j], cx, cy, cz), simd::Neg(r));
+            }
+
+            visibleCount += AppendVisible(mask, i, pVisibleIndices + visibleCount);
+        }
+
+        for (; i < count; ++i)
+            if (Intersects(pBoxes[i]))
+                pVisibleIndices[visibleCount++] = i;
+
+        return visibleCount;
+    }
+
+private:
+
+    struct PlaneLanes { simd::v128 x, y, z, w, absX, absY, absZ; };
+
+    void LoadPlaneLanes(PlaneLanes pl[PLANE_COUNT]) const
+    {
+        for (unsigned int i = 0; i < PLANE_COUNT; ++i)
+        {
+            pl[i].x = simd::Splat(planes[i].x), pl[i].y = simd::Splat(planes[i].y), pl[i].z = simd::Splat(planes[i].z), pl[i].w = simd::Splat(planes[i].w);
+            pl[i].absX = simd::Abs(pl[i].x), pl[i].absY = simd::Abs(pl[i].y), pl[i].absZ = simd::Abs(pl[i].z);
+        }
+    }
+
+    static simd::v128 PlaneDistance(const PlaneLanes &p, simd::v128 x, simd::v128 y, simd::v128 z)
+    {
+        return simd::Add(simd::Add(simd::Add(simd::Mul(p.x, x), simd::Mul(p.y, y)), simd::Mul(p.z, z)), p.w);
+    }
+
+    static unsigned int AppendVisible(int mask, unsigned int first, unsigned int* pOut)
+    {
+        unsigned int n = 0;
+        for (unsigned int k = 0; k < 4; ++k)
+            if (mask & (1 << k))
+                pOut[n++] = first + k;
+        return n;
+    }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,217 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_MAT4_H
+#define MINI3D_MATH_MAT4_H
+
+#include "simd.hpp"
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "fastmath.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace mini3d {
+namespace math {
+
+
+////////// MATRIX 4x4 /////////////////////////////////////////////////////////
+
+// Row major storage with column vectors (v' = M * v), the same layout
+// Transform::ToMatrix and Transform::ToViewProjectionMatrix write. The
+// translation is in m[3], m[7] and m[11].
+
+class Mat4
+{
+public:
+
+    float m[16];
+
+    inline Mat4()                                                       {}
+    inline Mat4(const float m[16])                                      { memcpy(this->m, m, sizeof(this->m)); }
+    inline Mat4(float m00, float m01, float m02, float m03,
+                float m10, float m11, float m12, float m13,
+                float m20, float m21, float m22, float m23,
+                float m30, float m31, float m32, float m33)
+    {
+        m[0] = m00, m[1] = m01, m[2] = m02, m[3] = m03;
+        m[4] = m10, m[5] = m11, m[6] = m12, m[7] = m13;
+        m[8] = m20, m[9] = m21, m[10] = m22, m[11] = m23;
+        m[12] = m30, m[13] = m31, m[14] = m32, m[15] = m33;
+    }
+
+    static Mat4 Identity()                                              { return Mat4(1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1); }
+
+    // Right handed perspective projection with depth in [0, 1]. PerspectiveRH(...) * view gives
+    // the same matrix as Transform::ToViewProjectionMatrix.
+    static Mat4 PerspectiveRH(float fov, float aspect, float znear, float zfar)
+    {
+        float w = 1.0f/Tan(fov/2.0f);
+        float h = w * aspect;
+        float z1 = zfar / (znear-zfar);
+        float z2 = z1 * znear;
+
+        return Mat4(w,0,0,0, 0,h,0,0, 0,0,z1,z2, 0,0,-1,0);
+    }
+
+    // Right handed orthographic projection with depth in [0, 1]
+    static Mat4 OrthographicRH(float width, float height, float znear, float zfar)
+    {
+        float z1 = 1.0f / (znear-zfar);
+        return Mat4(2.0f/width,0,0,0, 0,2.0f/height,0,0, 0,0,z1,z1*znear, 0,0,0,1);
+    }
+
+	inline operator float*()                                            { return m; }
+	inline operator const float*() const                                { return m; }
+
+    inline bool operator == (const Mat4 &m) const                       { for (unsigned int i = 0; i < 16; ++i) if (this->m[i] != m.m[i]) return false; return true; }
+	inline bool operator != (const Mat4 &m) const                       { return !(*this == m); }
+
+    inline simd::v128 Row(unsigned int i) const                         { return simd::Load(m + i * 4); }
+
+    inline const Mat4 operator *(const Mat4 &b) const                   { Mat4 r; Multiply(r.m, m, b.m); return r; }
+    inline const Mat4& operator *=(const Mat4 &b)                       { Multiply(m, m, b.m); return *this; }
+
+    inline Vec4 operator *(const Vec4 &v) const                         { Vec4 r; TransformVectors(&r, &v, 1); return r; }
+    inline Vec3 operator *(const Vec3 &v) const                         { Vec3 r; TransformPoints(&r, &v, 1); return r; }
+
+    inline void Transpose()                                             { simd::v128 r0 = Row(0), r1 = Row(1), r2 = Row(2), r3 = Row(3); simd::Transpose(r0, r1, r2, r3); StoreRows(r0, r1, r2, r3); }
+    inline const Mat4 Transposed() const                                { Mat4 r(*this); r.Transpose(); return r; }
+
+    // r = a * b for row major matrices. r may alias a or b.
+    static void Multiply(float r[16], const float a[16], const float b[16])
+    {
+        simd::v128 b0 = simd::Load(b), b1 = simd::Load(b + 4), b2 = simd::Load(b + 8), b3 = simd::Load(b + 12);
+        simd::v128 rows[4];
+
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            simd::v128 ai = simd::Load(a + i * 4);
+            simd::v128 ri = simd::Mul(simd::SplatX(ai), b0);
+            ri = simd::Add(ri, simd::Mul(simd::SplatY(ai), b1));
+            ri = simd::Add(ri, simd::Mul(simd::SplatZ(ai), b2));
+            rows[i] = simd::Add(ri, simd::Mul(simd::SplatW(ai), b3));
+        }
+
+        simd::Store(r, rows[0]), simd::Store(r + 4, rows[1]), simd::Store(r + 8, rows[2]), simd::Store(r + 12, rows[3]);
+    }
+
+    // out[i] = M * in[i]. out may alias in.
+    void TransformVectors(Vec4* out, const Vec4* in, unsigned int count) const
+    {
+        simd::v128 c0 = Row(0), c1 = Row(1), c2 = Row(2), c3 = Row(3);
+        simd::Transpose(c0, c1, c2, c3);
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            simd::v128 v = in[i].Load();
+            simd::v128 r = simd::Mul(c0, simd::SplatX(v));
+            r = simd::Add(r, simd::Mul(c1, simd::SplatY(v)));
+            r = simd::Add(r, simd::Mul(c2, simd::SplatZ(v)));
+            simd::Store(&out[i].x, simd::Add(r, simd::Mul(c3, simd::SplatW(v))));
+        }
+    }
+
+    // out[i] = M * (in[i], 1) without the perspective divide. out may alias in.
+    void TransformPoints(Vec3* out, const Vec3* in, unsigned int count) const
+    {
+        simd::v128 c0 = Row(0), c1 = Row(1), c2 = Row(2), c3 = Row(3);
+        simd::Transpose(c0, c1, c2, c3);
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            simd::v128 v = simd::Load3(&in[i].x);
+            simd::v128 r = simd::Add(c3, simd::Mul(c0, simd::SplatX(v)));
+            r = simd::Add(r, simd::Mul(c1, simd::SplatY(v)));
+            simd::Store3(&out[i].x, simd::Add(r, simd::Mul(c2, simd::SplatZ(v))));
+        }
+    }
+
+    // Inverse of a matrix with bottom row (0, 0, 0, 1). The upper 3x3 part may contain any
+    // rotation, scale or shear. Returns false and leaves the matrix unchanged if it is singular.
+    bool InvertAffine()
+    {
+        simd::v128 r0 = Row(0), r1 = Row(1), r2 = Row(2);
+
+        // Columns of the inverse 3x3 are the cross products of the rows divided by the determinant
+        simd::v128 c0 = simd::Cross3(r1, r2);
+        simd::v128 c1 = simd::Cross3(r2, r0);
+        simd::v128 c2 = simd::Cross3(r0, r1);
+        simd::v128 det = simd::Dot3(r0, c0);
+
+        if (simd::GetX(det) == 0.0f)
+            return false;
+
+        c0 = simd::Div(c0, det), c1 = simd::Div(c1, det), c2 = simd::Div(c2, det);
+
+        // New translation is -inverse(A) * t
+        simd::v128 t = simd::Neg(simd::Add(simd::Add(simd::Mul(c0, simd::Splat(m[3])), simd::Mul(c1, simd::Splat(m[7]))), simd::Mul(c2, simd::Splat(m[11]))));
+
+        simd::Transpose(c0, c1, c2, t);
+        StoreRows(c0, c1, c2, simd::Set(0, 0, 0, 1));
+        return true;
+    }
+
+    inline const Mat4 InvertedAffine() const                            { Mat4 r(*this); return r.InvertAffine() ? r : Identity(); }
+
+    // General inverse. Returns false and leaves the matrix unchanged if it is singular.
+    bool Invert()
+    {
+        // 2x2 sub determinants of the upper and lower halves
+        float s0 = m[0] * m[5] - m[4] * m[1];
+        float s1 = m[0] * m[6] - m[4] * m[2];
+        float s2 = m[0] * m[7] - m[4] * m[3];
+        float s3 = m[1] * m[6] - m[5] * m[2];
+        float s4 = m[1] * m[7] - m[5] * m[3];
+        float s5 = m[2] * m[7] - m[6] * m[3];
+
+        float c5 = m[10] * m[15] - m[14] * m[11];
+        float c4 = m[9] * m[15] - m[13] * m[11];
+        float c3 = m[9] * m[14] - m[13] * m[10];
+        float c2 = m[8] * m[15] - m[12] * m[11];
+        float c1 = m[8] * m[14] - m[12] * m[10];
+        float c0 = m[8] * m[13] - m[12] * m[9];
+
+        float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        if (det == 0.0f)
+            return false;
+
+        float d = 1.0f / det;
+        Mat4 r( ( m[5] * c5 - m[6] * c4 + m[7] * c3) * d,
+                (-m[1] * c5 + m[2] * c4 - m[3] * c3) * d,
+                ( m[13] * s5 - m[14] * s4 + m[15] * s3) * d,
+                (-m[9] * s5 + m[10] * s4 - m[11] * s3) * d,
+
+                (-m[4] * c5 + m[6] * c2 - m[7] * c1) * d,
+                ( m[0] * c5 - m[2] * c2 + m[3] * c1) * d,
+                (-m[12] * s5 + m[14] * s2 - m[15] * s1) * d,
+                ( m[8] * s5 - m[10] * s2 + m[11] * s1) * d,
+
+                ( m[4] * c4 - m[5] * c2 + m[7] * c0) * d,
+                (-m[0] * c4 + m[1] * c2 - m[3] * c0) * d,
+                ( m[12] * s4 - m[13] * s2 + m[15] * s0) * d,
+                (-m[8] * s4 + m[9] * s2 - m[11] * s0) * d,
+
+                (-m[4] * c3 + m[5] * c1 - m[6] * c0) * d,
+                ( m[0] * c3 - m[1] * c1 + m[2] * c0) * d,
+                (-m[12] * s3 + m[13] * s1 - m[14] * s0) * d,
+                ( m[8] * s3 - m[9] * s1 + m[10] * s0) * d);
+
+        *this = r;
+        return true;
+    }
+
+    inline const Mat4 Inverted() const                                  { Mat4 r(*this); return r.Invert() ? r : Identity(); }
+
+private:
+
+    inline void StoreRows(simd::v128 r0, simd::v128 r1, simd::v128 r2, simd::v128 r3) { simd::Store(m, r0), simd::Store(m + 4, r1), simd::Store(m + 8, r2), simd::Store(m + 12, r3); }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,265 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_PACKING_H
+#define MINI3D_MATH_PACKING_H
+
+#include "simd.hpp"
+
+#include <stdint.h>
+#include <cstring>
+
+#if defined(MINI3D_MATH_SIMD_SSE) && defined(__F16C__)
+    #define MINI3D_MATH_SIMD_F16C
+    #include <immintrin.h>
+#elif defined(MINI3D_MATH_SIMD_NEON) && defined(__aarch64__)
+    #define MINI3D_MATH_SIMD_NEON_FP16
+#endif
+
+namespace mini3d {
+namespace math {
+
+
+////////// HALF FLOAT /////////////////////////////////////////////////////////
+
+// IEEE 754 binary16, rounded to nearest even. Values above 65504 become infinity.
+
+inline uint16_t FloatToHalf(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    x &= 0x7fffffff;
+
+    // Too large for a half, infinity or nan
+    if (x >= 0x47800000)
+        return (uint16_t)(sign | ((x > 0x7f800000) ? 0x7e00 : 0x7c00));
+
+    // Subnormal half, adding 0.5 lines the mantissa up with the half mantissa and rounds it
+    if (x < 0x38800000)
+    {
+        float a;
+        memcpy(&a, &x, sizeof(a));
+        a += 0.5f;
+        memcpy(&x, &a, sizeof(x));
+        return (uint16_t)(sign | (x - 0x3f000000));
+    }
+
+    // Rebias the exponent and round the 13 dropped mantissa bits to nearest even
+    x += 0xc8000fff + ((x >> 13) & 1);
+    return (uint16_t)(sign | (x >> 13));
+}
+
+inline float HalfToFloat(uint16_t h)
+{
+    uint32_t x = (uint32_t)(h & 0x7fff) << 13;
+    uint32_t exponent = x & 0x0f800000;
+    x += (127 - 15) << 23;
+
+    if (exponent == 0x0f800000)
+    {
+        // Infinity or nan
+        x += (128 - 16) << 23;
+    }
+    else if (exponent == 0)
+    {
+        // Subnormal, renormalized by the float unit
+        x += 1 << 23;
+        float f;
+        memcpy(&f, &x, sizeof(f));
+        f -= 6.10351562e-05f;
+        memcpy(&x, &f, sizeof(x));
+    }
+
+    x |= (uint32_t)(h & 0x8000) << 16;
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+
+////////// PACKING ////////////////////////////////////////////////////////////
+
+// Conversions between float arrays and the compact vertex formats, 4 values (or
+// vectors) at a time. count is the number of values, or of vectors for the
+// normal and 10-10-10-2 functions. Packing clamps to the range of the format and
+// rounds to nearest.
+//
+//  Half        16 bit float, 11 bits of precision
+//  Snorm16     [-1, 1] in 16 bits, value * 32767
+//  Unorm8      [0, 1] in 8 bits, value * 255
+//  Octahedral  unit normal as 2 snorm16, error below 1e-4
+//  1010102     [0, 1] vector in 32 bits, x in the low bits, w in the top 2 bits
+
+struct Packing
+{
+    static void FloatsToHalfs(uint16_t* pOut, const float* pIn, unsigned int count)
+    {
+        ForBlocks(pOut, pIn, count, 1, 1, [](uint16_t* o, const float* p) {
+#if defined(MINI3D_MATH_SIMD_F16C)
+            _mm_storel_epi64((__m128i*)o, _mm_cvtps_ph(simd::Load(p), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(MINI3D_MATH_SIMD_NEON_FP16)
+            vst1_u16(o, vreinterpret_u16_f16(vcvt_f16_f32(simd::Load(p))));
+#else
+            o[0] = FloatToHalf(p[0]), o[1] = FloatToHalf(p[1]), o[2] = FloatToHalf(p[2]), o[3] = FloatToHalf(p[3]);
+#endif
+        });
+    }
+
+    static void HalfsToFloats(float* pOut, const uint16_t* pIn, unsigned int count)
+    {
+        ForBlocks(pOut, pIn, count, 1, 1, [](float* o, const uint16_t* p) {
+#if defined(MINI3D_MATH_SIMD_F16C)
+            simd::Store(o, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)p)));
+#elif defined(MINI3D_MATH_SIMD_NEON_FP16)
+            simd::Store(o, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(p))));
+#else
+            o[0] = HalfToFloat(p[0]), o[1] = HalfToFloat(p[1]), o[2] = HalfToFloat(p[2]), o[3] = HalfToFloat(p[3]);
+#endif
+        });
+    }
+
+    static void FloatsToSnorm16(int16_t* pOut, const float* pIn, unsigned int count)
+    {
+        ForBlocks(pOut, pIn, count, 1, 1, [](int16_t* o, const float* p) {
+            int32_t i[4];
+            simd::StoreInt(i, simd::Mul(Clamp(simd::Load(p), -1.0f, 1.0f), simd::Splat(32767.0f)));
+            o[0] = (int16_t)i[0], o[1] = (int16_t)i[1], o[2] = (int16_t)i[2], o[3] = (int16_t)i[3];
+        });
+    }
+
+    // -32768 decodes to -1 like -32767
+    static void Snorm16ToFloats(float* pOut, const int16_t* pIn, unsigned int count)
+    {
+        ForBlocks(pOut, pIn, count, 1, 1, [](float* o, const int16_t* p) {
+            int32_t i[4] = { p[0], p[1], p[2], p[3] };
+            simd::Store(o, simd::Max(simd::Mul(simd::LoadInt(i), simd::Splat(1.0f / 32767.0f)), simd::Splat(-1.0f)));
+        });
+    }
+
+    static void FloatsToUnorm8(uint8_t* pOut, const float* pIn, unsigned int count)
+    {
+        ForBlocks(pOut, pIn, count, 1, 1, [](uint8_t* o, const float* p) {
+            int32_t i[4];
+            simd::StoreInt(i, simd::Mul(Clamp(simd::Load(p), 0.0f, 1.0f), simd::Splat(255.0f)));
+            o[0] = (uint8_t)i[0], o[1] = (uint8_t)i[1], o[2] = (uint8_t)i[2], o[3] = (uint8_t)i[3];
+        });
+    }
+
+    static void Unorm8ToFloats(float* pOut, const uint8_t* pIn, unsigned int count)
+    {
+        ForBlocks(pOut, pIn, count, 1, 1, [](float* o, const uint8_t* p) {
+            int32_t i[4] = { p[0], p[1], p[2], p[3] };
+            simd::Store(o, simd::Mul(simd::LoadInt(i), simd::Splat(1.0f / 255.0f)));
+        });
+    }
+
+    // 3 floats in, 2 snorm16 out per normal. The normal is projected onto the octahedron
+    // |x| + |y| + |z| = 1 and the lower half is folded out over the corners.
+    static void NormalsToOctahedral(int16_t* pOut, const float* pIn, unsigned int count)
+    {
+        ForBlocks(pOut, pIn, count, 3, 2, [](int16_t* o, const float* p) {
+            simd::v128 x = simd::Load3(p), y = simd::Load3(p + 3), z = simd::Load3(p + 6), w = simd::Load3(p + 9);
+            simd::Transpose(x, y, z, w);
+
+            simd::v128 l1 = simd::Add(simd::Add(simd::Abs(x), simd::Abs(y)), simd::Abs(z));
+            simd::v128 s = simd::Div(simd::Splat(32767.0f), simd::Max(l1, simd::Splat(1e-30f)));
+            x = simd::Mul(x, s), y = simd::Mul(y, s);
+
+            // For z < 0, x' = sign(x) (1 - |y|) = x + sign(x) |z|
+            simd::v128 f = simd::Max(simd::Neg(simd::Mul(z, s)), simd::Zero());
+            x = simd::Add(x, simd::MulSign(f, x));
+            y = simd::Add(y, simd::MulSign(f, y));
+
+            int32_t ix[4], iy[4];
+            simd::StoreInt(ix, x);
+            simd::StoreInt(iy, y);
+            for (unsigned int j = 0; j < 4; ++j)
+                o[j * 2] = (int16_t)ix[j], o[j * 2 + 1] = (int16_t)iy[j];
+        });
+    }
+
+    static void OctahedralToNormals(float* pOut, const int16_t* pIn, unsigned int count)
+    {
+        ForBlocks(pOut, pIn, count, 2, 3, [](float* o, const int16_t* p) {
+            int32_t ix[4] = { p[0], p[2], p[4], p[6] }, iy[4] = { p[1], p[3], p[5], p[7] };
+            simd::v128 x = simd::Mul(simd::LoadInt(ix), simd::Splat(1.0f / 32767.0f));
+            simd::v128 y = simd::Mul(simd::LoadInt(iy), simd::Splat(1.0f / 32767.0f));
+            simd::v128 z = simd::Sub(simd::Sub(simd::Splat(1.0f), simd::Abs(x)), simd::Abs(y));
+
+            // Unfold the lower half, the inverse of the fold in NormalsToOctahedral
+            simd::v128 f = simd::Max(simd::Neg(z), simd::Zero());
+            x = simd::Sub(x, simd::MulSign(f, x));
+            y = simd::Sub(y, simd::MulSign(f, y));
+
+            simd::v128 n = simd::Rsqrt(simd::Add(simd::Add(simd::Mul(x, x), simd::Mul(y, y)), simd::Mul(z, z)));
+            x = simd::Mul(x, n), y = simd::Mul(y, n), z = simd::Mul(z, n);
+
+            simd::v128 w = simd::Zero();
+            simd::Transpose(x, y, z, w);
+            simd::Store3(o, x), simd::Store3(o + 3, y), simd::Store3(o + 6, z), simd::Store3(o + 9, w);
+        });
+    }
+
+    // 4 floats in, one 32 bit value out per vector
+    static void Vec4sToUnorm1010102(uint32_t* pOut, const float* pIn, unsigned int count)
+    {
+        ForBlocks(pOut, pIn, count, 4, 1, [](uint32_t* o, const float* p) {
+            simd::v128 x = simd::Load(p), y = simd::Load(p + 4), z = simd::Load(p + 8), w = simd::Load(p + 12);
+            simd::Transpose(x, y, z, w);
+
+            int32_t ix[4], iy[4], iz[4], iw[4];
+            simd::StoreInt(ix, simd::Mul(Clamp(x, 0.0f, 1.0f), simd::Splat(1023.0f)));
+            simd::StoreInt(iy, simd::Mul(Clamp(y, 0.0f, 1.0f), simd::Splat(1023.0f)));
+            simd::StoreInt(iz, simd::Mul(Clamp(z, 0.0f, 1.0f), simd::Splat(1023.0f)));
+            simd::StoreInt(iw, simd::Mul(Clamp(w, 0.0f, 1.0f), simd::Splat(3.0f)));
+            for (unsigned int j = 0; j < 4; ++j)
+                o[j] = (uint32_t)ix[j] | ((uint32_t)iy[j] << 10) | ((uint32_t)iz[j] << 20) | ((uint32_t)iw[j] << 30);
+        });
+    }
+
+    static void Unorm1010102ToVec4s(float* pOut, const uint32_t* pIn, unsigned int count)
+    {
+        ForBlocks(pOut, pIn, count, 1, 4, [](float* o, const uint32_t* p) {
+            int32_t ix[4], iy[4], iz[4], iw[4];
+            for (unsigned int j = 0; j < 4; ++j)
+                ix[j] = p[j] & 0x3ff, iy[j] = (p[j] >> 10) & 0x3ff, iz[j] = (p[j] >> 20) & 0x3ff, iw[j] = p[j] >> 30;
+
+            simd::v128 x = simd::Mul(simd::LoadInt(ix), simd::Splat(1.0f / 1023.0f));
+            simd::v128 y = simd::Mul(simd::LoadInt(iy), simd::Splat(1.0f / 1023.0f));
+            simd::v128 z = simd::Mul(simd::LoadInt(iz), simd::Splat(1.0f / 1023.0f));
+            simd::v128 w = simd::Mul(simd::LoadInt(iw), simd::Splat(1.0f / 3.0f));
+            simd::Transpose(x, y, z, w);
+            simd::Store(o, x), simd::Store(o + 4, y), simd::Store(o + 8, z), simd::Store(o + 12, w);
+        });
+    }
+
+private:
+
+    static inline simd::v128 Clamp(simd::v128 v, float lo, float hi)   { return simd::Min(simd::Max(v, simd::Splat(lo)), simd::Splat(hi)); }
+
+    // Calls f(out, in) for every block of 4 values of inWidth and outWidth elements. The last
+    // partial block is run on zero padded copies so f can always read and write whole blocks.
+    template <typename TOut, typename TIn, typename F> static void ForBlocks(TOut* pOut, const TIn* pIn, unsigned int count, unsigned int inWidth, unsigned int outWidth, F f)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4)
+            f(pOut + i * outWidth, pIn + i * inWidth);
+
+        if (i < count)
+        {
+            TIn in[16] = {};
+            TOut out[16];
+            memcpy(in, pIn + i * inWidth, (count - i) * inWidth * sizeof(TIn));
+            f(out, in);
+            memcpy(pOut + i * outWidth, out, (count - i) * outWidth * sizeof(TOut));
+        }
+    }
+};
+
+}
+}
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "vec3.hpp"
 #include "vec4.hpp"
+#include "fastmath.hpp"
 
 namespace mini3d {
 namespace math {
@@ -25,14 +26,16 @@ public:
     inline Quat(float s) : x(s), y(s), z(s), w(s)                              {} 
     inline Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w)   {} 
     inline Quat(const float q[4]) : x(q[0]), y(q[1]), z(q[2]), w(q[3])         {}
-    inline Quat(const Quat &q) : x(q.x), y(q.y), z(q.z), w(q.w)                {}
+    inline explicit Quat(simd::v128 q)                                         { simd::Store(&x, q); }
+
+    inline simd::v128 Load() const                                      { return simd::Load(&x); }
 
     static Quat FromAxisAngle(float x, float y, float z, float a)
     {
         // http://www.flipcode.com/documents/matrfaq.html#Q56
 
-        float sin_a = sin( a * 0.5f );
-        float cos_a = cos( a * 0.5f );
+        float sin_a, cos_a;
+        SinCos( a * 0.5f, sin_a, cos_a );
 
         return Quat( x * sin_a, y * sin_a, z * sin_a, cos_a).Normalized();
     }
@@ -47,37 +50,34 @@ public:
 
     inline float operator [](int index) const                           { return *(&x + index); }
 
-    inline const Quat& operator +=(const Quat &q)                       { x += q.x, y += q.y, z += q.z, w += q.w; return *this; }
-    inline const Quat& operator -=(const Quat &q)                       { x -= q.x, y -= q.y, z -= q.z, w -= q.w; return *this; }
+    inline const Quat& operator +=(const Quat &q)                       { simd::Store(&x, simd::Add(Load(), q.Load())); return *this; }
+    inline const Quat& operator -=(const Quat &q)                       { simd::Store(&x, simd::Sub(Load(), q.Load())); return *this; }
     inline const Quat& operator *=(const Quat &q)                       { *this = this->operator *(q); return *this; }
     inline const Quat& operator /=(const Quat &q)                       { *this = this->operator /(q); return *this; }
-    inline const Quat& operator *=(float s)                             { x *= s, y *= s, z *= s, w *= s; return *this; }
-    inline const Quat& operator /=(float s)                             { x /= s, y /= s, z /= s, w /= w; return *this; }
+    inline const Quat& operator *=(float s)                             { simd::Store(&x, simd::Mul(Load(), simd::Splat(s))); return *this; }
+    inline const Quat& operator /=(float s)                             { simd::Store(&x, simd::Div(Load(), simd::Splat(s))); return *this; }
 
-    inline const Quat operator +(const Quat &q2) const                  { return Quat(x + q2.x, y + q2.y, z + q2.z, w + q2.w); }
-    inline const Quat operator -(const Quat &q2) const                  { return Quat(x - q2.x, y - q2.y, z - q2.z, w - q2.w); }
+    inline const Quat operator +(const Quat &q2) const                  { return Quat(simd::Add(Load(), q2.Load())); }
+    inline const Quat operator -(const Quat &q2) const                  { return Quat(simd::Sub(Load(), q2.Load())); }
     
-    inline const Quat operator *(const Quat &q) const                   { return Quat(  w*q.x + x*q.w + y*q.z - z*q.y, 
-                                                                                        w*q.y - x*q.z + y*q.w + z*q.x, 
-                                                                                        w*q.z + x*q.y - y*q.x + z*q.w, 
-                                                                                        w*q.w - x*q.x - y*q.y - z*q.z); }
+    inline const Quat operator *(const Quat &q) const                   { return Quat(simd::QuatMul(Load(), q.Load())); }
 
-    inline const Quat operator /(const Quat &q) const                   { return operator *(q.Conjugated()); }
+    inline const Quat operator /(const Quat &q) const                   { return Quat(simd::QuatMul(Load(), simd::QuatConjugate(q.Load()))); }
 
-    inline const Quat operator *(float s) const                         { return Quat(x * s, y * s, z * s, w * s); }
-    inline const Quat operator /(float s) const                         { return Quat(x / s, y / s, z / s, w / s); }
+    inline const Quat operator *(float s) const                         { return Quat(simd::Mul(Load(), simd::Splat(s))); }
+    inline const Quat operator /(float s) const                         { return Quat(simd::Div(Load(), simd::Splat(s))); }
 
-    inline Vec4 Transform(const Vec4 v) const                           { Vec4 r(x,y,z,0); return v + (r+r).Cross3(r.Cross3(v) + v*w); }
-    inline Vec3 Transform(const Vec3 v) const                           { Vec3 r(x,y,z); return v + (r+r).Cross(r.Cross(v) + v*w); }
+    inline Vec4 Transform(const Vec4 v) const                           { return Vec4(simd::QuatTransform(Load(), v.Load())); }
+    inline Vec3 Transform(const Vec3 v) const                           { Vec3 r; simd::Store3(&r.x, simd::QuatTransform(Load(), simd::Load3(&v.x))); return r; }
     inline static Vec4 Transform(const Quat &q, const Vec4 &v)          { return q.Transform(v); }
     inline static Vec3 Transform(const Quat &q, const Vec3 &v)          { return q.Transform(v); }
 
-    inline void Conjugate()                                             { x = -x, y = -y, z = -z; }
-    inline const Quat Conjugated() const                                { return Quat(-x, -y, -z, w); }
-    inline void Negate()                                                { x = -x, y = -y, z = -z, w = -w; }
-    inline const Quat Negated() const                                   { return Quat(-x, -y, -z, -w); }
-    inline void Normalize()                                             { float s = sqrt(x*x + y*y + z*z + w*w); if (s != 0.0f) { x /= s, y /= s, z /= s, w /= s; } }
-    inline const Quat Normalized() const                                { float s = sqrt(x*x + y*y + z*z + w*w); return (s != 0.0f) ? Quat(x / s, y / s, z / s, w / s) : Quat(0,0,0,1); }
+    inline void Conjugate()                                             { simd::Store(&x, simd::QuatConjugate(Load())); }
+    inline const Quat Conjugated() const                                { return Quat(simd::QuatConjugate(Load())); }
+    inline void Negate()                                                { simd::Store(&x, simd::Neg(Load())); }
+    inline const Quat Negated() const                                   { return Quat(simd::Neg(Load())); }
+    inline void Normalize()                                             { simd::v128 q = Load(); simd::v128 n = simd::Dot4(q, q); if (simd::GetX(n) != 0.0f) simd::Store(&x, DivSqrt(q, n)); }
+    inline const Quat Normalized() const                                { simd::v128 q = Load(); simd::v128 n = simd::Dot4(q, q); return (simd::GetX(n) != 0.0f) ? Quat(DivSqrt(q, n)) : Quat(0,0,0,1); }
     inline void RotateAxis(Quat rot)                                    { *this = rot * *this / rot; }
     inline const Quat RotatedAxis(Quat rot) const                       { return rot * *this / rot; }
 
@@ -88,6 +88,12 @@ public:
 inline const Quat operator *(float s, const Quat &q)                    { return q * s; }
 inline const Quat operator /(float s, const Quat &q)                    { return q / s; }
 
+// Component wise cubic Hermite spline, normalize the result to get a rotation
+inline Quat Hermite(const Quat &p0, const Quat &p1, const Quat &m0, const Quat &m1, float t) { return Quat(simd::Hermite(p0.Load(), p1.Load(), m0.Load(), m1.Load(), t)); }
+
+// q or -q, whichever is in the same hemisphere as reference, so that blending them goes the short way
+inline Quat SameHemisphere(const Quat &q, const Quat &reference)       { return Quat(simd::MulSign(q.Load(), simd::Dot4(q.Load(), reference.Load()))); }
+
 }
 }
 
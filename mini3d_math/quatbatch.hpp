@@ -0,0 +1,197 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_QUATBATCH_H
+#define MINI3D_MATH_QUATBATCH_H
+
+#include "simd.hpp"
+#include "quat.hpp"
+
+namespace mini3d {
+namespace math {
+
+
+////////// QUATERNION BATCH ///////////////////////////////////////////////////
+
+// Quaternion kernels over contiguous arrays, for example all joint rotations of
+// a skeleton. Four quaternions are transposed into x, y, z and w lanes per
+// iteration. Output arrays may alias the inputs.
+
+struct QuatBatch
+{
+    // q[i] = q[i] / |q[i]| using rsqrt and one Newton-Raphson step (about 1e-7 relative error).
+    // Zero quaternions are left as they are.
+    static void Normalize(Quat* q, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            Lanes l;
+            l.Load(q + i);
+            NormalizeLanes(l.c);
+            l.Store(q + i);
+        }
+        if (i < count)
+        {
+            Lanes l;
+            l.LoadTail(q + i, count - i);
+            NormalizeLanes(l.c);
+            l.StoreTail(q + i, count - i);
+        }
+    }
+
+    // out[i] = a[i] * b[i]
+    static void Multiply(Quat* out, const Quat* a, const Quat* b, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            Lanes la, lb, lr;
+            la.Load(a + i);
+            lb.Load(b + i);
+            MultiplyLanes(lr.c, la.c, lb.c);
+            lr.Store(out + i);
+        }
+        if (i < count)
+        {
+            Lanes la, lb, lr;
+            la.LoadTail(a + i, count - i);
+            lb.LoadTail(b + i, count - i);
+            MultiplyLanes(lr.c, la.c, lb.c);
+            lr.StoreTail(out + i, count - i);
+        }
+    }
+
+    // Normalized linear interpolation along the shortest arc
+    static void Nlerp(Quat* out, const Quat* a, const Quat* b, float t, unsigned int count)             { Interpolate<UniformWeights, false>(out, a, b, UniformWeights(t), count); }
+    static void Nlerp(Quat* out, const Quat* a, const Quat* b, const float* t, unsigned int count)      { Interpolate<ArrayWeights, false>(out, a, b, ArrayWeights(t), count); }
+
+    // Spherical linear interpolation along the shortest arc. Uses the polynomial form from
+    // D. Eberly, "A Fast and Accurate Algorithm for Computing SLERP" (2011), which needs no
+    // trigonometric functions or divisions. Maximum error is about 2e-5 for unit inputs, largest
+    // near 90 degree arcs and zero at t = 0 and t = 1.
+    static void Slerp(Quat* out, const Quat* a, const Quat* b, float t, unsigned int count)             { Interpolate<UniformWeights, true>(out, a, b, UniformWeights(t), count); }
+    static void Slerp(Quat* out, const Quat* a, const Quat* b, const float* t, unsigned int count)      { Interpolate<ArrayWeights, true>(out, a, b, ArrayWeights(t), count); }
+
+private:
+
+    // Four quaternions in x, y, z and w lanes
+    struct Lanes
+    {
+        simd::v128 c[4];
+
+        void Load(const Quat* q)                                        { c[0] = q[0].Load(), c[1] = q[1].Load(), c[2] = q[2].Load(), c[3] = q[3].Load(); simd::Transpose(c[0], c[1], c[2], c[3]); }
+        void Store(Quat* q)                                             { simd::Transpose(c[0], c[1], c[2], c[3]); simd::Store(&q[0].x, c[0]), simd::Store(&q[1].x, c[1]), simd::Store(&q[2].x, c[2]), simd::Store(&q[3].x, c[3]); }
+
+        // Pads the unused lanes with identity quaternions
+        void LoadTail(const Quat* q, unsigned int n)                    { Quat t[4] = { Quat(0,0,0,1), Quat(0,0,0,1), Quat(0,0,0,1), Quat(0,0,0,1) }; for (unsigned int i = 0; i < n; ++i) t[i] = q[i]; Load(t); }
+        void StoreTail(Quat* q, unsigned int n)                         { Quat t[4]; Store(t); for (unsigned int i = 0; i < n; ++i) q[i] = t[i]; }
+    };
+
+    struct UniformWeights
+    {
+        UniformWeights(float t) : t(simd::Splat(t))                     {}
+        simd::v128 Load(unsigned int) const                             { return t; }
+        simd::v128 LoadTail(unsigned int, unsigned int) const           { return t; }
+        simd::v128 t;
+    };
+
+    struct ArrayWeights
+    {
+        ArrayWeights(const float* t) : t(t)                             {}
+        simd::v128 Load(unsigned int i) const                           { return simd::Load(t + i); }
+        simd::v128 LoadTail(unsigned int i, unsigned int n) const       { float p[4] = { 0, 0, 0, 0 }; for (unsigned int j = 0; j < n; ++j) p[j] = t[i + j]; return simd::Load(p); }
+        const float* t;
+    };
+
+    static simd::v128 DotLanes(const simd::v128 a[4], const simd::v128 b[4])
+    {
+        return simd::Add(simd::Add(simd::Add(simd::Mul(a[0], b[0]), simd::Mul(a[1], b[1])), simd::Mul(a[2], b[2])), simd::Mul(a[3], b[3]));
+    }
+
+    static void NormalizeLanes(simd::v128 q[4])
+    {
+        simd::v128 s = simd::Rsqrt(simd::Max(DotLanes(q, q), simd::Splat(1e-30f)));
+        q[0] = simd::Mul(q[0], s), q[1] = simd::Mul(q[1], s), q[2] = simd::Mul(q[2], s), q[3] = simd::Mul(q[3], s);
+    }
+
+    // The Hamilton product, the same terms as simd::QuatMul but one lane per quaternion
+    static void MultiplyLanes(simd::v128 r[4], const simd::v128 a[4], const simd::v128 b[4])
+    {
+        r[0] = simd::Sub(simd::Add(simd::Add(simd::Mul(a[3], b[0]), simd::Mul(a[0], b[3])), simd::Mul(a[1], b[2])), simd::Mul(a[2], b[1]));
+        r[1] = simd::Add(simd::Add(simd::Sub(simd::Mul(a[3], b[1]), simd::Mul(a[0], b[2])), simd::Mul(a[1], b[3])), simd::Mul(a[2], b[0]));
+        r[2] = simd::Add(simd::Sub(simd::Add(simd::Mul(a[3], b[2]), simd::Mul(a[0], b[1])), simd::Mul(a[1], b[0])), simd::Mul(a[2], b[3]));
+        r[3] = simd::Sub(simd::Sub(simd::Sub(simd::Mul(a[3], b[3]), simd::Mul(a[0], b[0])), simd::Mul(a[1], b[1])), simd::Mul(a[2], b[2]));
+    }
+
+    template <bool slerp> static void InterpolateLanes(simd::v128 r[4], const simd::v128 a[4], simd::v128 b[4], simd::v128 t)
+    {
+        // Flip b to the same hemisphere as a to take the shortest arc
+        simd::v128 d = DotLanes(a, b);
+        for (unsigned int i = 0; i < 4; ++i)
+            b[i] = simd::MulSign(b[i], d);
+
+        simd::v128 one = simd::Splat(1.0f);
+        simd::v128 wa, wb;
+
+        if (slerp)
+        {
+            static const float mu = 1.85298109240830f;
+            static const float u[8] = { 1.0f/(1*3), 1.0f/(2*5), 1.0f/(3*7), 1.0f/(4*9), 1.0f/(5*11), 1.0f/(6*13), 1.0f/(7*15), mu/(8*17) };
+            static const float v[8] = { 1.0f/3, 2.0f/5, 3.0f/7, 4.0f/9, 5.0f/11, 6.0f/13, 7.0f/15, mu*8/17 };
+
+            simd::v128 xm1 = simd::Sub(simd::Abs(d), one);
+            simd::v128 s = simd::Sub(one, t);
+            simd::v128 t2 = simd::Mul(t, t), s2 = simd::Mul(s, s);
+
+            simd::v128 ca = one, cb = one;
+            for (int i = 7; i >= 0; --i)
+            {
+                simd::v128 ui = simd::Splat(u[i]), vi = simd::Splat(v[i]);
+                cb = simd::Add(one, simd::Mul(simd::Mul(simd::Sub(simd::Mul(ui, t2), vi), xm1), cb));
+                ca = simd::Add(one, simd::Mul(simd::Mul(simd::Sub(simd::Mul(ui, s2), vi), xm1), ca));
+            }
+            wa = simd::Mul(s, ca);
+            wb = simd::Mul(t, cb);
+        }
+        else
+        {
+            wa = simd::Sub(one, t);
+            wb = t;
+        }
+
+        for (unsigned int i = 0; i < 4; ++i)
+            r[i] = simd::Add(simd::Mul(a[i], wa), simd::Mul(b[i], wb));
+
+        if (!slerp)
+            NormalizeLanes(r);
+    }
+
+    template <typename W, bool slerp> static void Interpolate(Quat* out, const Quat* a, const Quat* b, const W &w, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            Lanes la, lb, lr;
+            la.Load(a + i);
+            lb.Load(b + i);
+            InterpolateLanes<slerp>(lr.c, la.c, lb.c, w.Load(i));
+            lr.Store(out + i);
+        }
+        if (i < count)
+        {
+            Lanes la, lb, lr;
+            la.LoadTail(a + i, count - i);
+            lb.LoadTail(b + i, count - i);
+            InterpolateLanes<slerp>(lr.c, la.c, lb.c, w.LoadTail(i, count - i));
+            lr.StoreTail(out + i, count - i);
+        }
+    }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,353 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_SIMD_H
+#define MINI3D_MATH_SIMD_H
+
+// 4-wide float kernels used by Vec4 and Quat.
+//
+// Define MINI3D_MATH_SIMD to enable the SSE (x86/x64) or NEON (ARM) backend.
+// Without it, or on platforms with neither instruction set, the scalar
+// backend is used. The scalar backend evaluates the exact same expressions as
+// the classes did before, so results do not change unless SIMD is enabled.
+//
+// All kernels evaluate in the same order as the scalar code (including the
+// dot products, which are summed x, y, z, w left to right), so results are bit
+// identical between the backends as long as the compiler does not contract
+// multiplies and adds into FMA instructions. MulAdd is the one exception, it
+// is fused when the target has FMA (-mfma on x86, always on ARM64).
+
+#include <cmath>
+#include <stdint.h>
+
+#if defined(MINI3D_MATH_SIMD)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define MINI3D_MATH_SIMD_SSE
+        #include <emmintrin.h>
+        #if defined(__SSE4_1__)
+            #define MINI3D_MATH_SIMD_SSE41
+            #include <smmintrin.h>
+        #endif
+        #if defined(__FMA__)
+            #define MINI3D_MATH_SIMD_FMA
+            #include <immintrin.h>
+        #endif
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define MINI3D_MATH_SIMD_NEON
+        #include <arm_neon.h>
+    #endif
+#endif
+
+namespace mini3d {
+namespace math {
+namespace simd {
+
+
+////////// SSE ////////////////////////////////////////////////////////////////
+
+#if defined(MINI3D_MATH_SIMD_SSE)
+
+typedef __m128 v128;
+
+#define MINI3D_SIMD_SHUFFLE(v, x, y, z, w) _mm_shuffle_ps((v), (v), _MM_SHUFFLE((w), (z), (y), (x)))
+
+inline v128 Load(const float* p)                            { return _mm_loadu_ps(p); }
+inline v128 Load3(const float* p)                           { return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)p), _mm_load_ss(p + 2)); }
+inline void Store(float* p, v128 v)                         { _mm_storeu_ps(p, v); }
+inline void Store3(float* p, v128 v)                        { _mm_storel_pi((__m64*)p, v); _mm_store_ss(p + 2, _mm_movehl_ps(v, v)); }
+inline v128 Set(float x, float y, float z, float w)         { return _mm_setr_ps(x, y, z, w); }
+inline v128 Splat(float s)                                  { return _mm_set1_ps(s); }
+inline v128 Zero()                                          { return _mm_setzero_ps(); }
+inline float GetX(v128 v)                                   { return _mm_cvtss_f32(v); }
+
+inline v128 Add(v128 a, v128 b)                             { return _mm_add_ps(a, b); }
+inline v128 Sub(v128 a, v128 b)                             { return _mm_sub_ps(a, b); }
+inline v128 Mul(v128 a, v128 b)                             { return _mm_mul_ps(a, b); }
+inline v128 Div(v128 a, v128 b)                             { return _mm_div_ps(a, b); }
+#if defined(MINI3D_MATH_SIMD_FMA)
+inline v128 MulAdd(v128 a, v128 b, v128 c)                  { return _mm_fmadd_ps(a, b, c); }
+#else
+inline v128 MulAdd(v128 a, v128 b, v128 c)                  { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#endif
+inline v128 Neg(v128 a)                                     { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+inline v128 Sqrt(v128 a)                                    { return _mm_sqrt_ps(a); }
+inline v128 Min(v128 a, v128 b)                             { return _mm_min_ps(a, b); }
+inline v128 Max(v128 a, v128 b)                             { return _mm_max_ps(a, b); }
+inline v128 Abs(v128 a)                                     { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+#if defined(MINI3D_MATH_SIMD_SSE41)
+inline v128 Round(v128 a)                                   { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+#else
+inline v128 Round(v128 a)                                   { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); } // |a| < 2^31
+#endif
+inline void StoreInt(int32_t* p, v128 v)                    { _mm_storeu_si128((__m128i*)p, _mm_cvtps_epi32(v)); } // Rounded to nearest even
+inline v128 LoadInt(const int32_t* p)                       { return _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)p)); }
+inline v128 MulSign(v128 a, v128 s)                         { return _mm_xor_ps(a, _mm_and_ps(s, _mm_set1_ps(-0.0f))); }
+
+// Estimate of 1 / sqrt(a) with about 12 bits of precision
+inline v128 RsqrtEstimate(v128 a)                           { return _mm_rsqrt_ps(a); }
+
+// Bit i is set if lane i of a is greater than lane i of b
+inline int GreaterMask(v128 a, v128 b)                      { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)); }
+
+inline v128 SplatX(v128 v)                                  { return MINI3D_SIMD_SHUFFLE(v, 0, 0, 0, 0); }
+inline v128 SplatY(v128 v)                                  { return MINI3D_SIMD_SHUFFLE(v, 1, 1, 1, 1); }
+inline v128 SplatZ(v128 v)                                  { return MINI3D_SIMD_SHUFFLE(v, 2, 2, 2, 2); }
+inline v128 SplatW(v128 v)                                  { return MINI3D_SIMD_SHUFFLE(v, 3, 3, 3, 3); }
+
+// Clears the w component
+inline v128 MaskXYZ(v128 v)
+{
+#if defined(MINI3D_MATH_SIMD_SSE41)
+    return _mm_blend_ps(v, _mm_setzero_ps(), 0x8);
+#else
+    return _mm_and_ps(v, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+#endif
+}
+
+// Flips the sign of the lanes where the mask bit is set (x = 1, y = 2, z = 4, w = 8)
+template <int mask> inline v128 FlipSigns(v128 v)
+{
+    return _mm_xor_ps(v, _mm_castsi128_ps(_mm_setr_epi32((mask & 1) ? 0x80000000 : 0, (mask & 2) ? 0x80000000 : 0, (mask & 4) ? 0x80000000 : 0, (mask & 8) ? 0x80000000 : 0)));
+}
+
+inline v128 Dot3(v128 a, v128 b)
+{
+    v128 m = _mm_mul_ps(a, b);
+    v128 s = _mm_add_ss(m, MINI3D_SIMD_SHUFFLE(m, 1, 1, 1, 1));
+    s = _mm_add_ss(s, MINI3D_SIMD_SHUFFLE(m, 2, 2, 2, 2));
+    return SplatX(s);
+}
+
+inline v128 Dot4(v128 a, v128 b)
+{
+    v128 m = _mm_mul_ps(a, b);
+    v128 s = _mm_add_ss(m, MINI3D_SIMD_SHUFFLE(m, 1, 1, 1, 1));
+    s = _mm_add_ss(s, MINI3D_SIMD_SHUFFLE(m, 2, 2, 2, 2));
+    s = _mm_add_ss(s, MINI3D_SIMD_SHUFFLE(m, 3, 3, 3, 3));
+    return SplatX(s);
+}
+
+inline v128 Cross3(v128 a, v128 b)
+{
+    v128 r = _mm_sub_ps(_mm_mul_ps(MINI3D_SIMD_SHUFFLE(a, 1, 2, 0, 3), MINI3D_SIMD_SHUFFLE(b, 2, 0, 1, 3)),
+                        _mm_mul_ps(MINI3D_SIMD_SHUFFLE(a, 2, 0, 1, 3), MINI3D_SIMD_SHUFFLE(b, 1, 2, 0, 3)));
+    return MaskXYZ(r);
+}
+
+inline v128 ReverseXYZW(v128 v)                             { return MINI3D_SIMD_SHUFFLE(v, 3, 2, 1, 0); }
+inline v128 SwapPairs(v128 v)                               { return MINI3D_SIMD_SHUFFLE(v, 2, 3, 0, 1); }
+inline v128 SwapAdjacent(v128 v)                            { return MINI3D_SIMD_SHUFFLE(v, 1, 0, 3, 2); }
+
+// Transposes the 4x4 matrix with rows a, b, c, d
+inline void Transpose(v128 &a, v128 &b, v128 &c, v128 &d)   { _MM_TRANSPOSE4_PS(a, b, c, d); }
+
+
+////////// NEON ///////////////////////////////////////////////////////////////
+
+#elif defined(MINI3D_MATH_SIMD_NEON)
+
+typedef float32x4_t v128;
+
+inline v128 Load(const float* p)                            { return vld1q_f32(p); }
+inline v128 Load3(const float* p)                           { return vcombine_f32(vld1_f32(p), vld1_lane_f32(p + 2, vdup_n_f32(0), 0)); }
+inline void Store(float* p, v128 v)                         { vst1q_f32(p, v); }
+inline void Store3(float* p, v128 v)                        { vst1_f32(p, vget_low_f32(v)); vst1q_lane_f32(p + 2, v, 2); }
+inline v128 Set(float x, float y, float z, float w)         { float f[4] = { x, y, z, w }; return vld1q_f32(f); }
+inline v128 Splat(float s)                                  { return vdupq_n_f32(s); }
+inline v128 Zero()                                          { return vdupq_n_f32(0); }
+inline float GetX(v128 v)                                   { return vgetq_lane_f32(v, 0); }
+
+inline v128 Add(v128 a, v128 b)                             { return vaddq_f32(a, b); }
+inline v128 Sub(v128 a, v128 b)                             { return vsubq_f32(a, b); }
+inline v128 Mul(v128 a, v128 b)                             { return vmulq_f32(a, b); }
+inline v128 Neg(v128 a)                                     { return vnegq_f32(a); }
+inline v128 Min(v128 a, v128 b)                             { return vminq_f32(a, b); }
+inline v128 Max(v128 a, v128 b)                             { return vmaxq_f32(a, b); }
+inline v128 Abs(v128 a)                                     { return vabsq_f32(a); }
+#if defined(__aarch64__)
+inline v128 Round(v128 a)                                   { return vrndnq_f32(a); }
+#else
+inline v128 Round(v128 a)                                   { return vcvtq_f32_s32(vcvtq_s32_f32(vaddq_f32(a, vbslq_f32(vdupq_n_u32(0x80000000u), a, vdupq_n_f32(0.5f))))); } // |a| < 2^31, ties away from zero
+#endif
+inline void StoreInt(int32_t* p, v128 v)                    { vst1q_s32(p, vcvtq_s32_f32(Round(v))); } // Rounded like Round
+inline v128 LoadInt(const int32_t* p)                       { return vcvtq_f32_s32(vld1q_s32(p)); }
+inline v128 MulSign(v128 a, v128 s)                         { return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vandq_u32(vreinterpretq_u32_f32(s), vdupq_n_u32(0x80000000u)))); }
+
+inline v128 RsqrtEstimate(v128 a)                           { return vrsqrteq_f32(a); }
+
+inline int GreaterMask(v128 a, v128 b)
+{
+    static const uint32_t bits[4] = { 1, 2, 4, 8 };
+    uint32x4_t m = vandq_u32(vcgtq_f32(a, b), vld1q_u32(bits));
+    uint32x2_t s = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+    return (int)(vget_lane_u32(s, 0) | vget_lane_u32(s, 1));
+}
+
+#if defined(__aarch64__)
+inline v128 Div(v128 a, v128 b)                             { return vdivq_f32(a, b); }
+inline v128 MulAdd(v128 a, v128 b, v128 c)                  { return vfmaq_f32(c, a, b); }
+inline v128 Sqrt(v128 a)                                    { return vsqrtq_f32(a); }
+#else
+// ARMv7 NEON has no vector divide or square root, fall back to VFP per lane to stay exact
+inline v128 Div(v128 a, v128 b)                             { float x[4], y[4]; vst1q_f32(x, a); vst1q_f32(y, b); return Set(x[0] / y[0], x[1] / y[1], x[2] / y[2], x[3] / y[3]); }
+inline v128 Sqrt(v128 a)                                    { float x[4]; vst1q_f32(x, a); return Set(sqrtf(x[0]), sqrtf(x[1]), sqrtf(x[2]), sqrtf(x[3])); }
+inline v128 MulAdd(v128 a, v128 b, v128 c)                  { return vaddq_f32(vmulq_f32(a, b), c); }
+#endif
+
+inline v128 SplatX(v128 v)                                  { return vdupq_lane_f32(vget_low_f32(v), 0); }
+inline v128 SplatY(v128 v)                                  { return vdupq_lane_f32(vget_low_f32(v), 1); }
+inline v128 SplatZ(v128 v)                                  { return vdupq_lane_f32(vget_high_f32(v), 0); }
+inline v128 SplatW(v128 v)                                  { return vdupq_lane_f32(vget_high_f32(v), 1); }
+
+inline v128 MaskXYZ(v128 v)                                 { return vsetq_lane_f32(0, v, 3); }
+
+template <int mask> inline v128 FlipSigns(v128 v)
+{
+    static const uint32_t m[4] = { (mask & 1) ? 0x80000000u : 0, (mask & 2) ? 0x80000000u : 0, (mask & 4) ? 0x80000000u : 0, (mask & 8) ? 0x80000000u : 0 };
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(v), vld1q_u32(m)));
+}
+
+inline v128 Dot3(v128 a, v128 b)
+{
+    v128 m = vmulq_f32(a, b);
+    return vdupq_n_f32((vgetq_lane_f32(m, 0) + vgetq_lane_f32(m, 1)) + vgetq_lane_f32(m, 2));
+}
+
+inline v128 Dot4(v128 a, v128 b)
+{
+    v128 m = vmulq_f32(a, b);
+    return vdupq_n_f32(((vgetq_lane_f32(m, 0) + vgetq_lane_f32(m, 1)) + vgetq_lane_f32(m, 2)) + vgetq_lane_f32(m, 3));
+}
+
+inline v128 Cross3(v128 a, v128 b)
+{
+    float32x4_t a_yzx = vcombine_f32(vext_f32(vget_low_f32(a), vget_high_f32(a), 1), vget_low_f32(a));
+    float32x4_t b_yzx = vcombine_f32(vext_f32(vget_low_f32(b), vget_high_f32(b), 1), vget_low_f32(b));
+    // a * b_yzx - a_yzx * b gives the cross product in (z, x, y) order, rotate it back to (x, y, z)
+    float32x4_t r = vsubq_f32(vmulq_f32(a, b_yzx), vmulq_f32(a_yzx, b));
+    r = vcombine_f32(vext_f32(vget_low_f32(r), vget_high_f32(r), 1), vget_low_f32(r));
+    return MaskXYZ(r);
+}
+
+inline v128 ReverseXYZW(v128 v)                             { float32x4_t r = vrev64q_f32(v); return vcombine_f32(vget_high_f32(r), vget_low_f32(r)); }
+inline v128 SwapPairs(v128 v)                               { return vcombine_f32(vget_high_f32(v), vget_low_f32(v)); }
+inline v128 SwapAdjacent(v128 v)                            { return vrev64q_f32(v); }
+
+inline void Transpose(v128 &a, v128 &b, v128 &c, v128 &d)
+{
+    float32x4x2_t ab = vtrnq_f32(a, b);
+    float32x4x2_t cd = vtrnq_f32(c, d);
+    a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+    b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+    c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+
+////////// SCALAR /////////////////////////////////////////////////////////////
+
+#else
+
+struct v128 { float x, y, z, w; };
+
+inline v128 Set(float x, float y, float z, float w)         { v128 r = { x, y, z, w }; return r; }
+inline v128 Load(const float* p)                            { return Set(p[0], p[1], p[2], p[3]); }
+inline v128 Load3(const float* p)                           { return Set(p[0], p[1], p[2], 0); }
+inline void Store(float* p, v128 v)                         { p[0] = v.x, p[1] = v.y, p[2] = v.z, p[3] = v.w; }
+inline void Store3(float* p, v128 v)                        { p[0] = v.x, p[1] = v.y, p[2] = v.z; }
+inline v128 Splat(float s)                                  { return Set(s, s, s, s); }
+inline v128 Zero()                                          { return Set(0, 0, 0, 0); }
+inline float GetX(v128 v)                                   { return v.x; }
+
+inline v128 Add(v128 a, v128 b)                             { return Set(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); }
+inline v128 Sub(v128 a, v128 b)                             { return Set(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); }
+inline v128 Mul(v128 a, v128 b)                             { return Set(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w); }
+inline v128 Div(v128 a, v128 b)                             { return Set(a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w); }
+inline v128 MulAdd(v128 a, v128 b, v128 c)                  { return Set(a.x * b.x + c.x, a.y * b.y + c.y, a.z * b.z + c.z, a.w * b.w + c.w); }
+inline v128 Neg(v128 a)                                     { return Set(-a.x, -a.y, -a.z, -a.w); }
+inline v128 Sqrt(v128 a)                                    { return Set((float)sqrt(a.x), (float)sqrt(a.y), (float)sqrt(a.z), (float)sqrt(a.w)); }
+inline v128 Min(v128 a, v128 b)                             { return Set(a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z, a.w < b.w ? a.w : b.w); }
+inline v128 Max(v128 a, v128 b)                             { return Set(a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z, a.w > b.w ? a.w : b.w); }
+inline v128 Abs(v128 a)                                     { return Set(fabs(a.x), fabs(a.y), fabs(a.z), fabs(a.w)); }
+inline v128 Round(v128 a)                                   { return Set(nearbyint(a.x), nearbyint(a.y), nearbyint(a.z), nearbyint(a.w)); }
+inline void StoreInt(int32_t* p, v128 v)                    { p[0] = (int32_t)nearbyint(v.x), p[1] = (int32_t)nearbyint(v.y), p[2] = (int32_t)nearbyint(v.z), p[3] = (int32_t)nearbyint(v.w); }
+inline v128 LoadInt(const int32_t* p)                       { return Set((float)p[0], (float)p[1], (float)p[2], (float)p[3]); }
+inline v128 MulSign(v128 a, v128 s)                         { return Set(s.x < 0 ? -a.x : a.x, s.y < 0 ? -a.y : a.y, s.z < 0 ? -a.z : a.z, s.w < 0 ? -a.w : a.w); }
+
+inline v128 RsqrtEstimate(v128 a)                           { return Set(1.0f / (float)sqrt(a.x), 1.0f / (float)sqrt(a.y), 1.0f / (float)sqrt(a.z), 1.0f / (float)sqrt(a.w)); }
+
+inline int GreaterMask(v128 a, v128 b)                      { return (a.x > b.x ? 1 : 0) | (a.y > b.y ? 2 : 0) | (a.z > b.z ? 4 : 0) | (a.w > b.w ? 8 : 0); }
+
+inline v128 SplatX(v128 v)                                  { return Splat(v.x); }
+inline v128 SplatY(v128 v)                                  { return Splat(v.y); }
+inline v128 SplatZ(v128 v)                                  { return Splat(v.z); }
+inline v128 SplatW(v128 v)                                  { return Splat(v.w); }
+
+inline v128 MaskXYZ(v128 v)                                 { return Set(v.x, v.y, v.z, 0); }
+
+template <int mask> inline v128 FlipSigns(v128 v)           { return Set((mask & 1) ? -v.x : v.x, (mask & 2) ? -v.y : v.y, (mask & 4) ? -v.z : v.z, (mask & 8) ? -v.w : v.w); }
+
+inline v128 Dot3(v128 a, v128 b)                            { return Splat(a.x * b.x + a.y * b.y + a.z * b.z); }
+inline v128 Dot4(v128 a, v128 b)                            { return Splat(a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w); }
+inline v128 Cross3(v128 a, v128 b)                          { return Set(a.y*b.z - b.y*a.z, a.z*b.x - b.z*a.x, a.x*b.y - b.x*a.y, 0); }
+
+inline v128 ReverseXYZW(v128 v)                             { return Set(v.w, v.z, v.y, v.x); }
+inline v128 SwapPairs(v128 v)                               { return Set(v.z, v.w, v.x, v.y); }
+inline v128 SwapAdjacent(v128 v)                            { return Set(v.y, v.x, v.w, v.z); }
+
+inline void Transpose(v128 &a, v128 &b, v128 &c, v128 &d)
+{
+    v128 r0 = Set(a.x, b.x, c.x, d.x), r1 = Set(a.y, b.y, c.y, d.y), r2 = Set(a.z, b.z, c.z, d.z), r3 = Set(a.w, b.w, c.w, d.w);
+    a = r0, b = r1, c = r2, d = r3;
+}
+
+#endif
+
+
+////////// SHARED KERNELS /////////////////////////////////////////////////////
+
+// 1 / sqrt(a) from the hardware estimate refined with one Newton-Raphson step, about 22 bits of precision
+inline v128 Rsqrt(v128 a)
+{
+    v128 y = RsqrtEstimate(a);
+    return Mul(y, Sub(Splat(1.5f), Mul(Mul(Splat(0.5f), a), Mul(y, y))));
+}
+
+// Hamilton product, same term order as the scalar Quat::operator *
+inline v128 QuatMul(v128 a, v128 b)
+{
+    v128 r = Mul(SplatW(a), b);
+    r = Add(r, FlipSigns<0xA>(Mul(SplatX(a), ReverseXYZW(b))));
+    r = Add(r, FlipSigns<0xC>(Mul(SplatY(a), SwapPairs(b))));
+    r = Add(r, FlipSigns<0x9>(Mul(SplatZ(a), SwapAdjacent(b))));
+    return r;
+}
+
+inline v128 QuatConjugate(v128 q)                           { return FlipSigns<0x7>(q); }
+
+// Cubic Hermite spline through p0 and p1 with tangents m0 and m1, summed in the order
+// p0 h00 + p1 h01 + m0 h10 + m1 h11
+inline v128 Hermite(v128 p0, v128 p1, v128 m0, v128 m1, float t)
+{
+    float t2 = t * t, t3 = t2 * t;
+    v128 r = Mul(p0, Splat(2 * t3 - 3 * t2 + 1));
+    r = MulAdd(p1, Splat(-2 * t3 + 3 * t2), r);
+    r = MulAdd(m0, Splat(t3 - 2 * t2 + t), r);
+    return MulAdd(m1, Splat(t3 - t2), r);
+}
+
+// v + 2r x (r x v + w v), where r is the vector part of q. The w component of v passes through unchanged.
+inline v128 QuatTransform(v128 q, v128 v)
+{
+    v128 r = MaskXYZ(q);
+    v128 a = Add(Cross3(r, v), Mul(v, SplatW(q)));
+    return Add(v, Cross3(Add(r, r), a));
+}
+
+}
+}
+}
+
+#endif
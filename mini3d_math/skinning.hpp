@@ -0,0 +1,123 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_SKINNING_H
+#define MINI3D_MATH_SKINNING_H
+
+#include "simd.hpp"
+#include "transform.hpp"
+#include "dualquat.hpp"
+
+namespace mini3d {
+namespace math {
+
+
+////////// SKINNING ///////////////////////////////////////////////////////////
+
+// CPU dual quaternion skinning of interleaved vertex data. GROUPS holds 4 joint
+// indices followed by 4 weights, all floats, as written by export_m3d.py.
+// Weights should sum to 1, unused slots have weight 0.
+
+struct Skinning
+{
+    // Vertex attributes in the order and sizes export_m3d.py writes them
+    enum Attribute { POSITION, NORMAL, TEXTURE, GROUPS, COLOR };
+
+    static const unsigned int NO_ATTRIBUTE = 0xffffffff;
+
+    // Byte offsets inside a vertex, NO_ATTRIBUTE when the vertex does not have NORMAL
+    struct VertexLayout
+    {
+        unsigned int stride;
+        unsigned int position;
+        unsigned int normal;
+        unsigned int groups;
+
+        static VertexLayout FromAttributes(const Attribute* pAttributes, unsigned int count)
+        {
+            static const unsigned int SIZES[] = { 3 * 4, 3 * 4, 2 * 4, 8 * 4, 3 * 4 };
+
+            VertexLayout layout = { 0, NO_ATTRIBUTE, NO_ATTRIBUTE, NO_ATTRIBUTE };
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                switch(pAttributes[i])
+                {
+                    case POSITION: layout.position = layout.stride; break;
+                    case NORMAL: layout.normal = layout.stride; break;
+                    case GROUPS: layout.groups = layout.stride; break;
+                    default: break;
+                }
+                layout.stride += SIZES[pAttributes[i]];
+            }
+            return layout;
+        }
+    };
+
+    // One dual quaternion and one scale per joint. pScales may be 0 if the scales are not needed.
+    static void DualQuatsFromTransforms(DualQuat* pOut, float* pScales, const Transform* pTransforms, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            pOut[i] = DualQuat::FromTransform(pTransforms[i]);
+            if (pScales)
+                pScales[i] = pTransforms[i].scale;
+        }
+    }
+
+    // Skins vertices [begin, end) of pIn into pOut. Only POSITION and NORMAL are
+    // written, the rest of pOut is left as it is. pOut may be pIn. The joint scales
+    // are blended linearly and applied to the position before the rotation, pScales
+    // may be 0 for unit scale. Ranges that do not overlap can run on separate threads.
+    static void SkinDualQuat(void* pOut, const void* pIn, unsigned int begin, unsigned int end, const VertexLayout &layout, const DualQuat* pJoints, const float* pScales)
+    {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            const char* pSrc = (const char*)pIn + i * layout.stride;
+            char* pDst = (char*)pOut + i * layout.stride;
+
+            const float* pGroups = (const float*)(pSrc + layout.groups);
+            const DualQuat* pJoint[4] = { &pJoints[(unsigned int)pGroups[0]], &pJoints[(unsigned int)pGroups[1]], &pJoints[(unsigned int)pGroups[2]], &pJoints[(unsigned int)pGroups[3]] };
+            simd::v128 w = simd::Load(pGroups + 4);
+
+            // Joints on the other side of the 4D hypersphere than the first are blended negated
+            simd::v128 r0 = pJoint[0]->real.Load();
+            simd::v128 w0 = simd::SplatX(w);
+            simd::v128 real = simd::Mul(r0, w0);
+            simd::v128 dual = simd::Mul(pJoint[0]->dual.Load(), w0);
+
+            simd::v128 wi[3] = { simd::SplatY(w), simd::SplatZ(w), simd::SplatW(w) };
+            for (unsigned int j = 0; j < 3; ++j)
+            {
+                simd::v128 r = pJoint[j + 1]->real.Load();
+                simd::v128 wj = simd::MulSign(wi[j], simd::Dot4(r0, r));
+                real = simd::MulAdd(r, wj, real);
+                dual = simd::MulAdd(pJoint[j + 1]->dual.Load(), wj, dual);
+            }
+
+            simd::v128 n = simd::Rsqrt(simd::Dot4(real, real));
+            real = simd::Mul(real, n);
+            dual = simd::Mul(dual, n);
+
+            simd::v128 p = simd::Load3((const float*)(pSrc + layout.position));
+            if (pScales)
+            {
+                simd::v128 s = simd::Set(pScales[(unsigned int)pGroups[0]], pScales[(unsigned int)pGroups[1]], pScales[(unsigned int)pGroups[2]], pScales[(unsigned int)pGroups[3]]);
+                p = simd::Mul(p, simd::Dot4(s, w));
+            }
+
+            // p' = real p real* + 2 dual real*
+            simd::v128 t = simd::QuatMul(dual, simd::QuatConjugate(real));
+            simd::Store3((float*)(pDst + layout.position), simd::Add(simd::QuatTransform(real, p), simd::Add(t, t)));
+
+            if (layout.normal != NO_ATTRIBUTE)
+                simd::Store3((float*)(pDst + layout.normal), simd::QuatTransform(real, simd::Load3((const float*)(pSrc + layout.normal))));
+        }
+    }
+};
+
+}
+}
+
+#endif
@@ -9,6 +9,8 @@
 
 #include "vec3.hpp"
 #include "quat.hpp"
+#include "mat4.hpp"
+#include "fastmath.hpp"
 
 #include <cstring>
 
@@ -32,7 +34,6 @@ struct Transform
     float scale;
 
     Transform() : pos(Vec3(0.0f)), rot(Quat(0.0f)), scale(0.0f) { };
-    Transform(const Transform &t) : pos(t.pos), rot(t.rot), scale(t.scale) { };
     Transform(const float pos[3], const float rot[4], float scale) : pos(pos), rot(rot), scale(scale) {}
 
     static Transform Identity() { return Transform(Vec3(0.0f), Quat(0.0f, 0.0f, 0.0f, 1.0f), 1.0f); }
@@ -55,7 +56,14 @@ struct Transform
 
     }
 
-    void ToMatrix(float m[16]) 
+    Mat4 ToMatrix() const
+    {
+        Mat4 m;
+        ToMatrix(m.m);
+        return m;
+    }
+
+    void ToMatrix(float m[16]) const
     {
         // http://www.flipcode.com/documents/matrfaq.html#Q54
 
@@ -90,10 +98,17 @@ struct Transform
         m[15] = 1;
     }
 
-    void ToViewProjectionMatrix(float m[16], float fov, float aspect, float znear, float zfar)
+    Mat4 ToViewProjectionMatrix(float fov, float aspect, float znear, float zfar) const
+    {
+        Mat4 m;
+        ToViewProjectionMatrix(m.m, fov, aspect, znear, zfar);
+        return m;
+    }
+
+    void ToViewProjectionMatrix(float m[16], float fov, float aspect, float znear, float zfar) const
     {
 
-        float w = 1.0f/tan(fov/2.0f);
+        float w = 1.0f/Tan(fov/2.0f);
 	    float h = w * aspect;
 	    float z1 = zfar / (znear-zfar);
 	    float z2 = z1 * znear;
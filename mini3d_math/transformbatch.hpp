@@ -0,0 +1,221 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_TRANSFORMBATCH_H
+#define MINI3D_MATH_TRANSFORMBATCH_H
+
+#include "simd.hpp"
+#include "transform.hpp"
+
+void mini3d_assert(bool expression, const char* text, ...);
+
+namespace mini3d {
+namespace math {
+
+
+////////// TRANSFORM BATCH ////////////////////////////////////////////////////
+
+// Holds N transforms as structure of arrays, one stream per component.
+// Streams are padded to a multiple of 4 so the batch operations can always
+// process 4 transforms per iteration. The batch operations do what the per
+// object Transform functions do in the same order, the results may differ in
+// the last bits where the compiler contracts a multiply and an add into an FMA.
+
+class TransformBatch
+{
+public:
+
+    enum Stream { POS_X, POS_Y, POS_Z, ROT_X, ROT_Y, ROT_Z, ROT_W, SCALE, STREAM_COUNT };
+
+    TransformBatch(unsigned int count) : m_count(count), m_stride((count + 3) & ~3u)
+    {
+        m_pData = new float[m_stride * STREAM_COUNT];
+        for (unsigned int i = 0; i < m_stride; ++i)
+            Set(i, Transform::Identity());
+    }
+
+    ~TransformBatch()                                                   { delete[] m_pData; }
+
+    unsigned int GetCount() const                                       { return m_count; }
+
+    float* GetStream(Stream stream)                                     { return m_pData + m_stride * stream; }
+    const float* GetStream(Stream stream) const                         { return m_pData + m_stride * stream; }
+
+    void Set(unsigned int index, const Transform &t)
+    {
+        float* p = m_pData + index;
+        p[m_stride * POS_X] = t.pos.x, p[m_stride * POS_Y] = t.pos.y, p[m_stride * POS_Z] = t.pos.z;
+        p[m_stride * ROT_X] = t.rot.x, p[m_stride * ROT_Y] = t.rot.y, p[m_stride * ROT_Z] = t.rot.z, p[m_stride * ROT_W] = t.rot.w;
+        p[m_stride * SCALE] = t.scale;
+    }
+
+    Transform Get(unsigned int index) const
+    {
+        const float* p = m_pData + index;
+        Transform t;
+        t.pos = Vec3(p[m_stride * POS_X], p[m_stride * POS_Y], p[m_stride * POS_Z]);
+        t.rot = Quat(p[m_stride * ROT_X], p[m_stride * ROT_Y], p[m_stride * ROT_Z], p[m_stride * ROT_W]);
+        t.scale = p[m_stride * SCALE];
+        return t;
+    }
+
+    // out[i] = a[i] * b[i], the batches must have the same count. out may be a or b.
+    static void Compose(TransformBatch &out, const TransformBatch &a, const TransformBatch &b)
+    {
+        mini3d_assert(a.m_count == out.m_count && b.m_count == out.m_count, "Composing transform batches of %u and %u transforms into %u", a.m_count, b.m_count, out.m_count);
+
+        for (unsigned int i = 0; i < out.m_stride; i += 4)
+        {
+            Lanes la, lb, lo;
+            a.LoadLanes(la, i);
+            b.LoadLanes(lb, i);
+
+            // pos = a.pos + a.rot.Transform(b.pos * a.scale)
+            simd::v128 v[3] = { simd::Mul(lb.pos[0], la.scale), simd::Mul(lb.pos[1], la.scale), simd::Mul(lb.pos[2], la.scale) };
+            RotateLanes(v, la.rot);
+            lo.pos[0] = simd::Add(la.pos[0], v[0]);
+            lo.pos[1] = simd::Add(la.pos[1], v[1]);
+            lo.pos[2] = simd::Add(la.pos[2], v[2]);
+
+            // rot = a.rot * b.rot
+            MultiplyLanes(lo.rot, la.rot, lb.rot);
+
+            lo.scale = simd::Mul(la.scale, lb.scale);
+
+            out.StoreLanes(lo, i);
+        }
+    }
+
+    // Writes one matrix per transform, same layout as Transform::ToMatrix
+    void ToMatrices(float (*m)[16]) const
+    {
+        for (unsigned int i = 0; i < m_stride; i += 4)
+        {
+            Lanes l;
+            LoadLanes(l, i);
+
+            simd::v128 rows[3][4];
+            MatrixRows(rows, l.pos, l.rot, l.scale);
+
+            for (unsigned int j = 0; j < 4 && i + j < m_count; ++j)
+            {
+                simd::Store(m[i + j], rows[0][j]);
+                simd::Store(m[i + j] + 4, rows[1][j]);
+                simd::Store(m[i + j] + 8, rows[2][j]);
+                simd::Store(m[i + j] + 12, simd::Set(0, 0, 0, 1));
+            }
+        }
+    }
+
+    // out[i] = transform[i] * in[i]
+    void TransformPoints(Vec3* out, const Vec3* in) const
+    {
+        for (unsigned int i = 0; i < m_stride; i += 4)
+        {
+            Lanes l;
+            LoadLanes(l, i);
+
+            // Gather up to 4 points into component streams
+            float p[3][4] = { { 0 } };
+            unsigned int n = (m_count - i < 4) ? m_count - i : 4;
+            for (unsigned int j = 0; j < n; ++j)
+                p[0][j] = in[i + j].x, p[1][j] = in[i + j].y, p[2][j] = in[i + j].z;
+
+            // pos + rot.Transform(v * scale)
+            simd::v128 v[3] = { simd::Mul(simd::Load(p[0]), l.scale), simd::Mul(simd::Load(p[1]), l.scale), simd::Mul(simd::Load(p[2]), l.scale) };
+            RotateLanes(v, l.rot);
+            simd::Store(p[0], simd::Add(l.pos[0], v[0]));
+            simd::Store(p[1], simd::Add(l.pos[1], v[1]));
+            simd::Store(p[2], simd::Add(l.pos[2], v[2]));
+
+            for (unsigned int j = 0; j < n; ++j)
+                out[i + j] = Vec3(p[0][j], p[1][j], p[2][j]);
+        }
+    }
+
+    // Upper 3 rows of the matrices of 4 transforms given as x, y, z (and w) lanes.
+    // rows[r][j] is row r of the matrix of transform j, same values as Transform::ToMatrix.
+    static void MatrixRows(simd::v128 rows[3][4], const simd::v128 pos[3], const simd::v128 rot[4], simd::v128 scale)
+    {
+        simd::v128 one = simd::Splat(1.0f);
+        simd::v128 two = simd::Splat(2.0f);
+
+        simd::v128 xx = simd::Mul(rot[0], rot[0]), xy = simd::Mul(rot[0], rot[1]), xz = simd::Mul(rot[0], rot[2]), xw = simd::Mul(rot[0], rot[3]);
+        simd::v128 yy = simd::Mul(rot[1], rot[1]), yz = simd::Mul(rot[1], rot[2]), yw = simd::Mul(rot[1], rot[3]);
+        simd::v128 zz = simd::Mul(rot[2], rot[2]), zw = simd::Mul(rot[2], rot[3]);
+
+        rows[0][0] = simd::Mul(simd::Sub(one, simd::Mul(two, simd::Add(yy, zz))), scale), rows[0][1] = simd::Mul(two, simd::Sub(xy, zw)), rows[0][2] = simd::Mul(two, simd::Add(xz, yw)), rows[0][3] = pos[0];
+        rows[1][0] = simd::Mul(two, simd::Add(xy, zw)), rows[1][1] = simd::Mul(simd::Sub(one, simd::Mul(two, simd::Add(xx, zz))), scale), rows[1][2] = simd::Mul(two, simd::Sub(yz, xw)), rows[1][3] = pos[1];
+        rows[2][0] = simd::Mul(two, simd::Sub(xz, yw)), rows[2][1] = simd::Mul(two, simd::Add(yz, xw)), rows[2][2] = simd::Mul(simd::Sub(one, simd::Mul(two, simd::Add(xx, yy))), scale), rows[2][3] = pos[2];
+
+        // The lanes hold one component for 4 transforms, transpose to get 4 rows per component
+        for (unsigned int r = 0; r < 3; ++r)
+            simd::Transpose(rows[r][0], rows[r][1], rows[r][2], rows[r][3]);
+    }
+
+private:
+
+    struct Lanes { simd::v128 pos[3]; simd::v128 rot[4]; simd::v128 scale; };
+
+    void LoadLanes(Lanes &l, unsigned int i) const
+    {
+        const float* p = m_pData + i;
+        l.pos[0] = simd::Load(p + m_stride * POS_X), l.pos[1] = simd::Load(p + m_stride * POS_Y), l.pos[2] = simd::Load(p + m_stride * POS_Z);
+        l.rot[0] = simd::Load(p + m_stride * ROT_X), l.rot[1] = simd::Load(p + m_stride * ROT_Y), l.rot[2] = simd::Load(p + m_stride * ROT_Z), l.rot[3] = simd::Load(p + m_stride * ROT_W);
+        l.scale = simd::Load(p + m_stride * SCALE);
+    }
+
+    void StoreLanes(const Lanes &l, unsigned int i)
+    {
+        float* p = m_pData + i;
+        simd::Store(p + m_stride * POS_X, l.pos[0]), simd::Store(p + m_stride * POS_Y, l.pos[1]), simd::Store(p + m_stride * POS_Z, l.pos[2]);
+        simd::Store(p + m_stride * ROT_X, l.rot[0]), simd::Store(p + m_stride * ROT_Y, l.rot[1]), simd::Store(p + m_stride * ROT_Z, l.rot[2]), simd::Store(p + m_stride * ROT_W, l.rot[3]);
+        simd::Store(p + m_stride * SCALE, l.scale);
+    }
+
+    // (a x b) per lane, same product order as Vec3::Cross
+    static void CrossLanes(simd::v128 r[3], const simd::v128 a[3], const simd::v128 b[3])
+    {
+        r[0] = simd::Sub(simd::Mul(a[1], b[2]), simd::Mul(b[1], a[2]));
+        r[1] = simd::Sub(simd::Mul(a[2], b[0]), simd::Mul(b[2], a[0]));
+        r[2] = simd::Sub(simd::Mul(a[0], b[1]), simd::Mul(b[0], a[1]));
+    }
+
+    // v = q.Transform(v) per lane
+    static void RotateLanes(simd::v128 v[3], const simd::v128 q[4])
+    {
+        simd::v128 c[3], r2[3] = { simd::Add(q[0], q[0]), simd::Add(q[1], q[1]), simd::Add(q[2], q[2]) }, b[3];
+        CrossLanes(c, q, v);
+        c[0] = simd::Add(c[0], simd::Mul(v[0], q[3]));
+        c[1] = simd::Add(c[1], simd::Mul(v[1], q[3]));
+        c[2] = simd::Add(c[2], simd::Mul(v[2], q[3]));
+        CrossLanes(b, r2, c);
+        v[0] = simd::Add(v[0], b[0]);
+        v[1] = simd::Add(v[1], b[1]);
+        v[2] = simd::Add(v[2], b[2]);
+    }
+
+    // r = a * b per lane, same term order as Quat::operator *
+    static void MultiplyLanes(simd::v128 r[4], const simd::v128 a[4], const simd::v128 b[4])
+    {
+        using namespace simd;
+        r[0] = Sub(Add(Add(Mul(a[3], b[0]), Mul(a[0], b[3])), Mul(a[1], b[2])), Mul(a[2], b[1]));
+        r[1] = Add(Add(Sub(Mul(a[3], b[1]), Mul(a[0], b[2])), Mul(a[1], b[3])), Mul(a[2], b[0]));
+        r[2] = Add(Sub(Add(Mul(a[3], b[2]), Mul(a[0], b[1])), Mul(a[1], b[0])), Mul(a[2], b[3]));
+        r[3] = Sub(Sub(Sub(Mul(a[3], b[3]), Mul(a[0], b[0])), Mul(a[1], b[1])), Mul(a[2], b[2]));
+    }
+
+    TransformBatch(const TransformBatch&);
+    TransformBatch& operator =(const TransformBatch&);
+
+    float* m_pData;
+    unsigned int m_count;
+    unsigned int m_stride;
+};
+
+}
+}
+
+#endif
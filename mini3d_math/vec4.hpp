@@ -11,72 +11,84 @@
 
 #include <cmath>
 
+#include "simd.hpp"
+#include "vecn.hpp"
+
 namespace mini3d {
 namespace math {
 
 
 ////////// VECTOR 4 ///////////////////////////////////////////////////////////
 
-class Vec4
+// Specialization of VecN<float, 4> that runs on the simd kernels
+
+template <> class VecN<float, 4>
 {
 public:
 
     float x, y, z, w;
 
-    inline Vec4()                                                              {}
-    inline Vec4(float s) : x(s), y(s), z(s), w(s)                              {} 
-    inline Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w)   {} 
-    inline Vec4(const float v[4]) : x(v[0]), y(v[1]), z(v[2]), w(v[3])         {}
-    inline Vec4(float v[4]) : x(v[0]), y(v[1]), z(v[2]), w(v[3])               {}
-    inline Vec4(const Vec4 &v) : x(v.x), y(v.y), z(v.z), w(v.w)                {}
+    inline VecN()                                                              {}
+    inline VecN(float s) : x(s), y(s), z(s), w(s)                              {} 
+    inline VecN(float x, float y, float z, float w) : x(x), y(y), z(z), w(w)   {} 
+    inline VecN(const float v[4]) : x(v[0]), y(v[1]), z(v[2]), w(v[3])         {}
+    inline VecN(float v[4]) : x(v[0]), y(v[1]), z(v[2]), w(v[3])               {}
+    inline explicit VecN(simd::v128 v)                                         { simd::Store(&x, v); }
+
+    inline simd::v128 Load() const                                      { return simd::Load(&x); }
 
 	inline operator float*()                                            { return &x; }
 	inline operator const float*() const                                { return &x; }
 
-    inline const bool operator == ( const Vec4 &v ) const               { return (v.x==x && v.y==y && v.z == z && v.w == w); }
-	inline const bool operator != ( const Vec4 &v ) const               { return !(*this == v); }
+    inline const bool operator == ( const VecN &v ) const               { return (v.x==x && v.y==y && v.z == z && v.w == w); }
+	inline const bool operator != ( const VecN &v ) const               { return !(*this == v); }
 
     
 
-    inline const Vec4 operator -() const                                { return Vec4(-x, -y, -z, -w); }
+    inline const VecN operator -() const                                { return VecN(-x, -y, -z, -w); }
 
     inline float operator [](int index) const                           { return *(&x + index); }
 
-    //inline const Vec4& operator = (const Vec4 &v)                       { x = v.x, y = v.y, z = v.z, w = v.w; return *this; }
-    inline const Vec4& operator +=(const Vec4 &v)                       { x += v.x, y += v.y, z += v.z, w += v.w; return *this; }
-    inline const Vec4& operator -=(const Vec4 &v)                       { x -= v.x, y -= v.y, z -= v.z, w -= v.w; return *this; }
-    inline const Vec4& operator *=(const Vec4 &v)                       { x *= v.x, y *= v.y, z *= v.z, w *= v.w; return *this; }
-    inline const Vec4& operator /=(const Vec4 &v)                       { x /= v.x, y /= v.y, z /= v.z, w /= v.w; return *this; }
-    inline const Vec4& operator *=(float s)                             { x *= s, y *= s, z *= s, w *= s; return *this; }
-    inline const Vec4& operator /=(float s)                             { x /= s, y /= s, z /= s, w /= w; return *this; }
+    //inline const VecN& operator = (const VecN &v)                       { x = v.x, y = v.y, z = v.z, w = v.w; return *this; }
+    inline const VecN& operator +=(const VecN &v)                       { simd::Store(&x, simd::Add(Load(), v.Load())); return *this; }
+    inline const VecN& operator -=(const VecN &v)                       { simd::Store(&x, simd::Sub(Load(), v.Load())); return *this; }
+    inline const VecN& operator *=(const VecN &v)                       { simd::Store(&x, simd::Mul(Load(), v.Load())); return *this; }
+    inline const VecN& operator /=(const VecN &v)                       { simd::Store(&x, simd::Div(Load(), v.Load())); return *this; }
+    inline const VecN& operator *=(float s)                             { simd::Store(&x, simd::Mul(Load(), simd::Splat(s))); return *this; }
+    inline const VecN& operator /=(float s)                             { simd::Store(&x, simd::Div(Load(), simd::Splat(s))); return *this; }
 
-    inline const Vec4 operator +(const Vec4 &v2) const                  { return Vec4(x + v2.x, y + v2.y, z + v2.z, w + v2.w); }
-    inline const Vec4 operator -(const Vec4 &v2) const                  { return Vec4(x - v2.x, y - v2.y, z - v2.z, w - v2.w); }
-    inline const Vec4 operator *(const Vec4 &v) const                   { return Vec4(x * v.x, y * v.y, z * v.z, w * v.w); }
-    inline const Vec4 operator /(const Vec4 &v) const                   { return Vec4(x / v.x, y / v.y, z / v.z, w / v.w); }
+    inline const VecN operator +(const VecN &v2) const                  { return VecN(simd::Add(Load(), v2.Load())); }
+    inline const VecN operator -(const VecN &v2) const                  { return VecN(simd::Sub(Load(), v2.Load())); }
+    inline const VecN operator *(const VecN &v) const                   { return VecN(simd::Mul(Load(), v.Load())); }
+    inline const VecN operator /(const VecN &v) const                   { return VecN(simd::Div(Load(), v.Load())); }
 
-    inline const Vec4 operator *(float s) const                         { return Vec4(x * s, y * s, z * s, w * s); }
-    inline const Vec4 operator /(float s) const                         { return Vec4(x / s, y / s, z / s, w / s); }
+    inline const VecN operator *(float s) const                         { return VecN(simd::Mul(Load(), simd::Splat(s))); }
+    inline const VecN operator /(float s) const                         { return VecN(simd::Div(Load(), simd::Splat(s))); }
 
-    inline float Dot(const Vec4 v) const                                { return x * v.x + y * v.y + z * v.z + w * v.w; }
-    inline static float Dot(const Vec4 &v1, const Vec4 &v2)             { return v1.Dot(v2); }
+    inline float Dot(const VecN v) const                                { return simd::GetX(simd::Dot4(Load(), v.Load())); }
+    inline static float Dot(const VecN &v1, const VecN &v2)             { return v1.Dot(v2); }
 
-    inline Vec4 Cross3(const Vec4 v) const                              { return Vec4(y*v.z - v.y*z, z*v.x - v.z*x, x*v.y - v.x*y, 0); }
-    inline static Vec4 Cross3(const Vec4 &v1, const Vec4 &v2)           { return v1.Cross3(v2); }
+    inline VecN Cross3(const VecN v) const                              { return VecN(simd::Cross3(Load(), v.Load())); }
+    inline static VecN Cross3(const VecN &v1, const VecN &v2)           { return v1.Cross3(v2); }
 
-    inline void Negate()                                                { x = -x, y = -y, z = -z, w = -w; }
-    inline const Vec4 Negated() const                                   { return Vec4(-x, -y, -z, -w); }
-    inline float Norm() const                                           { return x*x + y*y + z*z + w*w; }
-    inline float Length() const                                         { return sqrt(x*x + y*y + z*z + w*w); }
-    inline float Distance(const Vec4 v) const                           { Vec4 diff(x-v.x, y-v.y, z-v.z, w-v.w); return diff.Length(); }
-    inline void Normalize()                                             { float s = sqrt(x*x + y*y + z*z + w*w); x /= s, y /= s, z /= s, w /= w; }
-    inline const Vec4 Normalized() const                                { float s = sqrt(x*x + y*y + z*z + w*w); return Vec4(x / s, y / s, z / s, w / s); }
+    inline void Negate()                                                { simd::Store(&x, simd::Neg(Load())); }
+    inline const VecN Negated() const                                   { return VecN(simd::Neg(Load())); }
+    inline float Norm() const                                           { return Dot(*this); }
+    inline float Length() const                                         { return sqrt(Norm()); }
+    inline float Distance(const VecN v) const                           { return (*this - v).Length(); }
+    inline void Normalize()                                             { simd::v128 v = Load(); simd::Store(&x, DivSqrt(v, simd::Dot4(v, v))); }
+    inline const VecN Normalized() const                                { simd::v128 v = Load(); return VecN(DivSqrt(v, simd::Dot4(v, v))); }
 
 };
 
+typedef VecN<float, 4> Vec4;
+
 inline const Vec4 operator *(float s, const Vec4 &v)                    { return v * s; }
 inline const Vec4 operator /(float s, const Vec4 &v)                    { return v / s; }
 
+inline Vec4 MulAdd(const Vec4 &a, float s, const Vec4 &c)               { return Vec4(simd::MulAdd(a.Load(), simd::Splat(s), c.Load())); }
+inline Vec4 Hermite(const Vec4 &p0, const Vec4 &p1, const Vec4 &m0, const Vec4 &m1, float t) { return Vec4(simd::Hermite(p0.Load(), p1.Load(), m0.Load(), m1.Load(), t)); }
+
 }
 }
 
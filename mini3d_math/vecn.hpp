@@ -0,0 +1,188 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_MATH_VECN_H
+#define MINI3D_MATH_VECN_H
+
+#include "fastmath.hpp"
+
+#include <cmath>
+
+namespace mini3d {
+namespace math {
+
+
+////////// MULTIPLY ADD ///////////////////////////////////////////////////////
+
+// a * b + c. Uses std::fma (one rounding) when the target has a fast hardware
+// fused multiply add, for example when building with -mfma.
+
+template <typename T> inline T MulAdd(T a, T b, T c)                    { return a * b + c; }
+
+#if defined(FP_FAST_FMAF)
+inline float MulAdd(float a, float b, float c)                          { return std::fma(a, b, c); }
+#endif
+
+#if defined(FP_FAST_FMA)
+inline double MulAdd(double a, double b, double c)                      { return std::fma(a, b, c); }
+#endif
+
+
+////////// UNROLL ///////////////////////////////////////////////////////////
+
+// Calls f(0), f(1) ... f(N - 1) as straight line code. Component loops are not
+// reliably unrolled at -O2 and the loop keeps the components in memory.
+
+template <unsigned int N> struct Unroll
+{
+    template <typename F> static inline void Apply(F f)                 { Unroll<N - 1>::Apply(f); f(N - 1); }
+};
+
+template <> struct Unroll<0>
+{
+    template <typename F> static inline void Apply(F)                   {}
+};
+
+
+////////// VECTOR STORAGE /////////////////////////////////////////////////////
+
+// The common sizes have named components. All sizes are N contiguous values
+// without padding, so vectors can be read directly from file or vertex data.
+
+template <typename T, unsigned int N> struct VecStorage
+{
+    T e[N];
+
+    inline VecStorage()                                                 {}
+    template <typename... A> constexpr VecStorage(T a, T b, A... rest) : e{ a, b, T(rest)... } {}
+
+    inline T* Data()                                                    { return e; }
+    inline const T* Data() const                                        { return e; }
+};
+
+template <typename T> struct VecStorage<T, 2>
+{
+    T x, y;
+
+    inline VecStorage()                                                 {}
+    constexpr VecStorage(T x, T y) : x(x), y(y)                         {}
+
+    inline T* Data()                                                    { return &x; }
+    inline const T* Data() const                                        { return &x; }
+};
+
+template <typename T> struct VecStorage<T, 3>
+{
+    T x, y, z;
+
+    inline VecStorage()                                                 {}
+    constexpr VecStorage(T x, T y, T z) : x(x), y(y), z(z)              {}
+
+    inline T* Data()                                                    { return &x; }
+    inline const T* Data() const                                        { return &x; }
+};
+
+template <typename T> struct VecStorage<T, 4>
+{
+    T x, y, z, w;
+
+    inline VecStorage()                                                 {}
+    constexpr VecStorage(T x, T y, T z, T w) : x(x), y(y), z(z), w(w)   {}
+
+    inline T* Data()                                                    { return &x; }
+    inline const T* Data() const                                        { return &x; }
+};
+
+
+////////// VECTOR N ///////////////////////////////////////////////////////////
+
+// Fixed size vector. N is known at compile time so the component loops unroll
+// into straight line code. Vec3 is VecN<float, 3>, Vec4 is a SIMD
+// specialization of VecN<float, 4>.
+
+template <typename T, unsigned int N> class VecN : public VecStorage<T, N>
+{
+public:
+
+    inline VecN()                                                       {}
+    inline VecN(T s)                                                    { Unroll<N>::Apply([&](unsigned int i) { this->Data()[i] = s; }); }
+    inline VecN(const T v[N])                                           { Unroll<N>::Apply([&](unsigned int i) { this->Data()[i] = v[i]; }); }
+
+    // One value per component, usable in constant expressions
+    template <typename... A> constexpr VecN(T a, T b, A... rest) : VecStorage<T, N>(a, b, T(rest)...) { static_assert(sizeof...(A) + 2 == N, "VecN needs one value per component"); }
+
+	inline operator T*()                                                { return this->Data(); }
+	inline operator const T*() const                                    { return this->Data(); }
+
+    inline bool operator == (const VecN &v) const                       { bool r = true; Unroll<N>::Apply([&](unsigned int i) { r = r && this->Data()[i] == v.Data()[i]; }); return r; }
+	inline bool operator != (const VecN &v) const                       { return !(*this == v); }
+
+    inline const VecN operator -() const                                { return Negated(); }
+
+    inline T operator [](int index) const                               { return this->Data()[index]; }
+    inline T& operator [](int index)                                    { return this->Data()[index]; }
+
+    inline const VecN& operator +=(const VecN &v)                       { Unroll<N>::Apply([&](unsigned int i) { this->Data()[i] += v.Data()[i]; }); return *this; }
+    inline const VecN& operator -=(const VecN &v)                       { Unroll<N>::Apply([&](unsigned int i) { this->Data()[i] -= v.Data()[i]; }); return *this; }
+    inline const VecN& operator *=(const VecN &v)                       { Unroll<N>::Apply([&](unsigned int i) { this->Data()[i] *= v.Data()[i]; }); return *this; }
+    inline const VecN& operator /=(const VecN &v)                       { Unroll<N>::Apply([&](unsigned int i) { this->Data()[i] /= v.Data()[i]; }); return *this; }
+    inline const VecN& operator *=(T s)                                 { Unroll<N>::Apply([&](unsigned int i) { this->Data()[i] *= s; }); return *this; }
+    inline const VecN& operator /=(T s)                                 { Unroll<N>::Apply([&](unsigned int i) { this->Data()[i] /= s; }); return *this; }
+
+    inline const VecN operator +(const VecN &v) const                   { VecN r(*this); return r += v; }
+    inline const VecN operator -(const VecN &v) const                   { VecN r(*this); return r -= v; }
+    inline const VecN operator *(const VecN &v) const                   { VecN r(*this); return r *= v; }
+    inline const VecN operator /(const VecN &v) const                   { VecN r(*this); return r /= v; }
+
+    inline const VecN operator *(T s) const                             { VecN r(*this); return r *= s; }
+    inline const VecN operator /(T s) const                             { VecN r(*this); return r /= s; }
+
+    // Summed left to right, x * x + y * y + ...
+    inline T Dot(const VecN &v) const                                   { T d = this->Data()[0] * v.Data()[0]; Unroll<N - 1>::Apply([&](unsigned int i) { d += this->Data()[i + 1] * v.Data()[i + 1]; }); return d; }
+    inline static T Dot(const VecN &v1, const VecN &v2)                 { return v1.Dot(v2); }
+
+    inline VecN Cross(const VecN &v) const
+    {
+        static_assert(N == 3, "Cross is only defined for 3 component vectors");
+        const T* a = this->Data();
+        const T* b = v.Data();
+        return VecN(a[1]*b[2] - b[1]*a[2], a[2]*b[0] - b[2]*a[0], a[0]*b[1] - b[0]*a[1]);
+    }
+    inline static VecN Cross(const VecN &v1, const VecN &v2)            { return v1.Cross(v2); }
+
+    inline void Negate()                                                { Unroll<N>::Apply([&](unsigned int i) { this->Data()[i] = -this->Data()[i]; }); }
+    inline const VecN Negated() const                                   { VecN r(*this); r.Negate(); return r; }
+    inline T Norm() const                                               { return Dot(*this); }
+    inline T Length() const                                             { return sqrt(Norm()); }
+    inline T Distance(const VecN &v) const                              { return (*this - v).Length(); }
+    inline void Normalize()                                             { *this = Normalized(); }
+    inline const VecN Normalized() const                                { VecN r; T s = DivSqrt((T)1, Norm()); Unroll<N>::Apply([&](unsigned int i) { r.Data()[i] = this->Data()[i] * s; }); return r; }
+
+    friend inline const VecN operator *(T s, const VecN &v)             { return v * s; }
+    friend inline const VecN operator /(T s, const VecN &v)             { return v / s; }
+};
+
+// a * s + c per component
+template <typename T, unsigned int N> inline VecN<T, N> MulAdd(const VecN<T, N> &a, T s, const VecN<T, N> &c)
+{
+    VecN<T, N> r;
+    Unroll<N>::Apply([&](unsigned int i) { r.Data()[i] = MulAdd(a.Data()[i], s, c.Data()[i]); });
+    return r;
+}
+
+// Cubic Hermite spline through p0 and p1 with tangents m0 and m1, t in [0, 1].
+// Evaluated as one multiply add chain per component without temporaries. t is
+// a float for all T so this overload is preferred over the generic one in
+// mini3d::animation.
+template <typename T, unsigned int N> inline VecN<T, N> Hermite(const VecN<T, N> &p0, const VecN<T, N> &p1, const VecN<T, N> &m0, const VecN<T, N> &m1, float t)
+{
+    T t2 = T(t) * t, t3 = t2 * t;
+    return MulAdd(m1, t3 - t2, MulAdd(m0, t3 - 2 * t2 + t, MulAdd(p1, -2 * t3 + 3 * t2, p0 * (2 * t3 - 3 * t2 + 1))));
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,55 @@
+
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#ifndef MINI3D_SYSTEM_ARRAYS_H
+#define MINI3D_SYSTEM_ARRAYS_H
+
+#include <cstring>
+
+namespace mini3d {
+namespace system {
+
+
+////////// ARRAYS /////////////////////////////////////////////////////////////
+
+// Growing the plain new[] arrays of trivially copyable items the animation and import
+// code keep. An empty array may be null, nothing is copied from it then.
+
+// Replaces pArray with an array of capacity items that starts with its first count items
+template <typename T> void ResizeArray(T* &pArray, unsigned int count, unsigned int capacity)
+{
+    T* pNew = new T[capacity];
+    if (count)
+        memcpy(pNew, pArray, count * sizeof(T));
+    delete[] pArray;
+    pArray = pNew;
+}
+
+// Inserts count items at index in an array of size items and adds count to size
+template <typename T> void InsertArray(T* &pArray, unsigned int &size, unsigned int index, const T* pItems, unsigned int count)
+{
+    unsigned int oldSize = size;
+    T* pNew = new T[oldSize + count];
+    if (index > 0)
+        memcpy(pNew, pArray, index * sizeof(T));
+    memcpy(pNew + index, pItems, count * sizeof(T));
+    if (index < oldSize)
+        memcpy(pNew + index + count, pArray + index, (oldSize - index) * sizeof(T));
+    delete[] pArray;
+    pArray = pNew;
+    size = oldSize + count;
+}
+
+// Adds count items at the end of an array of size items
+template <typename T> void AppendArray(T* &pArray, unsigned int &size, const T* pItems, unsigned int count)
+{
+    InsertArray(pArray, size, size, pItems, count);
+}
+
+
+}
+}
+
+#endif
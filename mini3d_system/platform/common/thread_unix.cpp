@@ -23,12 +23,30 @@ struct Mutex : IMutex
     void Unlock()   { pthread_mutex_unlock(&m_mutex); }
 
 private:
+    friend struct Condition;
     pthread_mutex_t m_mutex;
 };
 
 IMutex* IMutex::New() { return new Mutex(); }
 
 
+///////// CONDITION ////////////////////////////////////////////////////////////
+
+struct Condition : ICondition
+{
+    Condition()                     { pthread_cond_init(&m_cond, 0); }
+    ~Condition()                    { pthread_cond_destroy(&m_cond); }
+    void Wait(IMutex* pMutex)       { pthread_cond_wait(&m_cond, &((Mutex*)pMutex)->m_mutex); }
+    void Signal()                   { pthread_cond_signal(&m_cond); }
+    void Broadcast()                { pthread_cond_broadcast(&m_cond); }
+
+private:
+    pthread_cond_t m_cond;
+};
+
+ICondition* ICondition::New() { return new Condition(); }
+
+
 ///////// THREAD ///////////////////////////////////////////////////////////////
 
 void* StartThreadProc(void* runnable) { ((IRunnable*)runnable)->Run(); return 0; }
@@ -37,8 +55,8 @@ struct Thread : IThread
 {
     Thread(IRunnable* runnable)     { m_runnable = runnable; isRunning = false; }
     ~Thread()                       { }
-    void Run()                      { if (!isRunning) pthread_create(&m_thread, 0, &StartThreadProc, m_runnable); }
-    void Join()                     { pthread_join(m_thread, 0); isRunning = false; }
+    bool Run()                      { if (!isRunning) isRunning = (pthread_create(&m_thread, 0, &StartThreadProc, m_runnable) == 0); return isRunning; }
+    void Join()                     { if (isRunning) pthread_join(m_thread, 0); isRunning = false; }
 
 private:
     IRunnable* m_runnable;
@@ -22,12 +22,30 @@ struct Mutex : IMutex
     void Unlock()   { LeaveCriticalSection(&m_cs); }
 
 private:
+    friend struct Condition;
     CRITICAL_SECTION m_cs;
 };
 
 IMutex* IMutex::New() { return new Mutex(); }
 
 
+///////// CONDITION ////////////////////////////////////////////////////////////
+
+struct Condition : ICondition
+{
+    Condition()                     { InitializeConditionVariable(&m_cv); }
+    ~Condition()                    { }
+    void Wait(IMutex* pMutex)       { SleepConditionVariableCS(&m_cv, &((Mutex*)pMutex)->m_cs, INFINITE); }
+    void Signal()                   { WakeConditionVariable(&m_cv); }
+    void Broadcast()                { WakeAllConditionVariable(&m_cv); }
+
+private:
+    CONDITION_VARIABLE m_cv;
+};
+
+ICondition* ICondition::New() { return new Condition(); }
+
+
 ///////// THREAD ///////////////////////////////////////////////////////////////
 
 DWORD WINAPI StartThreadProc(void* runnable) { ((IRunnable*)runnable)->Run(); return 0; }
@@ -36,8 +54,8 @@ struct Thread : IThread
 {
     Thread(IRunnable* runnable)     { m_runnable = runnable; m_thread = 0; }
     ~Thread()                       { }
-    void Run()                      { if (m_thread == 0) CreateThread(0, 0, &StartThreadProc, m_runnable, 0, 0); }
-    void Join()                     { WaitForSingleObject(m_thread, INFINITE); CloseHandle(m_thread); m_thread = 0; }
+    bool Run()                      { if (m_thread == 0) m_thread = CreateThread(0, 0, &StartThreadProc, m_runnable, 0, 0); return m_thread != 0; }
+    void Join()                     { if (m_thread == 0) return; WaitForSingleObject(m_thread, INFINITE); CloseHandle(m_thread); m_thread = 0; }
 
 private:
     IRunnable* m_runnable;
@@ -28,17 +28,33 @@ struct IMutex
 struct Lock { Lock(IMutex* m) : x(m) { x->Lock(); } ~Lock() { x->Unlock(); } private: IMutex* x; };
 
 
+///////// CONDITION /////////////////////////////////////////////////////////
+
+// Lets threads wait for a state guarded by a mutex. Wait must be called with the
+// mutex locked, it unlocks it while waiting and locks it again before returning.
+// Wait can return without a Signal, so check the state in a loop around it.
+struct ICondition
+{
+    static ICondition* New();
+    virtual ~ICondition() {};
+    virtual void Wait(IMutex* pMutex) = 0;
+    virtual void Signal() = 0;          // Wakes one waiting thread
+    virtual void Broadcast() = 0;       // Wakes all waiting threads
+};
+
+
 ///////// THREAD ////////////////////////////////////////////////////////////
 
 // Implement this interface to create an object with a run function that can be run as a separate thread
-struct IRunnable { virtual void Run(); };
+struct IRunnable { virtual ~IRunnable() {}; virtual void Run() = 0; };
 
 struct IThread
 { 
     static IThread* New(IRunnable* runable);
 
     virtual ~IThread() {};
-    virtual void Run() = 0;
+    // Returns false if the thread could not be started, true if it runs
+    virtual bool Run() = 0;
     virtual void Join() = 0;
     
     static void SleepCurrentThread(unsigned int ms);
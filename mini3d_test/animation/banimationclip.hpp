@@ -0,0 +1,439 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_BENCHMARK_ANIMATION_ANIMATIONCLIP
+#ifdef MINI3D_BENCHMARK_ANIMATION_ANIMATIONCLIP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstring>
+#include <cmath>
+
+#include "../benchmark.hpp"
+#include "../../mini3d_math/vec3.hpp"
+#include "../../mini3d_math/quat.hpp"
+#include "../../mini3d_math/transform.hpp"
+#include "../../mini3d_math/bonepalette.hpp"
+#include "../../mini3d_animation/track.hpp"
+#include "../../mini3d_animation/animationclip.hpp"
+#include "../../mini3d_animation/compressedclip.hpp"
+#include "../../mini3d_animation/clipplayer.hpp"
+
+// Animation and AnimationUtils are not header only, the benchmark runner builds them
+// in. Like everything using mini3d_utils it needs an include path where ../mini3d/ is
+// the mini3d directory.
+#include "../../mini3d_animation/animation.cpp"
+#include "../../mini3d_utils/animationutils.cpp"
+
+using namespace mini3d::math;
+using namespace mini3d::animation;
+using namespace mini3d::utils;
+using namespace std;
+
+// Synthetic rigs: joints with a random parent before them, and pos and rot keys
+// at 30 fps on every joint, the channels AnimationUtils makes tracks for. They are
+// built from a fixed seed, so every run measures the same data.
+//
+// Reference is Animation::Update, one Animation per instance with a Track per
+// channel, writing an array of Transforms. It is compared to a ClipPlayer of one
+// shared AnimationClip writing the same Transforms. Times are ns per joint.
+//
+// Access patterns, each frame sets the time of every instance:
+//   monotonic    instances spread over the clip, playing forward at 60 fps
+//   loop point   every frame jumps across the end of the clip and back
+//   random seek  every instance at a random time every frame
+//
+// Matrices are built by AnimationUtils::BoneTransformsToMatrices on an armature of
+// the rig. Cache misses are reported where perf counters are available. Thread
+// scaling splits the instances over worker threads that wait between frames, like
+// the AnimationManager workers. Each thread evaluates its range and builds its
+// matrices.
+
+namespace {
+
+const unsigned int BENCHMARK_RIG_FRAMES = 16;
+const float BENCHMARK_RIG_SAMPLE_RATE = 30;
+const float BENCHMARK_RIG_TIME_STEP = 1.0f / 60;
+const unsigned int BENCHMARK_RIG_MAX_THREADS = 16;
+const unsigned int BENCHMARK_RIG_TRANSFORM_FLOATS = sizeof(Transform) / sizeof(float);
+
+enum AccessPattern { PATTERN_MONOTONIC, PATTERN_LOOP_POINT, PATTERN_RANDOM_SEEK, PATTERN_COUNT };
+const char* ACCESS_PATTERN_NAMES[PATTERN_COUNT] = { "monotonic", "loop point", "random seek" };
+
+// Linear congruential generator, floats in [0, 1)
+struct BenchmarkRandom
+{
+    unsigned int state;
+    float Next() { state = state * 1664525u + 1013904223u; return (state >> 8) * (1.0f / 16777216); }
+};
+
+struct SyntheticRig
+{
+    unsigned int joints;
+    unsigned int keys;
+    float length;
+    vector<int> parents;
+    vector<vector<Keyframe<Vec3>>> pos;
+    vector<vector<Keyframe<Quat>>> rot;
+    Armature armature;
+
+    SyntheticRig(unsigned int joints, unsigned int keys) : joints(joints), keys(keys), length((keys - 1) / BENCHMARK_RIG_SAMPLE_RATE), parents(joints), pos(joints), rot(joints)
+    {
+        BenchmarkRandom random = { 0x6d696e69 };
+
+        // Joints without a roll, their heads along y
+        armature.joints.array = new Joint[joints];
+        armature.joints.count = joints;
+
+        for (unsigned int j = 0; j < joints; ++j)
+        {
+            parents[j] = (j == 0) ? -1 : (int)(random.Next() * j);
+
+            Joint &joint = armature.joints.array[j];
+            const float offset[4] = { 0, 0.2f * j, 0, 0 }, roll[4] = { 0, 0, 0, 1 }, rollBasis[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+            joint.index = j;
+            joint.parent = (j == 0) ? 0 : armature.joints.array + parents[j];
+            memcpy(joint.offset, offset, sizeof(offset));
+            memcpy(joint.roll, roll, sizeof(roll));
+            memcpy(joint.rollBasis, rollBasis, sizeof(rollBasis));
+
+            float frequency = 0.5f + 2.5f * random.Next(), phase = 6.28f * random.Next();
+            Vec3 axis = Vec3(random.Next() - 0.5f, random.Next() - 0.5f, random.Next() - 0.5f + 1.0f).Normalized();
+
+            pos[j].resize(keys), rot[j].resize(keys);
+            for (unsigned int k = 0; k < keys; ++k)
+            {
+                float time = k / BENCHMARK_RIG_SAMPLE_RATE;
+                float s = sinf(frequency * time + phase);
+                pos[j][k].time = rot[j][k].time = time;
+                pos[j][k].value = Vec3(0.05f * s, 0.2f, 0.05f * cosf(frequency * time));
+                rot[j][k].value = Quat::FromAxisAngle(axis.x, axis.y, axis.z, 0.5f * s);
+            }
+        }
+    }
+
+    // Channels of joint j write the Transform at pose offset j * BENCHMARK_RIG_TRANSFORM_FLOATS
+    template <typename Clip> void AddChannels(Clip &clip)
+    {
+        for (unsigned int j = 0; j < joints; ++j)
+        {
+            clip.AddChannel((const float*)&pos[j][0], keys, 3, j * BENCHMARK_RIG_TRANSFORM_FLOATS);
+            clip.AddChannel((const float*)&rot[j][0], keys, 4, j * BENCHMARK_RIG_TRANSFORM_FLOATS + 3, AnimationClip::CHANNEL_NORMALIZE);
+        }
+    }
+
+    // Poses of instances, the scale is not animated and stays 1
+    vector<float> Poses(unsigned int instances) const
+    {
+        vector<float> poses(instances * joints * BENCHMARK_RIG_TRANSFORM_FLOATS);
+        for (unsigned int i = 0; i < instances * joints; ++i)
+            poses[i * BENCHMARK_RIG_TRANSFORM_FLOATS + 7] = 1;
+        return poses;
+    }
+
+    // BENCHMARK_RIG_FRAMES frames of instances times
+    vector<float> Times(AccessPattern pattern, unsigned int instances) const
+    {
+        vector<float> times(BENCHMARK_RIG_FRAMES * instances);
+        BenchmarkRandom random = { 0x33640000 + (unsigned int)pattern };
+
+        for (unsigned int f = 0; f < BENCHMARK_RIG_FRAMES; ++f)
+        {
+            for (unsigned int i = 0; i < instances; ++i)
+            {
+                float start = 0.5f * length * i / instances;
+                float time = (pattern == PATTERN_MONOTONIC) ? start + f * BENCHMARK_RIG_TIME_STEP :
+                             (pattern == PATTERN_LOOP_POINT) ? ((f % 2) ? 0.5f * BENCHMARK_RIG_TIME_STEP : length - 0.5f * BENCHMARK_RIG_TIME_STEP) :
+                             random.Next() * length;
+                times[f * instances + i] = fmodf(time, length);
+            }
+        }
+        return times;
+    }
+};
+
+// The Animation path: one Animation per instance with one Track per channel
+struct AnimationInstances
+{
+    vector<Transform> transforms;
+    vector<Track<Vec3>> pos;
+    vector<Track<Quat, true>> rot;
+    vector<ITrack*> tracks;
+    vector<Animation> animations;
+
+    AnimationInstances(SyntheticRig &rig, unsigned int instances) : transforms(instances * rig.joints, Transform::Identity())
+    {
+        pos.reserve(transforms.size()), rot.reserve(transforms.size());
+        for (unsigned int i = 0; i < transforms.size(); ++i)
+        {
+            unsigned int j = i % rig.joints;
+            pos.push_back(Track<Vec3>(&transforms[i].pos, &rig.pos[j][0], rig.keys));
+            rot.push_back(Track<Quat, true>(&transforms[i].rot, &rig.rot[j][0], rig.keys));
+            tracks.push_back(&pos.back()), tracks.push_back(&rot.back());
+        }
+
+        animations.reserve(instances);
+        for (unsigned int i = 0; i < instances; ++i)
+        {
+            animations.push_back(Animation(&tracks[i * rig.joints * 2], rig.joints * 2, rig.length));
+            animations.back().Play();
+        }
+    }
+
+    void Update(unsigned int instance, float time)
+    {
+        animations[instance].SetPosition(time);
+        animations[instance].Update(0);
+    }
+};
+
+void reportCacheMisses(long long reference, long long misses, unsigned int count)
+{
+    if (reference >= 0 && misses >= 0)
+        printf("  %-32s reference: %8.3f     mini3d: %8.3f     cache misses per joint\n", "", reference / (double)count, misses / (double)count);
+}
+
+void reportCacheMisses(long long misses, unsigned int count)
+{
+    if (misses >= 0)
+        printf("  %-32s %8.3f cache misses per joint\n", "", misses / (double)count);
+}
+
+// Threads that wait for the next frame in between, so a frame does not pay for
+// starting them. Run calls job(thread, threads) on every thread, the calling one
+// as thread 0, and returns when all are done.
+class BenchmarkWorkers
+{
+public:
+
+    typedef function<void(unsigned int, unsigned int)> Job;
+
+    BenchmarkWorkers(unsigned int threads) : m_threads(threads), m_pJob(0), m_frame(0), m_pending(0), m_exit(false)
+    {
+        for (unsigned int i = 1; i < threads; ++i)
+            m_workers.push_back(thread(&BenchmarkWorkers::Work, this, i));
+    }
+
+    ~BenchmarkWorkers()
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_exit = true;
+        }
+        m_work.notify_all();
+        for (unsigned int i = 0; i < m_workers.size(); ++i)
+            m_workers[i].join();
+    }
+
+    void Run(const Job &job)
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_pJob = &job;
+            m_pending = m_threads - 1;
+            ++m_frame;
+        }
+        m_work.notify_all();
+
+        job(0, m_threads);
+
+        unique_lock<mutex> lock(m_mutex);
+        while (m_pending > 0)
+            m_done.wait(lock);
+    }
+
+private:
+
+    void Work(unsigned int index)
+    {
+        for (unsigned int frame = 0;;)
+        {
+            const Job* pJob;
+            {
+                unique_lock<mutex> lock(m_mutex);
+                while (m_frame == frame && !m_exit)
+                    m_work.wait(lock);
+
+                if (m_exit)
+                    return;
+
+                frame = m_frame;
+                pJob = m_pJob;
+            }
+
+            (*pJob)(index, m_threads);
+
+            lock_guard<mutex> lock(m_mutex);
+            if (--m_pending == 0)
+                m_done.notify_one();
+        }
+    }
+
+    unsigned int m_threads;
+    vector<thread> m_workers;
+    mutex m_mutex;
+    condition_variable m_work;
+    condition_variable m_done;
+    const Job* m_pJob;
+    unsigned int m_frame;
+    unsigned int m_pending;
+    bool m_exit;
+};
+
+void benchmarkRig(unsigned int joints, unsigned int keys, unsigned int instances, bool compressed)
+{
+    SyntheticRig rig(joints, keys);
+    AnimationInstances animations(rig, instances);
+
+    AnimationClip clip(rig.length);
+    rig.AddChannels(clip);
+    ClipPlayer<ClipEvaluator> player(&clip, true, instances);
+
+    // Key reduction is slow on long smooth channels, so only short rigs are compressed
+    CompressedClip compressedClip(rig.length);
+    if (compressed)
+        rig.AddChannels(compressedClip);
+    ClipPlayer<CompressedClipEvaluator> compressedPlayer(&compressedClip, true, instances);
+
+    for (unsigned int i = 0; i < instances; ++i)
+        player.Add(), compressedPlayer.Add();
+
+    unsigned int count = instances * joints;
+    unsigned int poseSize = joints * BENCHMARK_RIG_TRANSFORM_FLOATS;
+    vector<float> poses = rig.Poses(instances), model(poses.size()), matrices(count * BonePalette::LAYOUT_3X4);
+
+    if (benchmarkCacheMisses([]() {}) < 0)
+        printf("  no perf counters, cache misses are not reported\n");
+
+    for (unsigned int p = 0; p < PATTERN_COUNT; ++p)
+    {
+        vector<float> times = rig.Times((AccessPattern)p, instances);
+        unsigned int frame = 0;
+
+        auto animationFrame = [&]() {
+            const float* t = &times[(frame++ % BENCHMARK_RIG_FRAMES) * instances];
+            for (unsigned int i = 0; i < instances; ++i)
+                animations.Update(i, t[i]);
+            benchmarkSink(animations.transforms.back());
+        };
+
+        auto clipFrame = [&]() {
+            const float* t = &times[(frame++ % BENCHMARK_RIG_FRAMES) * instances];
+            for (unsigned int i = 0; i < instances; ++i)
+                player.GetState(i).time = t[i];
+            player.EvaluateAll(&poses[0], poseSize);
+            benchmarkSink(poses.back());
+        };
+
+        auto compressedFrame = [&]() {
+            const float* t = &times[(frame++ % BENCHMARK_RIG_FRAMES) * instances];
+            for (unsigned int i = 0; i < instances; ++i)
+                compressedPlayer.GetState(i).time = t[i];
+            compressedPlayer.EvaluateAll(&poses[0], poseSize);
+            benchmarkSink(poses.back());
+        };
+
+        frame = 0;
+        double nsRef = benchmarkNanoseconds(animationFrame);
+        long long missesRef = benchmarkCacheMisses(animationFrame);
+        frame = 0;
+        double ns = benchmarkNanoseconds(clipFrame);
+        long long misses = benchmarkCacheMisses(clipFrame);
+
+        char name[64];
+        snprintf(name, sizeof(name), "ClipPlayer %s", ACCESS_PATTERN_NAMES[p]);
+        benchmarkReport(name, nsRef, ns, count);
+        reportCacheMisses(missesRef, misses, count);
+
+        if (compressed)
+        {
+            frame = 0;
+            double nsCompressed = benchmarkNanoseconds(compressedFrame);
+            snprintf(name, sizeof(name), "Compressed %s", ACCESS_PATTERN_NAMES[p]);
+            printf("  %-32s %8.3f ns per joint, %u bytes for %u bytes of keyframes\n", name, nsCompressed / count, compressedClip.GetSizeInBytes(), (unsigned int)(joints * keys * (4 + 5) * sizeof(float)));
+        }
+    }
+
+    // The local pose is copied first since the matrices are built from model space in place
+    auto palette = [&]() {
+        memcpy(&model[0], &poses[0], poses.size() * sizeof(float));
+        for (unsigned int i = 0; i < instances; ++i)
+            AnimationUtils::BoneTransformsToMatrices(&matrices[i * joints * BonePalette::LAYOUT_3X4], (Transform*)&model[i * poseSize], &rig.armature, BonePalette::LAYOUT_3X4);
+        benchmarkSink(matrices.back());
+    };
+
+    double nsPalette = benchmarkNanoseconds(palette);
+    printf("  %-32s %8.3f ns per joint including the pose copy\n", "BoneTransformsToMatrices", nsPalette / count);
+    reportCacheMisses(benchmarkCacheMisses(palette), count);
+}
+
+// Evaluation and palette building of a monotonic frame split over 1, 2, 4 ... threads
+void benchmarkRigThreads(unsigned int joints, unsigned int keys, unsigned int instances)
+{
+    SyntheticRig rig(joints, keys);
+    AnimationClip clip(rig.length);
+    rig.AddChannels(clip);
+    ClipPlayer<ClipEvaluator> player(&clip, true, instances);
+    for (unsigned int i = 0; i < instances; ++i)
+        player.Add();
+
+    unsigned int count = instances * joints;
+    unsigned int poseSize = joints * BENCHMARK_RIG_TRANSFORM_FLOATS;
+    vector<float> poses = rig.Poses(instances), matrices(count * BonePalette::LAYOUT_3X4);
+    vector<float> times = rig.Times(PATTERN_MONOTONIC, instances);
+
+    unsigned int frame = 0;
+    const float* t = 0;
+    BenchmarkWorkers::Job frameRange = [&](unsigned int index, unsigned int threadCount) {
+        for (unsigned int i = instances * index / threadCount; i < instances * (index + 1) / threadCount; ++i)
+        {
+            player.GetState(i).time = t[i];
+            player.Evaluate(i, &poses[i * poseSize]);
+            AnimationUtils::BoneTransformsToMatrices(&matrices[i * joints * BonePalette::LAYOUT_3X4], (Transform*)&poses[i * poseSize], &rig.armature, BonePalette::LAYOUT_3X4);
+        }
+    };
+
+    unsigned int maxThreads = thread::hardware_concurrency();
+    maxThreads = (maxThreads == 0) ? 1 : (maxThreads > BENCHMARK_RIG_MAX_THREADS) ? BENCHMARK_RIG_MAX_THREADS : maxThreads;
+
+    double nsSingle = 0;
+    for (unsigned int threads = 1;; threads = (threads * 2 < maxThreads) ? threads * 2 : maxThreads)
+    {
+        BenchmarkWorkers workers(threads);
+        frame = 0;
+        double ns = benchmarkNanoseconds([&]() {
+            t = &times[(frame++ % BENCHMARK_RIG_FRAMES) * instances];
+            workers.Run(frameRange);
+            benchmarkSink(matrices.back());
+        });
+
+        nsSingle = (threads == 1) ? ns : nsSingle;
+        char name[64];
+        snprintf(name, sizeof(name), "%u thread%s", threads, (threads == 1) ? "" : "s");
+        printf("  %-32s %8.3f ns per joint  scaling: %5.2fx\n", name, ns / count, nsSingle / ns);
+
+        if (threads == maxThreads)
+            break;
+    }
+}
+
+}
+
+void benchmarkRig20Joints30Keys1Instance()          { benchmarkRig(20, 30, 1, true); }
+void benchmarkRig20Joints30Keys10000Instances()     { benchmarkRig(20, 30, 10000, true); }
+void benchmarkRig60Joints300Keys1000Instances()     { benchmarkRig(60, 300, 1000, true); }
+void benchmarkRig200Joints5000Keys10Instances()     { benchmarkRig(200, 5000, 10, false); }
+void benchmarkRigThreads60Joints300Keys1000Instances() { benchmarkRigThreads(60, 300, 1000); }
+
+vector<pair<const char*, void(*)()>> animation_banimationclip = {
+    {"20 joints, 30 keys, 1 instance", &benchmarkRig20Joints30Keys1Instance},
+    {"20 joints, 30 keys, 10000 instances", &benchmarkRig20Joints30Keys10000Instances},
+    {"60 joints, 300 keys, 1000 instances", &benchmarkRig60Joints300Keys1000Instances},
+    {"200 joints, 5000 keys, 10 instances", &benchmarkRig200Joints5000Keys10Instances},
+    {"Threads, 60 joints, 300 keys, 1000 instances", &benchmarkRigThreads60Joints300Keys1000Instances} };
+
+#endif
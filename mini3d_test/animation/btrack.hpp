@@ -0,0 +1,84 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_BENCHMARK_ANIMATION_TRACK
+#ifdef MINI3D_BENCHMARK_ANIMATION_TRACK
+
+#include <vector>
+
+#include "../benchmark.hpp"
+#include "../../mini3d_math/vec3.hpp"
+#include "../../mini3d_math/quat.hpp"
+#include "../../mini3d_animation/track.hpp"
+
+using namespace mini3d::math;
+using namespace mini3d::animation;
+using namespace std;
+
+// Reference is the Catmull-Rom evaluation Track::Update used before the fused
+// Hermite overloads: one temporary per operator and a branch per tangent.
+// Build with -mfma to let the Hermite overloads use fused multiply adds.
+
+namespace {
+
+const unsigned int BENCHMARK_TRACK_KEYFRAMES = 64;
+const unsigned int BENCHMARK_TRACK_STEPS = 4096;
+
+template <typename T> struct RefCatmullRom
+{
+    T p[2], m[2];
+    bool hasM0, hasM1;
+
+    T Evaluate(float t) const
+    {
+        float t2 = t*t;
+        float t3 = t2*t;
+        T r = (p[0] * (2*t3 - 3*t2 + 1)) + (p[1] * (-2*t3 + 3*t2));
+        if (hasM0) r = r + m[0] * (t3 - 2*t2 + t);
+        if (hasM1) r = r + m[1] * (t3 - t2);
+        return r;
+    }
+};
+
+template <typename T> void benchmarkTrack(const char* name, const vector<Keyframe<T>> &keyframes)
+{
+    vector<Keyframe<T>> kf(keyframes);
+    float length = kf.back().time;
+
+    T value;
+    Track<T> track(&value, &kf[0], (unsigned int)kf.size());
+
+    // Interval with both tangents, the common case for long tracks
+    RefCatmullRom<T> ref = { { kf[1].value, kf[2].value }, { kf[2].value - kf[0].value, kf[3].value - kf[1].value }, true, true };
+    vector<T> out(BENCHMARK_TRACK_STEPS);
+
+    double nsRef = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < BENCHMARK_TRACK_STEPS; ++i) out[i] = ref.Evaluate(i / (float)BENCHMARK_TRACK_STEPS); benchmarkSink(out.back()); });
+    double nsEval = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < BENCHMARK_TRACK_STEPS; ++i) out[i] = Hermite(ref.p[0], ref.p[1], ref.m[0], ref.m[1], i / (float)BENCHMARK_TRACK_STEPS); benchmarkSink(out.back()); });
+    benchmarkReport(name, nsRef, nsEval, BENCHMARK_TRACK_STEPS);
+
+    double nsUpdate = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < BENCHMARK_TRACK_STEPS; ++i) track.Update(length * i / BENCHMARK_TRACK_STEPS); benchmarkSink(value); });
+    printf("  %-32s %8.3f ns per update including interval seek\n", "Track::Update", nsUpdate / BENCHMARK_TRACK_STEPS);
+}
+
+}
+
+void benchmarkTrackVec3() {
+    vector<Keyframe<Vec3>> kf(BENCHMARK_TRACK_KEYFRAMES);
+    for (unsigned int i = 0; i < kf.size(); ++i)
+        kf[i].time = 0.1f * i, kf[i].value = Vec3(sin(0.3f * i), cos(0.2f * i), 0.05f * i);
+    benchmarkTrack("Catmull-Rom Vec3", kf);
+}
+
+void benchmarkTrackQuat() {
+    vector<Keyframe<Quat>> kf(BENCHMARK_TRACK_KEYFRAMES);
+    for (unsigned int i = 0; i < kf.size(); ++i)
+        kf[i].time = 0.1f * i, kf[i].value = Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.1f * i);
+    benchmarkTrack("Catmull-Rom Quat", kf);
+}
+
+vector<pair<const char*, void(*)()>> animation_btrack = {
+    {"Vec3", &benchmarkTrackVec3},
+    {"Quat", &benchmarkTrackQuat} };
+
+#endif
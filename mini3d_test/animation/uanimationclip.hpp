@@ -0,0 +1,143 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_ANIMATION_ANIMATIONCLIP
+#ifdef MINI3D_TEST_ANIMATION_ANIMATIONCLIP
+
+#include <vector>
+#include <cmath>
+
+#include "../../mini3d_math/transform.hpp"
+#include "../../mini3d_animation/track.hpp"
+#include "../../mini3d_animation/animationclip.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::math;
+using namespace mini3d::animation;
+using namespace std;
+
+// The evaluator must give the same values as one Track per channel
+
+const unsigned int TEST_ANIMATIONCLIP_KEYFRAMES = 9;
+
+void testAnimationClipKeyframes(vector<Keyframe<Vec3>> &pos, vector<Keyframe<Quat>> &rot) {
+    pos.resize(TEST_ANIMATIONCLIP_KEYFRAMES);
+    rot.resize(TEST_ANIMATIONCLIP_KEYFRAMES - 3);
+    for (unsigned int i = 0; i < pos.size(); ++i)
+        pos[i].time = 0.1f * i + 0.02f * (i % 3), pos[i].value = Vec3(sin(0.7f * i), cos(0.4f * i), 0.5f * i);
+    for (unsigned int i = 0; i < rot.size(); ++i)
+        rot[i].time = 0.3f + 0.15f * i, rot[i].value = Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.6f * i);
+}
+
+bool testAnimationClipMatchesTracks() {
+    vector<Keyframe<Vec3>> pos;
+    vector<Keyframe<Quat>> rot;
+    testAnimationClipKeyframes(pos, rot);
+
+    // Pose is 2 transforms, the channels animate the second one
+    AnimationClip clip(1.0f);
+    clip.AddChannel((const float*)&pos[0], (unsigned int)pos.size(), 3, 8);
+    clip.AddChannel((const float*)&rot[0], (unsigned int)rot.size(), 4, 11, AnimationClip::CHANNEL_NORMALIZE);
+    if (clip.GetPoseSize() != 15)
+        return false;
+
+    Transform expected;
+    Track<Vec3> posTrack(&expected.pos, &pos[0], (unsigned int)pos.size());
+    Track<Quat, true> rotTrack(&expected.rot, &rot[0], (unsigned int)rot.size());
+
+    Transform pose[2];
+    ClipEvaluator evaluator(&clip);
+
+    // Forward, then looping back to the start and jumping over several intervals
+    const float times[] = { -0.5f, 0.0f, 0.05f, 0.1f, 0.13f, 0.29f, 0.45f, 0.61f, 0.62f, 0.95f, 2.0f, 0.2f, 0.01f, 0.77f };
+    for (unsigned int i = 0; i < sizeof(times) / sizeof(times[0]); ++i) {
+        posTrack.Update(times[i]);
+        rotTrack.Update(times[i]);
+        evaluator.Evaluate(times[i], (float*)pose);
+        if (!testNearEquals(&pose[1].pos.x, &expected.pos.x, 3, 1e-5f) || !testNearEquals(&pose[1].rot.x, &expected.rot.x, 4, 1e-5f))
+            return false;
+    }
+    return true;
+};
+
+bool testAnimationClipSingleKeyframe() {
+    const float keyframe[4] = { 0.5f, 1.0f, 2.0f, 3.0f };
+    AnimationClip clip(1.0f);
+    clip.AddChannel(keyframe, 1, 3, 0);
+
+    float pose[3];
+    ClipEvaluator evaluator(&clip);
+    evaluator.Evaluate(0.7f, pose);
+    return pose[0] == 1.0f && pose[1] == 2.0f && pose[2] == 3.0f;
+};
+
+bool testAnimationClipRandomSeek() {
+    // Evenly spaced keys on a line, the spline is the line away from the end keys
+    const unsigned int count = 2000;
+    vector<float> keyframes(count * 2);
+    for (unsigned int i = 0; i < count; ++i)
+        keyframes[i * 2] = keyframes[i * 2 + 1] = i * 0.01f;
+
+    AnimationClip clip(20.0f);
+    clip.AddChannel(&keyframes[0], count, 1, 0);
+    ClipEvaluator evaluator(&clip);
+
+    unsigned int seed = 1;
+    for (unsigned int i = 0; i < 1000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        float time = 0.02f + (seed >> 8) * (19.95f / (1 << 24));
+        float pose;
+        evaluator.Evaluate(time, &pose);
+        if (!testNearEquals(pose, time, 1e-4f))
+            return false;
+    }
+    return true;
+};
+
+bool testAnimationClipAuthoredTangents() {
+    // Flat out of the first key and slope 3 into the second is the curve time^3
+    const float keyframes[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+    const float tangents[4] = { 0.0f, 0.0f, 3.0f, 0.0f };
+    AnimationClip clip(1.0f);
+    clip.AddChannel(keyframes, 2, 1, 0, 0, tangents);
+
+    ClipEvaluator evaluator(&clip);
+    for (float time = 0.0f; time <= 1.0f; time += 0.125f) {
+        float pose;
+        evaluator.Evaluate(time, &pose);
+        if (!testNearEquals(pose, time * time * time, 1e-6f))
+            return false;
+    }
+    return true;
+};
+
+// A weighted Track update blends quaternions the short way, also when the target is
+// the same rotation with the opposite sign
+bool testAnimationClipTrackBlendHemisphere() {
+    Quat q = Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.6f);
+    Keyframe<Quat> keys[2] = { { 0.0f, q }, { 1.0f, q } };
+
+    Quat target = -q;
+    Track<Quat, true> track(&target, keys, 2);
+    track.Update(0.5f, 0.5f);
+    if (!testNearEquals(target, -q, 1e-6f))
+        return false;
+
+    // Halfway to a rotation stored in the other hemisphere
+    Quat r = Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 1.0f);
+    keys[0].value = keys[1].value = -r;
+    target = q;
+    Track<Quat, true> other(&target, keys, 2);
+    other.Update(0.5f, 0.5f);
+    return testNearEquals(target, Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.8f), 1e-5f);
+};
+
+vector<pair<const char*, bool(*)()>> animation_uanimationclip = {
+    {"MatchesTracks", &testAnimationClipMatchesTracks},
+    {"SingleKeyframe", &testAnimationClipSingleKeyframe},
+    {"RandomSeek", &testAnimationClipRandomSeek},
+    {"AuthoredTangents", &testAnimationClipAuthoredTangents},
+    {"TrackBlendHemisphere", &testAnimationClipTrackBlendHemisphere} };
+
+#endif
@@ -0,0 +1,110 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_ANIMATION_ANIMATIONEVENTS
+#ifdef MINI3D_TEST_ANIMATION_ANIMATIONEVENTS
+
+#include <vector>
+
+#include "../../mini3d_animation/animationclip.hpp"
+#include "../../mini3d_animation/animationevents.hpp"
+#include "../../mini3d_animation/clipplayer.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::animation;
+using namespace std;
+
+bool testAnimationEventsBufferOverflow() {
+    EventBuffer buffer(3);
+    for (unsigned int i = 0; i < 5; ++i) {
+        FiredEvent event = { 0, i, 0, 0.0f };
+        buffer.Push(event);
+    }
+
+    // The two oldest are overwritten
+    FiredEvent event;
+    if (buffer.GetCount() != 3 || buffer.GetDroppedCount() != 2)
+        return false;
+    for (unsigned int i = 2; i < 5; ++i)
+        if (!buffer.Pop(event) || event.id != i)
+            return false;
+    return !buffer.Pop(event);
+};
+
+bool testAnimationEventsCollect() {
+    EventTrack track;
+    track.AddEvent(0.5f, 2);
+    track.AddEvent(0.0f, 1);
+    track.AddEvent(0.5f, 3, 7);
+    track.AddEvent(0.9f, 4);
+
+    // [0.4, 0.9) and then wrapping around from 0.95 to 0.1
+    EventBuffer buffer(16);
+    track.Collect(0.4f, 0.9f, 0, 1.0f, 5, &buffer);
+    track.Collect(0.95f, 0.1f, 1, 1.0f, 6, &buffer);
+    track.Collect(0.2f, 0.1f, -1, 1.0f, 7, &buffer);
+
+    const unsigned int expected[][3] = { { 5, 2, 0 }, { 5, 3, 7 }, { 6, 1, 0 } };
+    FiredEvent event;
+    for (unsigned int i = 0; i < 3; ++i)
+        if (!buffer.Pop(event) || event.instance != expected[i][0] || event.id != expected[i][1] || event.payload != expected[i][2])
+            return false;
+    return buffer.GetCount() == 0;
+};
+
+bool testAnimationEventsPlayer() {
+    // A root channel moving 10 units per loop and a footstep at 0.25
+    const float root[] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.5f, 4.0f, 0.0f, 1.0f, 1.0f, 10.0f, 0.0f, 2.0f };
+    const float pose[] = { 0.0f, 1.0f, 1.0f, 2.0f };
+    AnimationClip clip(1.0f);
+    clip.AddChannel(root, 3, 3, 0, AnimationClip::CHANNEL_ROOT_MOTION);
+    clip.AddChannel(pose, 2, 1, 3);
+
+    EventTrack footsteps;
+    footsteps.AddEvent(0.25f, 1);
+
+    ClipPlayer<ClipEvaluator> player(&clip);
+    player.SetEventTrack(&footsteps);
+    player.Add(0.0f);
+    player.Add(0.5f);
+    if (player.GetRootMotionComponents() != 3)
+        return false;
+
+    EventBuffer events(64);
+    float motion[2][3], total[2][3] = { { 0, 0, 0 }, { 0, 0, 0 } };
+    const unsigned int steps = 25;
+    for (unsigned int i = 0; i < steps; ++i) {
+        player.Advance(0.13f, &events, &motion[0][0]);
+        for (unsigned int j = 0; j < 3; ++j)
+            total[0][j] += motion[0][j], total[1][j] += motion[1][j];
+    }
+
+    // 3.25 loops from 0 and from 0.5, the footstep at 3.25 is the next frame's
+    unsigned int footstepCount[2] = { 0, 0 };
+    FiredEvent event;
+    while (events.Pop(event))
+        ++footstepCount[event.instance];
+    if (footstepCount[0] != 3 || footstepCount[1] != 3)
+        return false;
+
+    // The movement adds up to the unwrapped distance, and the root channel is not written to the pose
+    float start[3], end[3], offset[3];
+    unsigned int cursor = 1;
+    ClipEvaluator::EvaluateChannel(&clip, clip.GetChannels()[0], cursor, 0.25f, end);
+    ClipEvaluator::EvaluateChannel(&clip, clip.GetChannels()[0], cursor, 0.75f, offset);
+    ClipEvaluator::EvaluateChannel(&clip, clip.GetChannels()[0], cursor, 0.5f, start);
+    if (!testNearEquals(total[0][0], 30.0f + end[0], 1e-3f) || !testNearEquals(total[1][0], 30.0f + offset[0] - start[0], 1e-3f) || !testNearEquals(total[0][2], 6.0f + end[2], 1e-3f))
+        return false;
+
+    float evaluated[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+    player.Evaluate(0, evaluated);
+    return evaluated[0] == -1.0f && evaluated[3] != -1.0f;
+};
+
+vector<pair<const char*, bool(*)()>> animation_uanimationevents = {
+    {"BufferOverflow", &testAnimationEventsBufferOverflow},
+    {"Collect", &testAnimationEventsCollect},
+    {"Player", &testAnimationEventsPlayer} };
+
+#endif
@@ -0,0 +1,191 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_ANIMATION_ANIMATIONMANAGER
+#ifdef MINI3D_TEST_ANIMATION_ANIMATIONMANAGER
+
+#include <vector>
+
+#include "../testutils.hpp"
+
+// The manager and the threads it runs on are not header only, the test runner
+// builds them in
+#include "../../mini3d_animation/animation.cpp"
+#include "../../mini3d_animation/animationmanager.cpp"
+#include "../../mini3d_system/platform/common/thread_unix.cpp"
+#include "../../mini3d_system/platform/win32/thread_win32.cpp"
+
+using namespace mini3d::animation;
+using namespace std;
+
+// Counts its updates and keeps the last time, every animation has one. The value
+// it animates is the time, blended like Track does.
+struct TestAnimationManagerTrack : ITrack
+{
+    TestAnimationManagerTrack() : updates(0), time(0), value(0) {}
+    void Update(float time, float weight)                               { ++updates; this->time = time; Blend(weight); }
+    void Blend(float weight)                                            { value += (time - value) * weight; }
+
+    unsigned int updates;
+    float time;
+    float value;
+};
+
+struct TestAnimationManagerScene
+{
+    TestAnimationManagerScene(unsigned int count) : tracks(count), pTracks(count), animations(count, 0) {
+        for (unsigned int i = 0; i < count; ++i) {
+            pTracks[i] = &tracks[i];
+            animations[i] = new Animation(&pTracks[i], 1, 100.0f);
+            animations[i]->Play();
+        }
+    }
+    ~TestAnimationManagerScene()                                        { for (unsigned int i = 0; i < animations.size(); ++i) delete animations[i]; }
+
+    bool Updated(unsigned int i, unsigned int updates) const            { return tracks[i].updates == updates; }
+
+    vector<TestAnimationManagerTrack> tracks;
+    vector<ITrack*> pTracks;
+    vector<Animation*> animations;
+};
+
+// More animations than the initial capacity, on more threads than ranges of at least
+// MIN_ANIMATIONS_PER_THREAD, every one is updated once per frame with the frame time
+bool testAnimationManagerManyAnimations() {
+    const unsigned int count = 300;
+    TestAnimationManagerScene scene(count);
+    AnimationManager manager(16);
+    for (unsigned int i = 0; i < count; ++i)
+        manager.AddAnimation(scene.animations[i]);
+
+    for (unsigned int frame = 1; frame <= 3; ++frame) {
+        manager.Update(0.25f);
+        for (unsigned int i = 0; i < count; ++i)
+            if (!scene.Updated(i, frame) || scene.tracks[i].time != 0.25f * frame)
+                return false;
+    }
+    return manager.GetAnimationCount() == count;
+};
+
+// Counts around the range boundaries split into ranges that cover every animation
+// once, for 1 to 3 threads
+bool testAnimationManagerRangeSplit() {
+    const unsigned int counts[] = { 0, 1, 31, 32, 33, 64, 65, 97 };
+    for (unsigned int threads = 1; threads <= 3; ++threads) {
+        for (unsigned int c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+            TestAnimationManagerScene scene(counts[c]);
+            AnimationManager manager(threads);
+            for (unsigned int i = 0; i < counts[c]; ++i)
+                manager.AddAnimation(scene.animations[i]);
+
+            manager.Update(0.1f);
+            manager.Update(0.1f);
+            for (unsigned int i = 0; i < counts[c]; ++i)
+                if (!scene.Updated(i, 2))
+                    return false;
+        }
+    }
+    return true;
+};
+
+// Removing finishes the update in progress, the animation is not updated after that
+bool testAnimationManagerRemoveDuringUpdate() {
+    const unsigned int count = 100;
+    TestAnimationManagerScene scene(count);
+    AnimationManager manager(4);
+    for (unsigned int i = 0; i < count; ++i)
+        manager.AddAnimation(scene.animations[i]);
+
+    manager.BeginUpdate(0.1f);
+    manager.RemoveAnimation(scene.animations[10]);
+    manager.RemoveAnimation(scene.animations[90]);
+    for (unsigned int i = 0; i < count; ++i)
+        if (!scene.Updated(i, 1))
+            return false;
+
+    manager.EndUpdate();
+    manager.Update(0.1f);
+    for (unsigned int i = 0; i < count; ++i)
+        if (!scene.Updated(i, (i == 10 || i == 90) ? 1 : 2))
+            return false;
+    return manager.GetAnimationCount() == count - 2;
+};
+
+// An animation with an interval of 4 is sampled every 4th frame with the time of all 4,
+// in between its value moves from the previous sample to the last one by a quarter of
+// the way per frame, reaching it in the frame before the next sample
+bool testAnimationManagerUpdateInterval() {
+    TestAnimationManagerScene scene(1);
+    AnimationManager manager;
+    manager.AddAnimation(scene.animations[0]);
+    manager.SetUpdateInterval(scene.animations[0], 4);
+
+    const float timeStep = 0.25f;
+    float previous = 0, last = 0;
+    for (unsigned int frame = 1; frame <= 16; ++frame) {
+        manager.Update(timeStep);
+        if (!scene.Updated(0, frame / 4))
+            return false;
+
+        // The first sample is written as is
+        if (frame % 4 == 0) {
+            previous = (frame == 4) ? timeStep * frame : last;
+            last = timeStep * frame;
+            if (scene.tracks[0].time != last)
+                return false;
+        }
+
+        float fraction = (frame % 4 + 1) / 4.0f;
+        if (frame >= 4 && !testNearEquals(scene.tracks[0].value, previous + (last - previous) * fraction, 1e-5f))
+            return false;
+    }
+    return true;
+};
+
+// With a budget of 3 tracks, 3 of 10 animations are updated per frame in turn and the
+// ones that wait move by all the time they waited. An animation with more tracks than
+// the budget is still updated.
+bool testAnimationManagerTrackBudget() {
+    const unsigned int count = 10;
+    const float timeStep = 0.125f;
+    TestAnimationManagerScene scene(count);
+    AnimationManager manager;
+    for (unsigned int i = 0; i < count; ++i)
+        manager.AddAnimation(scene.animations[i]);
+    manager.SetTrackBudget(3);
+
+    vector<float> times(count, 0);
+    for (unsigned int frame = 1; frame <= 10; ++frame) {
+        manager.Update(timeStep);
+        for (unsigned int update = (frame - 1) * 3; update < frame * 3; ++update)
+            times[update % count] = timeStep * frame;
+
+        for (unsigned int i = 0; i < count; ++i)
+            if (scene.tracks[i].time != times[i])
+                return false;
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+        if (!scene.Updated(i, 3))
+            return false;
+
+    TestAnimationManagerTrack track;
+    ITrack* pTracks[2] = { &track, &track };
+    Animation animation(pTracks, 2, 100.0f);
+    animation.Play();
+    AnimationManager single;
+    single.AddAnimation(&animation);
+    single.SetTrackBudget(1);
+    single.Update(timeStep);
+    return track.updates == 2;
+};
+
+vector<pair<const char*, bool(*)()>> animation_uanimationmanager = {
+    {"ManyAnimations", &testAnimationManagerManyAnimations},
+    {"RangeSplit", &testAnimationManagerRangeSplit},
+    {"RemoveDuringUpdate", &testAnimationManagerRemoveDuringUpdate},
+    {"UpdateInterval", &testAnimationManagerUpdateInterval},
+    {"TrackBudget", &testAnimationManagerTrackBudget} };
+
+#endif
@@ -0,0 +1,95 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_ANIMATION_BLENDSPACE
+#ifdef MINI3D_TEST_ANIMATION_BLENDSPACE
+
+#include <vector>
+
+#include "../../mini3d_animation/animationclip.hpp"
+#include "../../mini3d_animation/blendspace.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::animation;
+using namespace std;
+
+bool testBlendSpaceWeights1D() {
+    const float positions[3][2] = { { 2.0f, 0.0f }, { 0.0f, 0.0f }, { 1.0f, 0.0f } };
+    float weights[3];
+
+    BlendSpace::Weights1D(weights, positions, 3, 0.25f);
+    if (!testNearEquals(weights[0], 0.0f, 1e-6f) || !testNearEquals(weights[1], 0.75f, 1e-6f) || !testNearEquals(weights[2], 0.25f, 1e-6f))
+        return false;
+
+    BlendSpace::Weights1D(weights, positions, 3, 1.0f);
+    if (weights[0] != 0 || weights[1] != 0 || weights[2] != 1)
+        return false;
+
+    BlendSpace::Weights1D(weights, positions, 3, 5.0f);
+    return weights[0] == 1 && weights[1] == 0 && weights[2] == 0;
+};
+
+bool testBlendSpaceWeights2D() {
+    const float positions[4][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f }, { 1.0f, 1.0f } };
+    float weights[4];
+
+    // Each sample alone at its own position
+    for (unsigned int i = 0; i < 4; ++i) {
+        BlendSpace::Weights2D(weights, positions, 4, positions[i][0], positions[i][1]);
+        for (unsigned int j = 0; j < 4; ++j)
+            if (!testNearEquals(weights[j], (i == j) ? 1.0f : 0.0f, 1e-6f))
+                return false;
+    }
+
+    // Symmetric in the middle, and always summing to 1
+    BlendSpace::Weights2D(weights, positions, 4, 0.5f, 0.5f);
+    for (unsigned int j = 0; j < 4; ++j)
+        if (!testNearEquals(weights[j], 0.25f, 1e-6f))
+            return false;
+
+    BlendSpace::Weights2D(weights, positions, 4, 0.3f, 0.8f);
+    return testNearEquals(weights[0] + weights[1] + weights[2] + weights[3], 1.0f, 1e-6f) && weights[2] > weights[1];
+};
+
+bool testBlendSpaceEvaluate() {
+    // Two 1 float clips of different lengths going from 0 to 1 and from 0 to 3
+    const float walkKeys[] = { 0.0f, 0.0f, 1.0f, 1.0f };
+    const float runKeys[] = { 0.0f, 0.0f, 0.5f, 3.0f };
+    AnimationClip walk(1.0f), run(0.5f);
+    walk.AddChannel(walkKeys, 2, 1, 0);
+    run.AddChannel(runKeys, 2, 1, 0);
+    ClipEvaluator walkEvaluator(&walk), runEvaluator(&run);
+
+    BlendSpace blend(BlendSpace::BLEND_1D, 1);
+    blend.AddSample(&walkEvaluator, 1.0f);
+    blend.AddSample(&runEvaluator, 3.0f);
+    blend.SetParameter(1.5f);
+
+    // Blended length 0.75 * 1 + 0.25 * 0.5, both clips at the same phase
+    if (!testNearEquals(blend.GetLength(), 0.875f, 1e-6f))
+        return false;
+
+    float pose, walkPose, runPose;
+    blend.Evaluate(0.875f * 0.5f, &pose);
+    walkEvaluator.Evaluate(0.5f, &walkPose);
+    runEvaluator.Evaluate(0.25f, &runPose);
+    if (!testNearEquals(pose, walkPose * 0.75f + runPose * 0.25f, 1e-5f))
+        return false;
+
+    // Nested as a sample of another blend space
+    BlendSpace outer(BlendSpace::BLEND_1D, 1);
+    outer.AddSample(&blend, 0.0f);
+    outer.AddSample(&walkEvaluator, 1.0f);
+    outer.SetParameter(0.0f);
+    float outerPose;
+    outer.Evaluate(0.875f * 0.5f, &outerPose);
+    return testNearEquals(outerPose, pose, 1e-5f);
+};
+
+vector<pair<const char*, bool(*)()>> animation_ublendspace = {
+    {"Weights1D", &testBlendSpaceWeights1D},
+    {"Weights2D", &testBlendSpaceWeights2D},
+    {"Evaluate", &testBlendSpaceEvaluate} };
+
+#endif
@@ -0,0 +1,80 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_ANIMATION_CLIPPLAYER
+#ifdef MINI3D_TEST_ANIMATION_CLIPPLAYER
+
+#include <vector>
+#include <cmath>
+
+#include "../../mini3d_animation/animationclip.hpp"
+#include "../../mini3d_animation/clipplayer.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::animation;
+using namespace std;
+
+void testClipPlayerClip(AnimationClip &clip) {
+    const float keyframes[] = { 0.0f, 0.0f, 0.25f, 1.0f, 0.5f, 4.0f, 0.75f, 2.0f, 1.0f, 3.0f };
+    clip.AddChannel(keyframes, 5, 1, 0);
+}
+
+bool testClipPlayerMatchesEvaluators() {
+    AnimationClip clip(1.0f);
+    testClipPlayerClip(clip);
+
+    // More instances than the initial capacity, each at its own time
+    const unsigned int count = 40;
+    ClipPlayer<ClipEvaluator> player(&clip);
+    for (unsigned int i = 0; i < count; ++i)
+        if (player.Add(i * 0.023f) != i)
+            return false;
+
+    vector<float> poses(count);
+    for (unsigned int step = 0; step < 30; ++step) {
+        player.Advance(0.07f);
+        player.EvaluateAll(&poses[0], 1);
+
+        // Times stay inside the clip, a fresh evaluator at the same time gives the same pose
+        for (unsigned int i = 0; i < count; ++i) {
+            float time = player.GetState(i).time;
+            float wrapped = fmod(i * 0.023f + (step + 1) * 0.07f, 1.0f);
+            if (time < 0 || time >= 1.0f || (!testNearEquals(time, wrapped, 1e-4f) && !testNearEquals(fabs(time - wrapped), 1.0f, 1e-4f)))
+                return false;
+
+            ClipEvaluator evaluator(&clip);
+            float expected;
+            evaluator.Evaluate(time, &expected);
+            if (poses[i] != expected)
+                return false;
+        }
+    }
+    return true;
+};
+
+bool testClipPlayerRemove() {
+    AnimationClip clip(1.0f);
+    testClipPlayerClip(clip);
+
+    ClipPlayer<ClipEvaluator> player(&clip, false);
+    player.Add(0.1f);
+    player.Add(0.2f, 0.5f);
+    player.Add(0.9f, 0.25f);
+    player.Remove(0);
+
+    // The last instance moved to index 0, without looping the time is not wrapped
+    player.Advance(0.5f);
+    if (!(player.GetCount() == 2 && player.GetState(0).weight == 0.25f && testNearEquals(player.GetState(0).time, 1.4f, 1e-6f) && testNearEquals(player.GetState(1).time, 0.7f, 1e-6f)))
+        return false;
+
+    // Removing the last instance leaves the others in place
+    player.Remove(1);
+    return player.GetCount() == 1 && player.GetState(0).weight == 0.25f;
+};
+
+vector<pair<const char*, bool(*)()>> animation_uclipplayer = {
+    {"MatchesEvaluators", &testClipPlayerMatchesEvaluators},
+    {"Remove", &testClipPlayerRemove} };
+
+#endif
@@ -0,0 +1,141 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_ANIMATION_COMPRESSEDCLIP
+#ifdef MINI3D_TEST_ANIMATION_COMPRESSEDCLIP
+
+#include <vector>
+#include <cmath>
+
+#include "../../mini3d_math/transform.hpp"
+#include "../../mini3d_animation/track.hpp"
+#include "../../mini3d_animation/animationclip.hpp"
+#include "../../mini3d_animation/compressedclip.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::math;
+using namespace mini3d::animation;
+using namespace std;
+
+// Keys on whole frames at 30 fps, smooth enough for the compressor to remove some
+
+const unsigned int TEST_COMPRESSEDCLIP_KEYFRAMES = 61;
+
+void testCompressedClipKeyframes(vector<Keyframe<Vec3>> &pos, vector<Keyframe<Quat>> &rot) {
+    pos.resize(TEST_COMPRESSEDCLIP_KEYFRAMES);
+    rot.resize(TEST_COMPRESSEDCLIP_KEYFRAMES);
+    for (unsigned int i = 0; i < pos.size(); ++i) {
+        float time = i / 30.0f;
+        pos[i].time = time, pos[i].value = Vec3(sin(2.0f * time), 0.5f * time, (i < 30) ? 1.0f : 2.0f);
+        rot[i].time = time, rot[i].value = Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 2.5f * time);
+    }
+}
+
+bool testCompressedClipMatchesClip() {
+    vector<Keyframe<Vec3>> pos;
+    vector<Keyframe<Quat>> rot;
+    testCompressedClipKeyframes(pos, rot);
+
+    const float tolerance = 1e-3f;
+    AnimationClip clip(2.0f);
+    CompressedClip compressed(2.0f, tolerance);
+    clip.AddChannel((const float*)&pos[0], (unsigned int)pos.size(), 3, 0);
+    clip.AddChannel((const float*)&rot[0], (unsigned int)rot.size(), 4, 3, AnimationClip::CHANNEL_NORMALIZE);
+    compressed.AddChannel((const float*)&pos[0], (unsigned int)pos.size(), 3, 0);
+    compressed.AddChannel((const float*)&rot[0], (unsigned int)rot.size(), 4, 3, AnimationClip::CHANNEL_NORMALIZE);
+
+    if (compressed.GetPoseSize() != 7 || compressed.GetKeyCount() >= 2 * TEST_COMPRESSEDCLIP_KEYFRAMES)
+        return false;
+
+    float expected[7], pose[7];
+    ClipEvaluator evaluator(&clip);
+    CompressedClipEvaluator compressedEvaluator(&compressed);
+
+    // Every frame and between frames, then back to the start. Between keys the
+    // error may add up from both neighbors.
+    for (unsigned int i = 0; i <= 2 * 2 * 60 + 1; ++i) {
+        float time = (i <= 2 * 60) ? i / 60.0f : 0.3f;
+        evaluator.Evaluate(time, expected);
+        compressedEvaluator.Evaluate(time, pose);
+        if (!testNearEquals(pose, expected, 7, 2 * tolerance))
+            return false;
+    }
+
+    // The keys themselves are within tolerance plus quantization
+    for (unsigned int i = 0; i < pos.size(); ++i) {
+        compressedEvaluator.Evaluate(pos[i].time, pose);
+        if (!testNearEquals(pose, &pos[i].value.x, 3, tolerance + 1e-4f) || !testNearEquals(pose + 3, &rot[i].value.x, 4, tolerance + 1e-4f))
+            return false;
+    }
+    return true;
+};
+
+bool testCompressedClipConstantChannel() {
+    float keyframes[5 * 4];
+    for (unsigned int i = 0; i < 5; ++i)
+        keyframes[i * 4] = i / 30.0f, keyframes[i * 4 + 1] = 1.0f, keyframes[i * 4 + 2] = -2.0f, keyframes[i * 4 + 3] = 3.0f;
+
+    CompressedClip clip(1.0f);
+    clip.AddChannel(keyframes, 5, 3, 0);
+    if (clip.GetKeyCount() != 1)
+        return false;
+
+    float pose[3];
+    CompressedClipEvaluator evaluator(&clip);
+    evaluator.Evaluate(0.07f, pose);
+    return pose[0] == 1.0f && pose[1] == -2.0f && pose[2] == 3.0f;
+};
+
+bool testCompressedClipSmallestThree() {
+    const float quats[][4] = { { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, -1.0f }, { 0.5f, -0.5f, 0.5f, -0.5f }, { -0.9f, 0.1f, 0.3f, 0.3f }, { 0.1f, 0.2f, -0.95f, 0.2f } };
+
+    for (unsigned int i = 0; i < sizeof(quats) / sizeof(quats[0]); ++i) {
+        Quat q = Quat(quats[i][0], quats[i][1], quats[i][2], quats[i][3]).Normalized();
+        uint16_t packed[3];
+        float unpacked[4];
+        CompressedClip::QuatToSmallestThree(packed, &q.x);
+        CompressedClip::SmallestThreeToQuat(unpacked, packed);
+        if (!testNearEquals(unpacked, &q.x, 4, 1e-4f))
+            return false;
+    }
+    return true;
+};
+
+// Channels stored by the exporter are added as they are and evaluate like the clip they came from
+bool testCompressedClipAddCompressedChannel() {
+    vector<Keyframe<Vec3>> pos;
+    vector<Keyframe<Quat>> rot;
+    testCompressedClipKeyframes(pos, rot);
+
+    CompressedClip compressed(2.0f, 1e-3f);
+    compressed.AddChannel((const float*)&pos[0], (unsigned int)pos.size(), 3, 0);
+    compressed.AddChannel((const float*)&rot[0], (unsigned int)rot.size(), 4, 3, AnimationClip::CHANNEL_NORMALIZE);
+
+    CompressedClip stored(2.0f, 1e-3f);
+    for (unsigned int c = 0; c < compressed.GetChannelCount(); ++c) {
+        const CompressedClip::Channel &channel = compressed.GetChannels()[c];
+        stored.AddCompressedChannel(compressed.GetFrames() + channel.firstKey, compressed.GetValues() + channel.firstValue, channel.keyCount, channel.components, channel.poseOffset, channel.flags, channel.minimum, channel.scale);
+    }
+
+    if (stored.GetKeyCount() != compressed.GetKeyCount() || stored.GetPoseSize() != compressed.GetPoseSize() || stored.GetChannels()[1].encoding != CompressedClip::ENCODING_SMALLEST_THREE)
+        return false;
+
+    float expected[7], pose[7];
+    CompressedClipEvaluator evaluator(&compressed), storedEvaluator(&stored);
+    for (unsigned int i = 0; i <= 2 * 60; ++i) {
+        evaluator.Evaluate(i / 60.0f, expected);
+        storedEvaluator.Evaluate(i / 60.0f, pose);
+        if (!testNearEquals(pose, expected, 7, 0))
+            return false;
+    }
+    return true;
+};
+
+vector<pair<const char*, bool(*)()>> animation_ucompressedclip = {
+    {"MatchesClip", &testCompressedClipMatchesClip},
+    {"ConstantChannel", &testCompressedClipConstantChannel},
+    {"SmallestThree", &testCompressedClipSmallestThree},
+    {"AddCompressedChannel", &testCompressedClipAddCompressedChannel} };
+
+#endif
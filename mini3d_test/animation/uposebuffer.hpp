@@ -0,0 +1,105 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_ANIMATION_POSEBUFFER
+#ifdef MINI3D_TEST_ANIMATION_POSEBUFFER
+
+#include <vector>
+#include <cmath>
+
+#include "../../mini3d_math/transform.hpp"
+#include "../../mini3d_animation/posebuffer.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::math;
+using namespace mini3d::animation;
+using namespace std;
+
+// Poses are one Transform: pos, rot, scale
+
+Transform testPoseBufferTransform(float x, float angle, float scale) {
+    Transform t;
+    t.pos = Vec3(x, 2 * x, 1.0f);
+    t.rot = Quat::FromAxisAngle(0.0f, 0.0f, 1.0f, angle);
+    t.scale = scale;
+    return t;
+}
+
+bool testPoseBufferAccumulate() {
+    Transform a = testPoseBufferTransform(1.0f, 0.2f, 1.0f);
+    Transform b = testPoseBufferTransform(3.0f, 0.6f, 2.0f);
+
+    // b with the opposite sign is the same rotation and must not cancel a
+    b.rot = b.rot * -1.0f;
+
+    PoseBuffer pose(8, 3, 8);
+    pose.Accumulate((const float*)&a, 0.25f);
+    pose.Accumulate((const float*)&b, 0.75f);
+    pose.Normalize();
+
+    const Transform* result = (const Transform*)pose.GetPose();
+    Quat expected = Quat::FromAxisAngle(0.0f, 0.0f, 1.0f, 0.2f) * 0.25f + Quat::FromAxisAngle(0.0f, 0.0f, 1.0f, 0.6f) * 0.75f;
+    expected.Normalize();
+
+    Vec3 expectedPos(2.5f, 5.0f, 1.0f);
+    return testNearEquals(&result->pos.x, &expectedPos.x, 3, 1e-5f) && testNearEquals(&result->rot.x, &expected.x, 4, 1e-5f) && fabs(result->scale - 1.75f) < 1e-5f;
+};
+
+bool testPoseBufferOverride() {
+    Transform a = testPoseBufferTransform(1.0f, 0.2f, 1.0f);
+    Transform b = testPoseBufferTransform(3.0f, 0.6f, 2.0f);
+
+    PoseBuffer pose(8, 3, 8);
+    pose.Accumulate((const float*)&a, 1.0f);
+    pose.Normalize();
+
+    // A cross-fade starts at a and ends at b
+    pose.Override((const float*)&b, 0.0f);
+    if (!testNearEquals(pose.GetPose(), (const float*)&a, 8, 1e-6f))
+        return false;
+
+    pose.Override((const float*)&b, 0.5f);
+    const Transform* result = (const Transform*)pose.GetPose();
+    Quat expected = Quat::FromAxisAngle(0.0f, 0.0f, 1.0f, 0.4f);
+    Vec3 expectedPos(2.0f, 4.0f, 1.0f);
+    if (!testNearEquals(&result->pos.x, &expectedPos.x, 3, 1e-5f) || !testNearEquals(&result->rot.x, &expected.x, 4, 1e-5f))
+        return false;
+
+    pose.Override((const float*)&b, 1.0f);
+    return testNearEquals(pose.GetPose(), (const float*)&b, 8, 1e-6f);
+};
+
+bool testPoseBufferAdd() {
+    Transform base = testPoseBufferTransform(1.0f, 0.0f, 1.0f);
+    base.rot = Quat::FromAxisAngle(1.0f, 0.0f, 0.0f, 0.5f);
+    Transform reference = testPoseBufferTransform(0.0f, 0.1f, 1.0f);
+    Transform layer = testPoseBufferTransform(0.5f, 0.5f, 1.5f);
+
+    PoseBuffer pose(8, 3, 8);
+    pose.Accumulate((const float*)&base, 1.0f);
+    pose.Normalize();
+    pose.Add((const float*)&layer, (const float*)&reference, 1.0f);
+
+    // The full difference rotates by 0.4 around z on top of base
+    const Transform* result = (const Transform*)pose.GetPose();
+    Quat expected = Quat::FromAxisAngle(0.0f, 0.0f, 1.0f, 0.4f) * base.rot;
+    Vec3 expectedPos(1.5f, 3.0f, 1.0f);
+    if (!testNearEquals(&result->pos.x, &expectedPos.x, 3, 1e-5f) || !testNearEquals(&result->rot.x, &expected.x, 4, 1e-5f) || fabs(result->scale - 1.5f) > 1e-5f)
+        return false;
+
+    // Half the weight is half the angle
+    pose.Clear();
+    pose.Accumulate((const float*)&base, 1.0f);
+    pose.Normalize();
+    pose.Add((const float*)&layer, (const float*)&reference, 0.5f);
+    expected = Quat::FromAxisAngle(0.0f, 0.0f, 1.0f, 0.2f) * base.rot;
+    return testNearEquals(&result->rot.x, &expected.x, 4, 1e-3f);
+};
+
+vector<pair<const char*, bool(*)()>> animation_uposebuffer = {
+    {"Accumulate", &testPoseBufferAccumulate},
+    {"Override", &testPoseBufferOverride},
+    {"Add", &testPoseBufferAdd} };
+
+#endif
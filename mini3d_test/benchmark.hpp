@@ -0,0 +1,91 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#ifndef MINI3D_TEST_BENCHMARK_H
+#define MINI3D_TEST_BENCHMARK_H
+
+#include <chrono>
+#include <cstdio>
+
+#ifdef __linux__
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// Keeps the optimizer from removing the benchmarked work. With GCC and Clang the
+// compiler has to assume all of value, and any memory the work wrote, is read.
+// Elsewhere every byte of value goes into a volatile sum.
+template <typename T> inline void benchmarkSink(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static volatile unsigned char sink;
+    unsigned char sum = 0;
+    for (unsigned int i = 0; i < sizeof(T); ++i)
+        sum += ((const unsigned char*)&value)[i];
+    sink = sink + sum;
+#endif
+}
+
+// Runs f() repeatedly and returns the best time for one call in nanoseconds
+template <typename F> double benchmarkNanoseconds(F f, unsigned int repetitions = 7)
+{
+    double best = 1e30;
+    for (unsigned int i = 0; i < repetitions; ++i)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        f();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+        best = (ns < best) ? ns : best;
+    }
+    return best;
+}
+
+// Runs f() once and returns the hardware cache misses of the calling thread, or -1
+// where perf counters are not available (not Linux, or perf_event_paranoid too high)
+template <typename F> long long benchmarkCacheMisses(F f)
+{
+#ifdef __linux__
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd < 0)
+    {
+        f();
+        return -1;
+    }
+
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    f();
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+    long long misses = -1;
+    if (read(fd, &misses, sizeof(misses)) != sizeof(misses))
+        misses = -1;
+    close(fd);
+    return misses;
+#else
+    f();
+    return -1;
+#endif
+}
+
+inline void benchmarkReport(const char* name, double nsReference, double ns, unsigned int count)
+{
+    printf("  %-32s reference: %8.3f ns  mini3d: %8.3f ns  speedup: %5.2fx\n", name, nsReference / count, ns / count, nsReference / ns);
+}
+
+#endif
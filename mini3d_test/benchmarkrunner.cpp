@@ -0,0 +1,57 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_BENCHMARK
+#ifdef MINI3D_BENCHMARK
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdarg>
+
+#include "math/bquat.hpp"
+#include "math/bbonepalette.hpp"
+#include "math/bfastmath.hpp"
+#include "math/bskinning.hpp"
+#include "animation/btrack.hpp"
+#include "animation/banimationclip.hpp"
+
+using namespace std;
+
+void mini3d_assert(bool expression, const char* text, ...) {
+    if (expression)
+        return;
+
+    va_list args;
+    va_start(args, text);
+    printf("Assert: ");
+    vprintf(text, args);
+    printf("\n");
+    va_end(args);
+}
+
+int main() {
+
+    vector<pair<const char*, vector<pair<const char*, void(*)()>>>> suites = {
+        { "mini3d_math/quat.hpp", math_bquat },
+        { "mini3d_math/bonepalette.hpp", math_bbonepalette },
+        { "mini3d_math/fastmath.hpp", math_bfastmath },
+        { "mini3d_math/skinning.hpp", math_bskinning },
+        { "mini3d_animation/track.hpp", animation_btrack },
+        { "mini3d_animation/animationclip.hpp", animation_banimationclip } };
+
+	for (auto suite : suites) {
+        printf("Begin benchmark suite: %s ------ \n\n", suite.first);
+        
+		for (auto benchmark : suite.second) {
+            printf("%s:\n", benchmark.first);
+            benchmark.second();
+		}
+        printf("\n");
+	}
+    
+    return 0;
+}
+
+#endif
@@ -0,0 +1,111 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_IMPORT_ARENA
+#ifdef MINI3D_TEST_IMPORT_ARENA
+
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+
+// The arena is built in by umini3dimporter.hpp
+#include "../../mini3d_import/common/arena.hpp"
+
+using namespace mini3d::import;
+using namespace std;
+
+// Allocations of odd sizes come back aligned as asked and do not overlap
+bool testArenaAlignment() {
+    const size_t alignments[] = { 1, 2, 4, 8, 16, 64, 256 };
+    const unsigned int count = sizeof(alignments) / sizeof(alignments[0]);
+
+    Arena arena;
+    vector<unsigned char*> allocations;
+    for (unsigned int i = 0; i < 3 * count; ++i) {
+        unsigned char* p = (unsigned char*)arena.Allocate(i + 1, alignments[i % count]);
+        if ((uintptr_t)p % alignments[i % count] != 0)
+            return false;
+        memset(p, i, i + 1);
+        allocations.push_back(p);
+    }
+
+    for (unsigned int i = 0; i < allocations.size(); ++i)
+        for (unsigned int j = 0; j <= i; ++j)
+            if (allocations[i][j] != i)
+                return false;
+
+    // New places its objects 16 byte aligned
+    float* pFloats = arena.New<float>(3);
+    return (uintptr_t)pFloats % 16 == 0 && pFloats[0] == 0 && pFloats[2] == 0 && arena.GetBlockCount() == 1;
+};
+
+// A reserved block takes exactly what was reserved, the next allocation adds a block and
+// leaves what was allocated before as it was
+bool testArenaExhaustion() {
+    Arena arena;
+    arena.Reserve(100);
+    char* pFirst = (char*)arena.Allocate(60, 1);
+    char* pSecond = (char*)arena.Allocate(40, 1);
+    memset(pFirst, 1, 60);
+    memset(pSecond, 2, 40);
+    if (arena.GetBlockCount() != 1 || arena.GetSize() != 100 || pSecond != pFirst + 60)
+        return false;
+
+    // Reserving what fits in the current block adds nothing
+    arena.Reserve(0);
+    char* pThird = (char*)arena.Allocate(1, 1);
+    *pThird = 3;
+    return arena.GetBlockCount() == 2 && arena.GetSize() == 100 + Arena::DEFAULT_BLOCK_SIZE &&
+           pFirst[59] == 1 && pSecond[0] == 2 && pSecond[39] == 2 && *pThird == 3;
+};
+
+// Small allocations fill DEFAULT_BLOCK_SIZE blocks one after the other, an allocation
+// larger than that gets a block of its own with room for its alignment and the
+// allocations after it go on in the block before
+bool testArenaGrowth() {
+    Arena arena;
+    const size_t size = 1000;
+    const unsigned int perBlock = (unsigned int)(Arena::DEFAULT_BLOCK_SIZE / size);
+    for (unsigned int i = 0; i < 3 * perBlock; ++i)
+        memset(arena.Allocate(size, 8), 0, size);
+
+    if (arena.GetBlockCount() != 3 || arena.GetSize() != 3 * Arena::DEFAULT_BLOCK_SIZE)
+        return false;
+
+    const size_t large = 3 * Arena::DEFAULT_BLOCK_SIZE + 1;
+    char* pLarge = (char*)arena.Allocate(large, 64);
+    memset(pLarge, 0, large);
+    char* pSmall = (char*)arena.Allocate(size / 2, 8);
+    memset(pSmall, 0, size / 2);
+    return (uintptr_t)pLarge % 64 == 0 && arena.GetBlockCount() == 4 && arena.GetSize() == 3 * Arena::DEFAULT_BLOCK_SIZE + large + 64 &&
+           (pSmall < pLarge || pSmall >= pLarge + large);
+};
+
+// Allocations that only fit in DEFAULT_BLOCK_SIZE before they are aligned get a block of
+// their own, as large allocations do
+bool testArenaAlignedBlockSize() {
+    const size_t sizes[] = { Arena::DEFAULT_BLOCK_SIZE, Arena::DEFAULT_BLOCK_SIZE - 8, Arena::DEFAULT_BLOCK_SIZE - 24 };
+    const unsigned int count = sizeof(sizes) / sizeof(sizes[0]);
+
+    Arena arena;
+    for (unsigned int i = 0; i < count; ++i) {
+        char* p = (char*)arena.Allocate(sizes[i], 32);
+        memset(p, 0, sizes[i]);
+        if ((uintptr_t)p % 32 != 0 || arena.GetBlockCount() != i + 1)
+            return false;
+    }
+
+    // One that fits with its alignment still takes a default block
+    char* p = (char*)arena.Allocate(Arena::DEFAULT_BLOCK_SIZE - 64, 32);
+    memset(p, 0, Arena::DEFAULT_BLOCK_SIZE - 64);
+    return (uintptr_t)p % 32 == 0 && arena.GetBlockCount() == count + 1 && arena.GetSize() == sizes[0] + sizes[1] + sizes[2] + 3 * 32 + Arena::DEFAULT_BLOCK_SIZE;
+};
+
+vector<pair<const char*, bool(*)()>> import_uarena = {
+    {"Alignment", &testArenaAlignment},
+    {"Exhaustion", &testArenaExhaustion},
+    {"Growth", &testArenaGrowth},
+    {"AlignedBlockSize", &testArenaAlignedBlockSize} };
+
+#endif
@@ -0,0 +1,120 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_IMPORT_ASSETARRAY
+#ifdef MINI3D_TEST_IMPORT_ASSETARRAY
+
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+// The asset library is built in by umini3dimporter.hpp
+#include "../../mini3d_import/assetlibrary.hpp"
+
+using namespace mini3d::import;
+using namespace std;
+
+void testAssetArraySetName(NamedResource &resource, const char* name) {
+    resource.name = strcpy(new char[strlen(name) + 1], name);
+}
+
+// Fills pName with the index-th name that hashes to slot of an index with slots slots
+void testAssetArrayNameInSlot(char* pName, unsigned int slot, unsigned int slots, unsigned int index) {
+    for (unsigned int i = 0, found = 0; ; ++i) {
+        sprintf(pName, "joint%u", i);
+        if ((NameHash(pName) & (slots - 1)) == slot && found++ == index)
+            return;
+    }
+}
+
+// Names that all hash to the last slot of the index are probed past the end of the
+// table into its first slots. A missing name with the same slot is probed up to the
+// first empty slot.
+bool testAssetArrayCollisions() {
+    const unsigned int count = 4, slots = 8;
+    char names[count + 1][16];
+    for (unsigned int i = 0; i <= count; ++i)
+        testAssetArrayNameInSlot(names[i], slots - 1, slots, i);
+
+    AssetArray<Joint> joints;
+    joints.array = new Joint[count];
+    joints.count = count;
+    for (unsigned int i = 0; i < count; ++i)
+        testAssetArraySetName(joints.array[i], names[i]);
+    joints.BuildIndex();
+
+    for (unsigned int i = 0; i < count; ++i)
+        if (joints.Find(names[i]) != joints.array + i || joints.Find(NameHash(names[i]), 0) != joints.array + i)
+            return false;
+    return joints.Find(names[count]) == 0 && joints.Find(NameHash(names[count]), 0) == 0;
+};
+
+// With duplicate names the first element is found, with and without the index
+bool testAssetArrayDuplicates() {
+    const char* names[] = { "b", "a", "c", "a", "b" };
+    const unsigned int count = sizeof(names) / sizeof(names[0]);
+
+    AssetArray<Joint> joints;
+    joints.array = new Joint[count];
+    joints.count = count;
+    for (unsigned int i = 0; i < count; ++i)
+        testAssetArraySetName(joints.array[i], names[i]);
+
+    bool scanned = joints.Find("a") == joints.array + 1 && joints.Find("b") == joints.array + 0;
+    joints.BuildIndex();
+    return scanned && joints.Find("a") == joints.array + 1 && joints.Find("b") == joints.array + 0 && joints.Find("c") == joints.array + 2;
+};
+
+// Material texture slots without a texture are 0, they are skipped when indexing and
+// searching
+bool testAssetArrayNullSlots() {
+    Texture diffuse, normal;
+    testAssetArraySetName(diffuse, "diffuse");
+    testAssetArraySetName(normal, "normal");
+
+    Material material;
+    material.textures.array = new Texture*[4];
+    material.textures.count = 4;
+    material.textures.array[0] = 0;
+    material.textures.array[1] = &diffuse;
+    material.textures.array[2] = 0;
+    material.textures.array[3] = &normal;
+
+    AssetArray<Texture*> &textures = material.textures;
+    bool scanned = textures.Find("normal") == textures.array + 3 && textures.Find("specular") == 0;
+    textures.BuildIndex();
+    return scanned && textures.Find("diffuse") == textures.array + 1 && textures.Find("normal") == textures.array + 3 && textures.Find("specular") == 0;
+};
+
+// An element added after the array was indexed is found by searching front to back
+// until the index is built again
+bool testAssetArrayCountChanged() {
+    const char* names[] = { "hip", "spine", "head" };
+    const unsigned int count = sizeof(names) / sizeof(names[0]);
+
+    AssetArray<Joint> joints;
+    joints.array = new Joint[count];
+    for (unsigned int i = 0; i < count; ++i)
+        testAssetArraySetName(joints.array[i], names[i]);
+
+    joints.count = count - 1;
+    joints.BuildIndex();
+    if (joints.Find("head") != 0 || joints.Find("spine") != joints.array + 1)
+        return false;
+
+    joints.count = count;
+    if (joints.Find("head") != joints.array + 2 || joints.Find("hip") != joints.array + 0)
+        return false;
+
+    joints.BuildIndex();
+    return joints.Find("head") == joints.array + 2 && joints.Find("neck") == 0;
+};
+
+vector<pair<const char*, bool(*)()>> import_uassetarray = {
+    {"Collisions", &testAssetArrayCollisions},
+    {"Duplicates", &testAssetArrayDuplicates},
+    {"NullSlots", &testAssetArrayNullSlots},
+    {"CountChanged", &testAssetArrayCountChanged} };
+
+#endif
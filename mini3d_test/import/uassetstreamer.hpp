@@ -0,0 +1,150 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_IMPORT_ASSETSTREAMER
+#ifdef MINI3D_TEST_IMPORT_ASSETSTREAMER
+
+#include <vector>
+#include <atomic>
+
+// The streamer is not header only, the test runner builds it in. The importer and the
+// threads it uses are built in by umini3dimporter.hpp and uanimationmanager.hpp.
+#include "../../mini3d_import/assetstreamer.cpp"
+
+using namespace mini3d::import;
+using namespace mini3d::system;
+using namespace std;
+
+typedef AssetStreamer::JobQueue TestAssetStreamerQueue;
+
+// Counts its steps, Read waits while blocked is set
+struct TestAssetStreamerJob : StreamJob
+{
+    TestAssetStreamerJob() : reads(0), decodes(0), finalizes(0), discards(0), blocked(false), reading(false) {}
+
+    bool Read()                                                         { reading = true; while (blocked) IThread::SleepCurrentThread(1); ++reads; return true; }
+    bool Decode()                                                       { ++decodes; return true; }
+    void Finalize()                                                     { ++finalizes; }
+    void Discard()                                                      { ++discards; }
+
+    unsigned int reads;
+    unsigned int decodes;
+    unsigned int finalizes;
+    unsigned int discards;
+    atomic<bool> blocked;
+    atomic<bool> reading;
+};
+
+// Pops the queue empty, true if the jobs come out in the order of order
+bool testAssetStreamerPopsInOrder(TestAssetStreamerQueue &queue, TestAssetStreamerJob* jobs, const unsigned int* order, unsigned int count) {
+    for (unsigned int i = 0; i < count; ++i)
+        if (queue.Pop() != jobs + order[i])
+            return false;
+    return queue.Pop() == 0 && queue.GetCount() == 0;
+}
+
+// Higher priorities come first and equal priorities in the order they were pushed, also
+// past the initial capacity and across a sequence number that wraps around
+bool testAssetStreamerQueuePriority() {
+    const unsigned int count = 100;
+    TestAssetStreamerJob jobs[count];
+    TestAssetStreamerQueue queue;
+    for (unsigned int i = 0; i < count; ++i)
+        queue.Push(jobs + i, i % 3, 0xffffffff - count / 2 + i);
+
+    unsigned int order[count];
+    unsigned int next = 0;
+    for (int priority = 2; priority >= 0; --priority)
+        for (unsigned int i = 0; i < count; ++i)
+            if ((int)(i % 3) == priority)
+                order[next++] = i;
+
+    return queue.GetCount() == count && testAssetStreamerPopsInOrder(queue, jobs, order, count);
+};
+
+// A job moves up and down when its priority changes in the queue
+bool testAssetStreamerQueueReprioritize() {
+    const unsigned int count = 8;
+    TestAssetStreamerJob jobs[count];
+    TestAssetStreamerQueue queue;
+    for (unsigned int i = 0; i < count; ++i)
+        queue.Push(jobs + i, 0, i);
+
+    queue.Reorder(jobs + 6, 5);
+    queue.Reorder(jobs + 0, -1);
+    queue.Reorder(jobs + 3, 5);
+
+    const unsigned int order[count] = { 3, 6, 1, 2, 4, 5, 7, 0 };
+    return testAssetStreamerPopsInOrder(queue, jobs, order, count);
+};
+
+// Removed jobs, the top, the last and one in between, are no longer in the queue and the
+// others keep their order
+bool testAssetStreamerQueueCancel() {
+    const unsigned int count = 10;
+    TestAssetStreamerJob jobs[count];
+    TestAssetStreamerQueue queue;
+    for (unsigned int i = 0; i < count; ++i)
+        queue.Push(jobs + i, count - i, i);
+
+    queue.Remove(jobs + 0);
+    queue.Remove(jobs + 4);
+    queue.Remove(jobs + 9);
+    if (queue.Contains(jobs + 0) || queue.Contains(jobs + 4) || queue.Contains(jobs + 9) || !queue.Contains(jobs + 5))
+        return false;
+
+    const unsigned int order[7] = { 1, 2, 3, 5, 6, 7, 8 };
+    return testAssetStreamerPopsInOrder(queue, jobs, order, 7);
+};
+
+// Waits for the streamer to finish its jobs
+bool testAssetStreamerFinish(AssetStreamer &streamer) {
+    for (unsigned int i = 0; i < 10000 && streamer.GetPendingCount() > 0; ++i) {
+        streamer.Update();
+        IThread::SleepCurrentThread(1);
+    }
+    return streamer.GetPendingCount() == 0;
+}
+
+// While the I/O thread reads a job the others are read by priority, a job cancelled in
+// the queue is discarded right away and one cancelled while read is discarded by Update.
+// The threads wait for the next request once there is nothing left.
+bool testAssetStreamerStreamer() {
+    const unsigned int count = 5;
+    TestAssetStreamerJob blocking;
+    TestAssetStreamerJob jobs[count];
+    AssetStreamer streamer(2);
+
+    blocking.blocked = true;
+    streamer.Request(&blocking, 10);
+    while (!blocking.reading)
+        IThread::SleepCurrentThread(1);
+
+    for (unsigned int i = 0; i < count; ++i)
+        streamer.Request(jobs + i, (int)i);
+    streamer.SetPriority(jobs + 0, 9);
+    streamer.Cancel(jobs + 2);
+    streamer.Cancel(&blocking);
+    bool cancelled = jobs[2].GetState() == StreamJob::CANCELLED && jobs[2].discards == 1 && blocking.GetState() == StreamJob::QUEUED;
+
+    blocking.blocked = false;
+    if (!testAssetStreamerFinish(streamer))
+        return false;
+
+    bool loaded = blocking.GetState() == StreamJob::CANCELLED && blocking.discards == 1 && blocking.decodes == 0 && jobs[2].reads == 0;
+    for (unsigned int i = 0; i < count; ++i)
+        if (i != 2)
+            loaded = loaded && jobs[i].GetState() == StreamJob::READY && jobs[i].reads == 1 && jobs[i].decodes == 1 && jobs[i].finalizes == 1;
+
+    streamer.Request(jobs + 2);
+    return cancelled && loaded && testAssetStreamerFinish(streamer) && jobs[2].GetState() == StreamJob::READY && jobs[2].finalizes == 1;
+};
+
+vector<pair<const char*, bool(*)()>> import_uassetstreamer = {
+    {"QueuePriority", &testAssetStreamerQueuePriority},
+    {"QueueReprioritize", &testAssetStreamerQueueReprioritize},
+    {"QueueCancel", &testAssetStreamerQueueCancel},
+    {"Streamer", &testAssetStreamerStreamer} };
+
+#endif
@@ -0,0 +1,354 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_IMPORT_MINI3DIMPORTER
+#ifdef MINI3D_TEST_IMPORT_MINI3DIMPORTER
+
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <stdint.h>
+
+// The importer is not header only, the test runner builds it in
+#include "../../mini3d_import/assetlibrary.cpp"
+#include "../../mini3d_import/importers/mini3d/mini3dimporter.cpp"
+#include "../../mini3d_import/common/mappedfile.cpp"
+#include "../../mini3d_import/common/arena.cpp"
+
+using namespace mini3d::import;
+using namespace std;
+
+// Builds the bytes of a version 1 file
+struct TestMini3dImporterFile
+{
+    vector<char> bytes;
+
+    void Bytes(const void* p, size_t size)                              { bytes.insert(bytes.end(), (const char*)p, (const char*)p + size); }
+    void Short(uint16_t value)                                          { Bytes(&value, sizeof(value)); }
+    void Int32(uint32_t value)                                          { Bytes(&value, sizeof(value)); }
+    void String(const char* s)                                          { Short((uint16_t)strlen(s)); Bytes(s, strlen(s)); }
+
+    // One mesh of count vertices and nothing else
+    static TestMini3dImporterFile Mesh(unsigned int count)
+    {
+        TestMini3dImporterFile file;
+        file.Short(1);
+        file.String("Mesh");
+        file.Short(3 * sizeof(float));
+        file.Int32(count * 3 * sizeof(float));
+        for (unsigned int i = 0; i < count * 3; ++i) {
+            float value = (float)i;
+            file.Bytes(&value, sizeof(value));
+        }
+        file.Short(2);
+        file.Int32(0);
+        for (unsigned int i = 0; i < 5; ++i)
+            file.Short(0);
+        return file;
+    }
+
+    // Writes the first size bytes to a file in the working directory and loads it
+    AssetLibrary* Load(size_t size) const
+    {
+        FILE* file = fopen(FILENAME, "wb");
+        if (file == 0)
+            return 0;
+        fwrite(&bytes[0], 1, size, file);
+        fclose(file);
+
+        Mini3dImporter importer;
+        return importer.LoadSceneFromFile(FILENAME);
+    }
+
+    // The file can only be removed once the library has unmapped it
+    static void Remove()                                                { remove(FILENAME); }
+
+    static const char* FILENAME;
+};
+
+const char* TestMini3dImporterFile::FILENAME = "mini3d_test_importer.m3d";
+
+// Builds the sections of a version 2 file
+struct TestMini3dImporterSections
+{
+    vector<char> sections[m3d::SECTION_COUNT];
+    unsigned int counts[m3d::SECTION_COUNT];
+
+    TestMini3dImporterSections()                                        { memset(counts, 0, sizeof(counts)); }
+
+    template <typename T> void Record(m3d::SectionType type, const T &record) {
+        sections[type].insert(sections[type].end(), (const char*)&record, (const char*)&record + sizeof(record));
+        ++counts[type];
+    }
+
+    uint32_t String(const char* s) {
+        vector<char> &strings = sections[m3d::SECTION_STRINGS];
+        uint32_t offset = (uint32_t)strings.size();
+        strings.insert(strings.end(), s, s + strlen(s) + 1);
+        return offset;
+    }
+
+    // Aligned to m3d::ALIGNMENT and then moved by misalignment bytes
+    m3d::Blob Data(const void* p, size_t size, unsigned int misalignment = 0) {
+        vector<char> &data = sections[m3d::SECTION_DATA];
+        data.resize((data.size() + m3d::ALIGNMENT - 1) / m3d::ALIGNMENT * m3d::ALIGNMENT + misalignment);
+        m3d::Blob blob = { data.size(), size };
+        data.insert(data.end(), (const char*)p, (const char*)p + size);
+        return blob;
+    }
+
+    // The header, the table of contents and the sections that are not empty in type order
+    TestMini3dImporterFile File() const {
+        vector<m3d::Section> toc;
+        for (unsigned int type = 0; type < m3d::SECTION_COUNT; ++type)
+            if (!sections[type].empty()) {
+                m3d::Section section = { type, counts[type], 0, sections[type].size() };
+                toc.push_back(section);
+            }
+
+        TestMini3dImporterFile file;
+        const m3d::Header header = { m3d::MAGIC, m3d::VERSION, (uint32_t)toc.size(), 0 };
+        file.Bytes(&header, sizeof(header));
+        file.Bytes(&toc[0], toc.size() * sizeof(m3d::Section));
+
+        for (unsigned int i = 0; i < toc.size(); ++i) {
+            file.bytes.resize((file.bytes.size() + m3d::ALIGNMENT - 1) / m3d::ALIGNMENT * m3d::ALIGNMENT);
+            toc[i].offset = file.bytes.size();
+            memcpy(&file.bytes[sizeof(header) + i * sizeof(m3d::Section)], &toc[i], sizeof(m3d::Section));
+            file.Bytes(&sections[toc[i].type][0], sections[toc[i].type].size());
+        }
+        return file;
+    }
+
+    // One mesh of 3 vertices and one action with a position channel of 2 keys, the
+    // keys moved by misalignment bytes in the data section
+    static TestMini3dImporterSections MeshAndAction(unsigned int misalignment = 0) {
+        TestMini3dImporterSections sections;
+        const float vertices[9] = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+        const float keyframes[8] = { 0, 1, 2, 3, 1, 4, 5, 6 };
+
+        const m3d::Blob none = { 0, 0 };
+        const m3d::MeshRecord mesh = { sections.String("Mesh"), 3 * sizeof(float), 2, 0, sections.Data(vertices, sizeof(vertices)), none };
+        sections.Record(m3d::SECTION_MESHES, mesh);
+
+        const m3d::ActionRecord action = { sections.String("Walk"), 1.0f, 0, 1 };
+        sections.Record(m3d::SECTION_ACTIONS, action);
+        const m3d::ChannelRecord channel = { sections.String("bone"), Channel::POSITION, sections.Data(keyframes, sizeof(keyframes), misalignment) };
+        sections.Record(m3d::SECTION_CHANNELS, channel);
+        return sections;
+    }
+};
+
+// Where the data of the library is, in the mapped file or copied out of it
+bool testMini3dImporterInFile(const AssetLibrary* pLibrary, const AutoArray<char> &data) {
+    const char* pFile = pLibrary->mappedFile->GetData();
+    return !data.owner && data.array >= pFile && data.array + data.count <= pFile + pLibrary->mappedFile->GetSize();
+}
+
+// A version 1 file cut off in the vertex data loads what is there, a version 2 file
+// cut off in its table of contents fails
+bool testMini3dImporterTruncatedFile() {
+    TestMini3dImporterFile file = TestMini3dImporterFile::Mesh(3);
+    AssetLibrary* pLibrary = file.Load(file.bytes.size());
+    bool whole = pLibrary && pLibrary->meshes.count == 1 && pLibrary->meshes.array[0].vertexData.count == 36 && pLibrary->meshes.array[0].name == "Mesh";
+    delete pLibrary;
+
+    // The name, the vertex size and count and 5 of the 9 floats
+    pLibrary = file.Load(2 + 6 + 2 + 4 + 20);
+    bool truncated = pLibrary && pLibrary->meshes.count == 1 && pLibrary->meshes.array[0].vertexData.count == 20 &&
+                     pLibrary->meshes.array[0].indexData.count == 0 && pLibrary->armatures.count == 0 && pLibrary->scenes.count == 0;
+    delete pLibrary;
+
+    TestMini3dImporterFile header;
+    const uint32_t words[4] = { m3d::MAGIC, m3d::VERSION, m3d::SECTION_COUNT, 0 };
+    header.Bytes(words, sizeof(words));
+    pLibrary = header.Load(header.bytes.size());
+    bool failed = (pLibrary == 0);
+    delete pLibrary;
+
+    TestMini3dImporterFile::Remove();
+    return whole && truncated && failed;
+};
+
+// A version 2 file uses its names and aligned data in place in the mapped file
+bool testMini3dImporterVersion2() {
+    TestMini3dImporterFile file = TestMini3dImporterSections::MeshAndAction().File();
+    AssetLibrary* pLibrary = file.Load(file.bytes.size());
+    if (pLibrary == 0 || pLibrary->meshes.count != 1 || pLibrary->actions.count != 1 || pLibrary->armatures.count != 0 || pLibrary->scenes.count != 0) {
+        delete pLibrary;
+        TestMini3dImporterFile::Remove();
+        return false;
+    }
+
+    Mesh &mesh = pLibrary->meshes.array[0];
+    Action &action = pLibrary->actions.array[0];
+    Channel &channel = action.channels.array[0];
+    bool loaded = mesh.name == "Mesh" && mesh.vertexSizeInBytes == 12 && mesh.vertexData.count == 36 && ((float*)mesh.vertexData.array)[8] == 8 && mesh.indexData.count == 0 &&
+                  action.name == "Walk" && action.length == 1.0f && action.channels.count == 1 &&
+                  channel.boneName == "bone" && channel.type == Channel::POSITION && channel.animationData.count == 32 && ((float*)channel.animationData.array)[7] == 6;
+    bool inPlace = testMini3dImporterInFile(pLibrary, mesh.vertexData) && testMini3dImporterInFile(pLibrary, channel.animationData) &&
+                   mesh.name.array >= pLibrary->mappedFile->GetData() && mesh.name.array < pLibrary->mappedFile->GetData() + pLibrary->mappedFile->GetSize();
+    delete pLibrary;
+
+    TestMini3dImporterFile::Remove();
+    return loaded && inPlace;
+};
+
+// A file that starts with "M3D" and another version fails, it is not read as version 1
+bool testMini3dImporterBadMagic() {
+    TestMini3dImporterFile file = TestMini3dImporterSections::MeshAndAction().File();
+    file.bytes[3] = '9';
+    AssetLibrary* pLibrary = file.Load(file.bytes.size());
+    bool failed = (pLibrary == 0);
+    delete pLibrary;
+
+    TestMini3dImporterFile::Remove();
+    return failed;
+};
+
+// A section past the end of the file or at an offset that is not aligned fails
+bool testMini3dImporterSectionOutOfRange() {
+    const size_t offset = sizeof(m3d::Header) + offsetof(m3d::Section, offset);
+    TestMini3dImporterFile file = TestMini3dImporterSections::MeshAndAction().File();
+    uint64_t outside = (file.bytes.size() + m3d::ALIGNMENT) / m3d::ALIGNMENT * m3d::ALIGNMENT;
+    memcpy(&file.bytes[offset], &outside, sizeof(outside));
+    AssetLibrary* pLibrary = file.Load(file.bytes.size());
+    bool outsideFailed = (pLibrary == 0);
+    delete pLibrary;
+
+    file = TestMini3dImporterSections::MeshAndAction().File();
+    uint64_t misaligned;
+    memcpy(&misaligned, &file.bytes[offset], sizeof(misaligned));
+    misaligned += sizeof(float);
+    memcpy(&file.bytes[offset], &misaligned, sizeof(misaligned));
+    pLibrary = file.Load(file.bytes.size());
+    bool misalignedFailed = (pLibrary == 0);
+    delete pLibrary;
+
+    TestMini3dImporterFile::Remove();
+    return outsideFailed && misalignedFailed;
+};
+
+// Data that is not aligned for its floats is copied to the arena, aligned data in the
+// same file is still used in place
+bool testMini3dImporterMisalignedBlob() {
+    TestMini3dImporterFile file = TestMini3dImporterSections::MeshAndAction(2).File();
+    AssetLibrary* pLibrary = file.Load(file.bytes.size());
+    bool loaded = false;
+    if (pLibrary && pLibrary->actions.count == 1) {
+        const AutoArray<char> &keyframes = pLibrary->actions.array[0].channels.array[0].animationData;
+        loaded = !testMini3dImporterInFile(pLibrary, keyframes) && !keyframes.owner && (uintptr_t)keyframes.array % sizeof(float) == 0 &&
+                 keyframes.count == 32 && ((float*)keyframes.array)[5] == 4 && testMini3dImporterInFile(pLibrary, pLibrary->meshes.array[0].vertexData);
+    }
+    delete pLibrary;
+
+    TestMini3dImporterFile::Remove();
+    return loaded;
+};
+
+// A version 1 file holds what it copies and a block for its arrays and names in the
+// arena, not room for another copy of the file
+bool testMini3dImporterVersion1ArenaSize() {
+    TestMini3dImporterFile file = TestMini3dImporterFile::Mesh(100000);
+    AssetLibrary* pLibrary = file.Load(file.bytes.size());
+    bool loaded = pLibrary && pLibrary->meshes.count == 1 && pLibrary->meshes.array[0].vertexData.count == 100000 * 3 * sizeof(float) &&
+                  pLibrary->arena.GetSize() == pLibrary->meshes.array[0].vertexData.count + sizeof(float) + Arena::DEFAULT_BLOCK_SIZE;
+    delete pLibrary;
+
+    TestMini3dImporterFile::Remove();
+    return loaded;
+};
+
+// Deleting a library destroys its assets in place and then frees the arena and the
+// mapping. Data an application puts in a loaded asset is owned and freed with it, names
+// and data in the mapped file and the arena are not freed on their own. Leaks and double
+// frees show up under a leak checker.
+bool testMini3dImporterLibraryTeardown() {
+    TestMini3dImporterFile version1 = TestMini3dImporterFile::Mesh(3);
+    TestMini3dImporterFile version2 = TestMini3dImporterSections::MeshAndAction().File();
+    const TestMini3dImporterFile* files[2] = { &version1, &version2 };
+
+    for (unsigned int i = 0; i < 2; ++i) {
+        AssetLibrary* pLibrary = files[i]->Load(files[i]->bytes.size());
+        if (pLibrary == 0 || pLibrary->meshes.count != 1)
+            return false;
+
+        AutoArray<char> &indexData = pLibrary->meshes.array[0].indexData;
+        indexData.array = new char[6]();
+        indexData.count = 6;
+        indexData.owner = true;
+        delete pLibrary;
+    }
+
+    TestMini3dImporterFile::Remove();
+    return true;
+};
+
+// Reads past the end take what is left, and nothing once the end is reached
+bool testMini3dImporterReaderOutOfRange() {
+    char bytes[6] = { 1, 0, 2, 0, 0, 0 };
+    Reader reader = { bytes, bytes + sizeof(bytes) };
+
+    unsigned int size = 8;
+    if (ReadShort(reader) != 1 || reader.Take(size) != bytes + 2 || size != 4 || reader.pCursor != reader.pEnd)
+        return false;
+
+    size = 4;
+    return reader.Take(size) == reader.pEnd && size == 0 && ReadInt32(reader) == 0 && ReadFloat(reader) == 0;
+};
+
+struct TestMini3dImporterObject
+{
+    TestMini3dImporterObject()                                          { ++constructed; }
+    ~TestMini3dImporterObject()                                         { ++destroyed; }
+
+    static unsigned int constructed;
+    static unsigned int destroyed;
+};
+
+unsigned int TestMini3dImporterObject::constructed = 0;
+unsigned int TestMini3dImporterObject::destroyed = 0;
+
+// Arrays that do not own their memory leave it alone, object arrays destroy their
+// objects in place
+bool testMini3dImporterNonOwnerArrays() {
+    char chars[4] = { 'a', 'b', 'c', 0 };
+    {
+        AutoArray<char> array;
+        array.array = chars;
+        array.count = 3;
+        array.owner = false;
+    }
+
+    Arena arena;
+    TestMini3dImporterObject::constructed = TestMini3dImporterObject::destroyed = 0;
+    {
+        AutoObjectArray<TestMini3dImporterObject> objects;
+        objects.array = arena.New<TestMini3dImporterObject>(5);
+        objects.count = 5;
+        objects.owner = false;
+    }
+    bool inPlace = TestMini3dImporterObject::constructed == 5 && TestMini3dImporterObject::destroyed == 5;
+
+    {
+        AutoObjectArray<TestMini3dImporterObject> objects;
+        objects.array = new TestMini3dImporterObject[2];
+        objects.count = 2;
+    }
+    return inPlace && TestMini3dImporterObject::constructed == 7 && TestMini3dImporterObject::destroyed == 7 && strcmp(chars, "abc") == 0;
+};
+
+vector<pair<const char*, bool(*)()>> import_umini3dimporter = {
+    {"TruncatedFile", &testMini3dImporterTruncatedFile},
+    {"Version2", &testMini3dImporterVersion2},
+    {"BadMagic", &testMini3dImporterBadMagic},
+    {"SectionOutOfRange", &testMini3dImporterSectionOutOfRange},
+    {"MisalignedBlob", &testMini3dImporterMisalignedBlob},
+    {"Version1ArenaSize", &testMini3dImporterVersion1ArenaSize},
+    {"LibraryTeardown", &testMini3dImporterLibraryTeardown},
+    {"ReaderOutOfRange", &testMini3dImporterReaderOutOfRange},
+    {"NonOwnerArrays", &testMini3dImporterNonOwnerArrays} };
+
+#endif
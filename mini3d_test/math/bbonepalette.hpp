@@ -0,0 +1,77 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_BENCHMARK_MATH_BONEPALETTE
+#ifdef MINI3D_BENCHMARK_MATH_BONEPALETTE
+
+#include <vector>
+
+#include "../benchmark.hpp"
+#include "../../mini3d_math/bonepalette.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+// Reference is the per joint loop AnimationUtils::BoneTransformsToMatrices used
+// before: compose with the parent through Transform::operator * and call
+// Transform::ToMatrix. Both sides restore the local transforms every run.
+
+namespace {
+
+const unsigned int BENCHMARK_BONEPALETTE_JOINTS = 64;
+const unsigned int BENCHMARK_BONEPALETTE_SKELETONS = 64;
+
+void benchmarkBonePalette(const char* name, BonePalette::Layout layout)
+{
+    vector<Transform> local(BENCHMARK_BONEPALETTE_JOINTS), t(BENCHMARK_BONEPALETTE_JOINTS);
+    vector<int> parents(BENCHMARK_BONEPALETTE_JOINTS);
+    vector<float> m(BENCHMARK_BONEPALETTE_JOINTS * 16);
+
+    for (unsigned int i = 0; i < BENCHMARK_BONEPALETTE_JOINTS; ++i)
+    {
+        local[i] = Transform(Vec3(0.0f, 0.1f * i, 0.0f), Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.05f * i), 1.0f);
+        parents[i] = (int)(i + 1) / 2 - 1;
+    }
+
+    double ref = benchmarkNanoseconds([&]() {
+        for (unsigned int s = 0; s < BENCHMARK_BONEPALETTE_SKELETONS; ++s)
+        {
+            t = local;
+            for (unsigned int i = 0; i < BENCHMARK_BONEPALETTE_JOINTS; ++i)
+            {
+                if (parents[i] >= 0)
+                    t[i] = t[parents[i]] * t[i];
+                t[i].ToMatrix(&m[i * 16]);
+            }
+        }
+        benchmarkSink(m.back());
+    });
+
+    double ns = benchmarkNanoseconds([&]() {
+        for (unsigned int s = 0; s < BENCHMARK_BONEPALETTE_SKELETONS; ++s)
+        {
+            t = local;
+            BonePalette::Build(&m[0], &t[0], &parents[0], BENCHMARK_BONEPALETTE_JOINTS, layout);
+        }
+        benchmarkSink(m.back());
+    });
+
+    benchmarkReport(name, ref, ns, BENCHMARK_BONEPALETTE_JOINTS * BENCHMARK_BONEPALETTE_SKELETONS);
+}
+
+}
+
+void benchmarkBonePalette4x4() {
+    benchmarkBonePalette("Build 4x4 per joint", BonePalette::LAYOUT_4X4);
+}
+
+void benchmarkBonePalette3x4() {
+    benchmarkBonePalette("Build 3x4 per joint", BonePalette::LAYOUT_3X4);
+}
+
+vector<pair<const char*, void(*)()>> math_bbonepalette = {
+    {"Build4x4", &benchmarkBonePalette4x4},
+    {"Build3x4", &benchmarkBonePalette3x4} };
+
+#endif
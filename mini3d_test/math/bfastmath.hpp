@@ -0,0 +1,126 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_BENCHMARK_MATH_FASTMATH
+#ifdef MINI3D_BENCHMARK_MATH_FASTMATH
+
+#include <vector>
+#include <cmath>
+
+#include "../benchmark.hpp"
+#include "../../mini3d_math/fastmath.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+// Reference is the float C library function. Each benchmark also prints the largest
+// difference to the double precision result over the inputs, the error bounds in
+// fastmath.hpp come from these numbers.
+
+namespace {
+
+const unsigned int BENCHMARK_FASTMATH_COUNT = 4096;
+
+vector<float> benchmarkFastMathInput(float minimum, float maximum)
+{
+    vector<float> x(BENCHMARK_FASTMATH_COUNT);
+    for (unsigned int i = 0; i < x.size(); ++i)
+        x[i] = minimum + (maximum - minimum) * i / (x.size() - 1);
+    return x;
+}
+
+void benchmarkFastMathError(const char* name, const vector<float> &result, const vector<double> &exact, bool relative)
+{
+    double e = 0;
+    for (unsigned int i = 0; i < result.size(); ++i)
+    {
+        double d = fabs(result[i] - exact[i]) / (relative ? fabs(exact[i]) : 1.0);
+        e = (d > e) ? d : e;
+    }
+    printf("  %-32s max %s error: %.2g\n", name, relative ? "relative" : "absolute", e);
+}
+
+}
+
+void benchmarkFastMathSinCos() {
+    vector<float> x = benchmarkFastMathInput(-8192.0f, 8192.0f), s(x.size()), c(x.size());
+    vector<double> es(x.size()), ec(x.size());
+    for (unsigned int i = 0; i < x.size(); ++i)
+        es[i] = sin((double)x[i]), ec[i] = cos((double)x[i]);
+
+    double ref = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < x.size(); ++i) s[i] = sinf(x[i]), c[i] = cosf(x[i]); benchmarkSink(c.back()); });
+    double ns = benchmarkNanoseconds([&]() {
+        for (unsigned int i = 0; i < x.size(); i += 4)
+        {
+            simd::v128 vs, vc;
+            fast::SinCos(simd::Load(&x[i]), vs, vc);
+            simd::Store(&s[i], vs), simd::Store(&c[i], vc);
+        }
+        benchmarkSink(c.back());
+    });
+    benchmarkReport("SinCos", ref, ns, BENCHMARK_FASTMATH_COUNT);
+    benchmarkFastMathError("sin |x| <= 8192", s, es, false);
+    benchmarkFastMathError("cos |x| <= 8192", c, ec, false);
+}
+
+void benchmarkFastMathTan() {
+    vector<float> x = benchmarkFastMathInput(-1.5698f, 1.5698f), t(x.size());
+    vector<double> e(x.size());
+    for (unsigned int i = 0; i < x.size(); ++i)
+        e[i] = tan((double)x[i]);
+
+    double ref = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < x.size(); ++i) t[i] = tanf(x[i]); benchmarkSink(t.back()); });
+    double ns = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < x.size(); i += 4) simd::Store(&t[i], fast::Tan(simd::Load(&x[i]))); benchmarkSink(t.back()); });
+    benchmarkReport("Tan", ref, ns, BENCHMARK_FASTMATH_COUNT);
+    benchmarkFastMathError("tan |cos x| >= 1e-3", t, e, true);
+}
+
+void benchmarkFastMathRsqrt() {
+    vector<float> x = benchmarkFastMathInput(1e-3f, 1e3f), r(x.size());
+    vector<double> e(x.size());
+    for (unsigned int i = 0; i < x.size(); ++i)
+        e[i] = 1.0 / sqrt((double)x[i]);
+
+    double ref = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < x.size(); ++i) r[i] = 1.0f / sqrtf(x[i]); benchmarkSink(r.back()); });
+    double ns = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < x.size(); i += 4) simd::Store(&r[i], fast::Rsqrt(simd::Load(&x[i]))); benchmarkSink(r.back()); });
+    benchmarkReport("Rsqrt", ref, ns, BENCHMARK_FASTMATH_COUNT);
+    benchmarkFastMathError("rsqrt", r, e, true);
+}
+
+void benchmarkFastMathAcos() {
+    vector<float> x = benchmarkFastMathInput(-1.0f, 1.0f), r(x.size());
+    vector<double> e(x.size());
+    for (unsigned int i = 0; i < x.size(); ++i)
+        e[i] = acos((double)x[i]);
+
+    double ref = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < x.size(); ++i) r[i] = acosf(x[i]); benchmarkSink(r.back()); });
+    double ns = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < x.size(); i += 4) simd::Store(&r[i], fast::Acos(simd::Load(&x[i]))); benchmarkSink(r.back()); });
+    benchmarkReport("Acos", ref, ns, BENCHMARK_FASTMATH_COUNT);
+    benchmarkFastMathError("acos", r, e, false);
+}
+
+void benchmarkFastMathAtan2() {
+    // Points on a spiral cover all octants and a range of magnitudes
+    vector<float> a = benchmarkFastMathInput(-12.0f, 12.0f), x(a.size()), y(a.size()), r(a.size());
+    vector<double> e(a.size());
+    for (unsigned int i = 0; i < a.size(); ++i)
+    {
+        x[i] = (float)(cos(a[i]) * exp(a[i] * 0.5)), y[i] = (float)(sin(a[i]) * exp(a[i] * 0.5));
+        e[i] = atan2((double)y[i], (double)x[i]);
+    }
+
+    double ref = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < a.size(); ++i) r[i] = atan2f(y[i], x[i]); benchmarkSink(r.back()); });
+    double ns = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < a.size(); i += 4) simd::Store(&r[i], fast::Atan2(simd::Load(&y[i]), simd::Load(&x[i]))); benchmarkSink(r.back()); });
+    benchmarkReport("Atan2", ref, ns, BENCHMARK_FASTMATH_COUNT);
+    benchmarkFastMathError("atan2", r, e, false);
+}
+
+vector<pair<const char*, void(*)()>> math_bfastmath = {
+    {"SinCos", &benchmarkFastMathSinCos},
+    {"Tan", &benchmarkFastMathTan},
+    {"Rsqrt", &benchmarkFastMathRsqrt},
+    {"Acos", &benchmarkFastMathAcos},
+    {"Atan2", &benchmarkFastMathAtan2} };
+
+#endif
@@ -0,0 +1,86 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_BENCHMARK_MATH_QUAT
+#ifdef MINI3D_BENCHMARK_MATH_QUAT
+
+#include <vector>
+
+#include "../benchmark.hpp"
+#include "../../mini3d_math/quat.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+// Reference is the plain scalar code the classes used before the simd kernels.
+// Build with and without MINI3D_MATH_SIMD to compare the backends.
+
+namespace {
+
+struct RefQuat { float x, y, z, w; };
+struct RefVec3 { float x, y, z; };
+
+const unsigned int BENCHMARK_QUAT_COUNT = 4096;
+
+inline RefQuat refMul(const RefQuat &a, const RefQuat &q) 
+{ 
+    RefQuat r = {   a.w*q.x + a.x*q.w + a.y*q.z - a.z*q.y, 
+                    a.w*q.y - a.x*q.z + a.y*q.w + a.z*q.x, 
+                    a.w*q.z + a.x*q.y - a.y*q.x + a.z*q.w, 
+                    a.w*q.w - a.x*q.x - a.y*q.y - a.z*q.z }; 
+    return r; 
+}
+
+inline RefVec3 refCross(const RefVec3 &a, const RefVec3 &v) { RefVec3 r = { a.y*v.z - v.y*a.z, a.z*v.x - v.z*a.x, a.x*v.y - v.x*a.y }; return r; }
+
+inline RefVec3 refTransform(const RefQuat &q, const RefVec3 &v) 
+{ 
+    RefVec3 r = { q.x, q.y, q.z };
+    RefVec3 r2 = { r.x + r.x, r.y + r.y, r.z + r.z };
+    RefVec3 c = refCross(r, v);
+    RefVec3 a = { c.x + v.x * q.w, c.y + v.y * q.w, c.z + v.z * q.w };
+    RefVec3 b = refCross(r2, a);
+    RefVec3 o = { v.x + b.x, v.y + b.y, v.z + b.z };
+    return o;
+}
+
+vector<Quat> benchmarkQuats()
+{
+    vector<Quat> q(BENCHMARK_QUAT_COUNT);
+    for (unsigned int i = 0; i < q.size(); ++i)
+        q[i] = Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.001f * i);
+    return q;
+}
+
+}
+
+void benchmarkQuatMultiply() {
+    vector<Quat> q = benchmarkQuats();
+    vector<Quat> out(q.size());
+    RefQuat* rq = (RefQuat*)&q[0];
+    RefQuat* rout = (RefQuat*)&out[0];
+
+    double ref = benchmarkNanoseconds([&]() { for (unsigned int i = 1; i < q.size(); ++i) rout[i] = refMul(rq[i - 1], rq[i]); benchmarkSink(rout[q.size() - 1]); });
+    double ns = benchmarkNanoseconds([&]() { for (unsigned int i = 1; i < q.size(); ++i) out[i] = q[i - 1] * q[i]; benchmarkSink(out[q.size() - 1]); });
+    benchmarkReport("Quat * Quat", ref, ns, BENCHMARK_QUAT_COUNT - 1);
+}
+
+void benchmarkQuatTransform() {
+    vector<Quat> q = benchmarkQuats();
+    vector<Vec3> v(q.size(), Vec3(1.0f, 2.0f, 3.0f));
+    vector<Vec3> out(q.size());
+    RefQuat* rq = (RefQuat*)&q[0];
+    RefVec3* rv = (RefVec3*)&v[0];
+    RefVec3* rout = (RefVec3*)&out[0];
+
+    double ref = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < q.size(); ++i) rout[i] = refTransform(rq[i], rv[i]); benchmarkSink(rout[q.size() - 1]); });
+    double ns = benchmarkNanoseconds([&]() { for (unsigned int i = 0; i < q.size(); ++i) out[i] = q[i].Transform(v[i]); benchmarkSink(out[q.size() - 1]); });
+    benchmarkReport("Quat::Transform(Vec3)", ref, ns, BENCHMARK_QUAT_COUNT);
+}
+
+vector<pair<const char*, void(*)()>> math_bquat = {
+    {"Multiply", &benchmarkQuatMultiply},
+    {"Transform", &benchmarkQuatTransform} };
+
+#endif
@@ -0,0 +1,88 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_BENCHMARK_MATH_SKINNING
+#ifdef MINI3D_BENCHMARK_MATH_SKINNING
+
+#include <vector>
+
+#include "../benchmark.hpp"
+#include "../../mini3d_math/skinning.hpp"
+#include "../../mini3d_math/bonepalette.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+// Reference is linear blend skinning with the 3x4 BonePalette matrices: the 4
+// matrices of a vertex are weighted and summed, then applied to the position
+// and normal. Vertices are POSITION, NORMAL, TEXTURE, GROUPS.
+
+namespace {
+
+const unsigned int BENCHMARK_SKINNING_JOINTS = 64;
+const unsigned int BENCHMARK_SKINNING_VERTICES = 4096;
+const unsigned int BENCHMARK_SKINNING_FLOATS = 3 + 3 + 2 + 8;
+
+void benchmarkSkinningReference(float* pOut, const float* pIn, const float* pMatrices)
+{
+    for (unsigned int i = 0; i < BENCHMARK_SKINNING_VERTICES; ++i)
+    {
+        const float* v = pIn + i * BENCHMARK_SKINNING_FLOATS;
+        float* o = pOut + i * BENCHMARK_SKINNING_FLOATS;
+
+        float m[12] = { 0 };
+        for (unsigned int j = 0; j < 4; ++j)
+            for (unsigned int k = 0; k < 12; ++k)
+                m[k] += pMatrices[(unsigned int)v[8 + j] * 12 + k] * v[12 + j];
+
+        for (unsigned int r = 0; r < 3; ++r)
+        {
+            o[r] = m[r * 4] * v[0] + m[r * 4 + 1] * v[1] + m[r * 4 + 2] * v[2] + m[r * 4 + 3];
+            o[3 + r] = m[r * 4] * v[3] + m[r * 4 + 1] * v[4] + m[r * 4 + 2] * v[5];
+        }
+    }
+}
+
+}
+
+void benchmarkSkinningDualQuat()
+{
+    vector<Transform> t(BENCHMARK_SKINNING_JOINTS);
+    vector<DualQuat> d(BENCHMARK_SKINNING_JOINTS);
+    vector<float> s(BENCHMARK_SKINNING_JOINTS), m(BENCHMARK_SKINNING_JOINTS * 12);
+    vector<float> in(BENCHMARK_SKINNING_VERTICES * BENCHMARK_SKINNING_FLOATS), out(in.size());
+
+    for (unsigned int i = 0; i < BENCHMARK_SKINNING_JOINTS; ++i)
+        t[i] = Transform(Vec3(0.0f, 0.1f * i, 0.0f), Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.05f * i), 1.0f);
+
+    for (unsigned int i = 0; i < BENCHMARK_SKINNING_VERTICES; ++i)
+    {
+        float* v = &in[i * BENCHMARK_SKINNING_FLOATS];
+        v[0] = 0.01f * i, v[1] = 1.0f, v[2] = -0.5f, v[3] = 0.0f, v[4] = 0.6f, v[5] = 0.8f;
+        for (unsigned int j = 0; j < 4; ++j)
+            v[8 + j] = (float)((i * 7 + j * 13) % BENCHMARK_SKINNING_JOINTS), v[12 + j] = 0.4f - 0.1f * j;
+    }
+
+    BonePalette::ToMatrices(&m[0], &t[0], BENCHMARK_SKINNING_JOINTS, BonePalette::LAYOUT_3X4);
+    Skinning::DualQuatsFromTransforms(&d[0], &s[0], &t[0], BENCHMARK_SKINNING_JOINTS);
+    Skinning::Attribute attributes[] = { Skinning::POSITION, Skinning::NORMAL, Skinning::TEXTURE, Skinning::GROUPS };
+    Skinning::VertexLayout layout = Skinning::VertexLayout::FromAttributes(attributes, 4);
+
+    double ref = benchmarkNanoseconds([&]() {
+        benchmarkSkinningReference(&out[0], &in[0], &m[0]);
+        benchmarkSink(out.back());
+    });
+
+    double ns = benchmarkNanoseconds([&]() {
+        Skinning::SkinDualQuat(&out[0], &in[0], 0, BENCHMARK_SKINNING_VERTICES, layout, &d[0], 0);
+        benchmarkSink(out.back());
+    });
+
+    benchmarkReport("Skin per vertex", ref, ns, BENCHMARK_SKINNING_VERTICES);
+}
+
+vector<pair<const char*, void(*)()>> math_bskinning = {
+    {"SkinDualQuat", &benchmarkSkinningDualQuat} };
+
+#endif
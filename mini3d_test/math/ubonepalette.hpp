@@ -0,0 +1,58 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_MATH_BONEPALETTE
+#ifdef MINI3D_TEST_MATH_BONEPALETTE
+
+#include <vector>
+
+#include "../../mini3d_math/bonepalette.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+// Palettes must match composing with Transform::operator * and calling Transform::ToMatrix per joint
+
+const unsigned int TEST_BONEPALETTE_COUNT = 7;
+const int testBonePaletteParents[TEST_BONEPALETTE_COUNT] = { -1, 0, 1, 1, 0, -1, 5 };
+
+Transform testBonePaletteTransform(unsigned int i) {
+    return Transform(Vec3(0.5f * i, -1.0f, 2.0f + i), Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.3f * i), 1.0f + 0.1f * i);
+}
+
+bool testBonePaletteBuild(BonePalette::Layout layout) {
+    Transform t[TEST_BONEPALETTE_COUNT], expected[TEST_BONEPALETTE_COUNT];
+    for (unsigned int i = 0; i < TEST_BONEPALETTE_COUNT; ++i) {
+        t[i] = expected[i] = testBonePaletteTransform(i);
+        if (testBonePaletteParents[i] >= 0)
+            expected[i] = expected[testBonePaletteParents[i]] * expected[i];
+    }
+
+    float m[TEST_BONEPALETTE_COUNT * 16 + 1];
+    m[TEST_BONEPALETTE_COUNT * layout] = 42.0f;
+    BonePalette::Build(m, t, testBonePaletteParents, TEST_BONEPALETTE_COUNT, layout);
+
+    for (unsigned int i = 0; i < TEST_BONEPALETTE_COUNT; ++i) {
+        float e[16];
+        expected[i].ToMatrix(e);
+        if (!testNearEquals(e, m + i * layout, layout, 1e-5f))
+            return false;
+    }
+    return m[TEST_BONEPALETTE_COUNT * layout] == 42.0f;
+}
+
+bool testBonePaletteBuild4x4() {
+    return testBonePaletteBuild(BonePalette::LAYOUT_4X4);
+};
+
+bool testBonePaletteBuild3x4() {
+    return testBonePaletteBuild(BonePalette::LAYOUT_3X4);
+};
+
+vector<pair<const char*, bool(*)()>> math_ubonepalette = {
+    {"Build4x4", &testBonePaletteBuild4x4},
+    {"Build3x4", &testBonePaletteBuild3x4} };
+
+#endif
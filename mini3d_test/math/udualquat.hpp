@@ -0,0 +1,48 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_MATH_DUALQUAT
+#ifdef MINI3D_TEST_MATH_DUALQUAT
+
+#include <vector>
+#include <cmath>
+
+#include "../../mini3d_math/dualquat.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+Transform testDualQuatTransform(float s) {
+    return Transform(Vec3(1.0f + s, -2.0f, 0.5f * s), Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, s), 1.0f);
+}
+
+bool testDualQuatFromTransform() {
+    Transform t = testDualQuatTransform(0.7f);
+    DualQuat d = DualQuat::FromTransform(t);
+    Transform r = d.ToTransform();
+    Vec3 v(0.3f, -1.2f, 2.5f);
+    return testNearEquals(r.pos, t.pos, 1e-6f) && r.rot == t.rot && testNearEquals(d * v, t * v, 1e-5f);
+};
+
+bool testDualQuatMultiply() {
+    Transform a = testDualQuatTransform(0.4f), b = testDualQuatTransform(-1.9f);
+    DualQuat d = DualQuat::FromTransform(a) * DualQuat::FromTransform(b);
+    Vec3 v(0.3f, -1.2f, 2.5f);
+    return testNearEquals(d * v, (a * b) * v, 1e-5f);
+};
+
+bool testDualQuatNormalize() {
+    Transform t = testDualQuatTransform(2.1f);
+    DualQuat d = (DualQuat::FromTransform(t) * 3.0f).Normalized();
+    Vec3 v(0.3f, -1.2f, 2.5f);
+    return testNearEquals(d * v, t * v, 1e-5f);
+};
+
+vector<pair<const char*, bool(*)()>> math_udualquat = {
+    {"FromTransform", &testDualQuatFromTransform},
+    {"Multiply", &testDualQuatMultiply},
+    {"Normalize", &testDualQuatNormalize} };
+
+#endif
@@ -0,0 +1,66 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_MATH_FASTMATH
+#ifdef MINI3D_TEST_MATH_FASTMATH
+
+#include <vector>
+#include <cmath>
+
+#include "../../mini3d_math/fastmath.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+// Checks the error bounds documented in fastmath.hpp
+
+bool testFastMathSinCos() {
+    for (float x = -8192.0f; x <= 8192.0f; x += 0.37f) {
+        float s, c;
+        fast::SinCos(x, s, c);
+        if (fabs(s - sin((double)x)) > 4e-7 || fabs(c - cos((double)x)) > 4e-7)
+            return false;
+    }
+    return true;
+};
+
+bool testFastMathTan() {
+    for (float x = -1.57f; x <= 1.57f; x += 0.001f)
+        if (fabs(fast::Tan(x) - tan((double)x)) > 3e-7 / cos((double)x) * fabs(tan((double)x)))
+            return false;
+    return true;
+};
+
+bool testFastMathRsqrt() {
+    for (float x = 1e-3f; x <= 1e3f; x *= 1.01f)
+        if (fabs(fast::Rsqrt(x) * sqrt((double)x) - 1.0) > 3e-7)
+            return false;
+    return true;
+};
+
+bool testFastMathAcos() {
+    for (float x = -1.0f; x <= 1.0f; x += 0.0001f)
+        if (fabs(fast::Acos(x) - acos((double)x)) > 5e-7)
+            return false;
+    return fast::Acos(1.0f) == 0.0f;
+};
+
+bool testFastMathAtan2() {
+    for (float a = -3.14f; a <= 3.14f; a += 0.001f)
+        for (float r = 1e-3f; r < 1e3f; r *= 10.0f) {
+            float x = (float)(r * cos(a)), y = (float)(r * sin(a));
+            if (fabs(fast::Atan2(y, x) - atan2((double)y, (double)x)) > 6e-7)
+                return false;
+        }
+    return fast::Atan2(0.0f, 0.0f) == 0.0f && fast::Atan2(0.0f, -1.0f) > 3.14159f && fast::Atan2(-1.0f, 0.0f) < -1.57079f;
+};
+
+vector<pair<const char*, bool(*)()>> math_ufastmath = {
+    {"SinCos", &testFastMathSinCos},
+    {"Tan", &testFastMathTan},
+    {"Rsqrt", &testFastMathRsqrt},
+    {"Acos", &testFastMathAcos},
+    {"Atan2", &testFastMathAtan2} };
+
+#endif
@@ -0,0 +1,61 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_MATH_FRUSTUM
+#ifdef MINI3D_TEST_MATH_FRUSTUM
+
+#include <vector>
+
+#include "../../mini3d_math/frustum.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+// Camera at (0, -10, 0) looking down the positive y axis
+Frustum testFrustumFrustum() {
+    Transform view = Transform::LookAtRH(Vec3(0.0f, -10.0f, 0.0f), Vec3(0.0f), Vec3(0.0f, 0.0f, 1.0f));
+    return Frustum(view.ToViewProjectionMatrix(1.0f, 1.0f, 0.1f, 100.0f));
+}
+
+bool testFrustumIntersects() {
+    Frustum f = testFrustumFrustum();
+    return f.Intersects(BoundingSphere(Vec3(0.0f), 1.0f)) && 
+           !f.Intersects(BoundingSphere(Vec3(0.0f, -20.0f, 0.0f), 1.0f)) && 
+           !f.Intersects(BoundingSphere(Vec3(0.0f, 200.0f, 0.0f), 1.0f)) &&
+           f.Intersects(AABB(Vec3(-1.0f), Vec3(1.0f))) &&
+           !f.Intersects(AABB(Vec3(50.0f, -1.0f, -1.0f), Vec3(52.0f, 1.0f, 1.0f)));
+};
+
+bool testFrustumCull() {
+    Frustum f = testFrustumFrustum();
+    vector<BoundingSphere> spheres;
+    vector<AABB> boxes;
+    for (int x = -20; x <= 20; x += 3)
+        for (int y = -20; y <= 120; y += 7) {
+            spheres.push_back(BoundingSphere(Vec3((float)x, (float)y, 0.5f * x), 1.5f));
+            boxes.push_back(AABB(Vec3((float)x, (float)y, 0.5f * x), Vec3(x + 1.0f, y + 2.0f, 0.5f * x + 1.0f)));
+        }
+
+    vector<unsigned int> visible(spheres.size());
+    unsigned int count = f.Cull(&spheres[0], (unsigned int)spheres.size(), &visible[0]);
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < spheres.size(); ++i)
+        if (f.Intersects(spheres[i]) && (n >= count || visible[n++] != i))
+            return false;
+    if (n != count || count == 0 || count == spheres.size())
+        return false;
+
+    count = f.Cull(&boxes[0], (unsigned int)boxes.size(), &visible[0]);
+    n = 0;
+    for (unsigned int i = 0; i < boxes.size(); ++i)
+        if (f.Intersects(boxes[i]) && (n >= count || visible[n++] != i))
+            return false;
+    return n == count && count != 0;
+};
+
+vector<pair<const char*, bool(*)()>> math_ufrustum = {
+    {"Intersects", &testFrustumIntersects},
+    {"Cull", &testFrustumCull} };
+
+#endif
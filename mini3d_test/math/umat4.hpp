@@ -0,0 +1,61 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_MATH_MAT4
+#ifdef MINI3D_TEST_MATH_MAT4
+
+#include <vector>
+
+#include "../../mini3d_math/transform.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+Mat4 testMat4Matrix() {
+    return Mat4(2,0,1,3, 1,3,0,-1, 0,1,4,2, 1,0,0,1);
+}
+
+bool testMat4Multiply() {
+    Mat4 a = testMat4Matrix(), b = a.Transposed(), r;
+    for (unsigned int i = 0; i < 4; ++i)
+        for (unsigned int j = 0; j < 4; ++j)
+            r.m[i * 4 + j] = a.m[i * 4] * b.m[j] + a.m[i * 4 + 1] * b.m[4 + j] + a.m[i * 4 + 2] * b.m[8 + j] + a.m[i * 4 + 3] * b.m[12 + j];
+    return a * b == r && a * Mat4::Identity() == a;
+};
+
+bool testMat4Inverse() {
+    Mat4 a = testMat4Matrix();
+    Mat4 singular(1,2,3,4, 2,4,6,8, 0,1,0,1, 1,0,0,1);
+    return testNearEquals(a * a.Inverted(), Mat4::Identity(), 1e-5f) && !singular.Invert();
+};
+
+bool testMat4InverseAffine() {
+    Transform t(Vec3(1.0f, -2.0f, 3.0f), Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 1.3f), 2.0f);
+    Mat4 m = t.ToMatrix();
+    return testNearEquals(m.InvertedAffine(), m.Inverted(), 1e-5f) && testNearEquals(m * m.InvertedAffine(), Mat4::Identity(), 1e-5f);
+};
+
+bool testMat4Transform() {
+    Transform t(Vec3(1.0f, -2.0f, 3.0f), Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 1.3f), 1.0f);
+    Vec3 p(0.5f, 4.0f, -1.0f);
+    Vec3 a = t.ToMatrix() * p, b = t * p;
+    Vec4 v = t.ToMatrix() * Vec4(p.x, p.y, p.z, 1.0f);
+    return testNearEquals(a, b, 1e-5f) && testNearEquals(Vec3(v.x, v.y, v.z), a, 1e-5f) && v.w == 1.0f;
+};
+
+bool testMat4Perspective() {
+    Transform view = Transform::LookAtRH(Vec3(3.0f, 4.0f, 5.0f), Vec3(0.0f), Vec3(0.0f, 0.0f, 1.0f));
+    Mat4 expected = view.ToViewProjectionMatrix(1.0f, 1.5f, 0.1f, 100.0f);
+    return testNearEquals(Mat4::PerspectiveRH(1.0f, 1.5f, 0.1f, 100.0f) * view.ToMatrix(), expected, 1e-5f);
+};
+
+vector<pair<const char*, bool(*)()>> math_umat4 = {
+    {"Multiply", &testMat4Multiply},
+    {"Inverse", &testMat4Inverse},
+    {"InverseAffine", &testMat4InverseAffine},
+    {"Transform", &testMat4Transform},
+    {"Perspective", &testMat4Perspective} };
+
+#endif
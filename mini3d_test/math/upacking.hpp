@@ -0,0 +1,114 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_MATH_PACKING
+#ifdef MINI3D_TEST_MATH_PACKING
+
+#include <vector>
+#include <cmath>
+
+#include "../../mini3d_math/packing.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+bool testPackingHalfScalar() {
+    const float f[] = { 0.0f, -0.0f, 1.0f, -2.0f, 65504.0f, 65520.0f, 5.96046448e-08f, 6.10351562e-05f, 1.0f + 1.0f / 2048.0f, INFINITY };
+    const uint16_t h[] = { 0x0000, 0x8000, 0x3c00, 0xc000, 0x7bff, 0x7c00, 0x0001, 0x0400, 0x3c00, 0x7c00 };
+    for (unsigned int i = 0; i < sizeof(h) / sizeof(h[0]); ++i)
+        if (FloatToHalf(f[i]) != h[i])
+            return false;
+
+    // Every finite half survives the round trip
+    for (uint32_t i = 0; i < 0x10000; ++i)
+        if ((i & 0x7c00) != 0x7c00 && FloatToHalf(HalfToFloat((uint16_t)i)) != i)
+            return false;
+    return isnan(HalfToFloat(0x7e00)) && HalfToFloat(0xfc00) == -INFINITY;
+};
+
+bool testPackingHalfs() {
+    const unsigned int count = 4099;
+    vector<float> f(count), r(count);
+    vector<uint16_t> h(count);
+    for (unsigned int i = 0; i < count; ++i)
+        f[i] = (i - 2000.0f) * 0.37f;
+
+    Packing::FloatsToHalfs(&h[0], &f[0], count);
+    Packing::HalfsToFloats(&r[0], &h[0], count);
+    for (unsigned int i = 0; i < count; ++i)
+        if (h[i] != FloatToHalf(f[i]) || fabs(r[i] - f[i]) > fabs(f[i]) / 2048.0f)
+            return false;
+    return true;
+};
+
+bool testPackingSnormUnorm() {
+    const unsigned int count = 7;
+    const float f[count] = { -2.0f, -1.0f, -0.5f, 0.0f, 0.25f, 1.0f, 3.0f };
+    const int16_t s[count] = { -32767, -32767, -16384, 0, 8192, 32767, 32767 };
+    const uint8_t u[count] = { 0, 0, 0, 0, 64, 255, 255 };
+
+    int16_t ps[count];
+    uint8_t pu[count];
+    float rs[count], ru[count];
+    Packing::FloatsToSnorm16(ps, f, count);
+    Packing::FloatsToUnorm8(pu, f, count);
+    Packing::Snorm16ToFloats(rs, ps, count);
+    Packing::Unorm8ToFloats(ru, pu, count);
+
+    for (unsigned int i = 0; i < count; ++i) {
+        if (abs(ps[i] - s[i]) > 1 || pu[i] != u[i])
+            return false;
+        if (fabs(rs[i] - fmin(fmax(f[i], -1.0f), 1.0f)) > 1.0f / 32767.0f || fabs(ru[i] - fmin(fmax(f[i], 0.0f), 1.0f)) > 0.5f / 255.0f)
+            return false;
+    }
+
+    int16_t minimum = -32768;
+    Packing::Snorm16ToFloats(rs, &minimum, 1);
+    return rs[0] == -1.0f;
+};
+
+bool testPackingOctahedral() {
+    const unsigned int count = 1001;
+    vector<float> n(count * 3), r(count * 3);
+    vector<int16_t> o(count * 2);
+
+    // Spiral over the sphere, including both poles
+    for (unsigned int i = 0; i < count; ++i) {
+        float z = 1.0f - 2.0f * i / (count - 1);
+        float a = 2.39996323f * i, s = sqrt(fmax(0.0f, 1.0f - z * z));
+        n[i * 3] = s * cos(a), n[i * 3 + 1] = s * sin(a), n[i * 3 + 2] = z;
+    }
+
+    Packing::NormalsToOctahedral(&o[0], &n[0], count);
+    Packing::OctahedralToNormals(&r[0], &o[0], count);
+    for (unsigned int i = 0; i < count * 3; ++i)
+        if (fabs(r[i] - n[i]) > 1e-4f)
+            return false;
+    return true;
+};
+
+bool testPacking1010102() {
+    const unsigned int count = 5;
+    const float v[count * 4] = { 0, 0, 0, 0,  1, 1, 1, 1,  0.5f, 0.25f, 0.75f, 0.34f,  -1, 2, 0.1f, 0.9f,  0.001f, 0.999f, 0.3f, 0.6f };
+    uint32_t p[count];
+    float r[count * 4];
+    Packing::Vec4sToUnorm1010102(p, v, count);
+    Packing::Unorm1010102ToVec4s(r, p, count);
+
+    if (p[0] != 0 || p[1] != 0xffffffff || p[2] != (512u | (256u << 10) | (767u << 20) | (1u << 30)))
+        return false;
+    for (unsigned int i = 0; i < count * 4; ++i)
+        if (fabs(r[i] - fmin(fmax(v[i], 0.0f), 1.0f)) > ((i % 4 == 3) ? 0.5f / 3.0f : 0.5f / 1023.0f))
+            return false;
+    return true;
+};
+
+vector<pair<const char*, bool(*)()>> math_upacking = {
+    {"HalfScalar", &testPackingHalfScalar},
+    {"Halfs", &testPackingHalfs},
+    {"SnormUnorm", &testPackingSnormUnorm},
+    {"Octahedral", &testPackingOctahedral},
+    {"1010102", &testPacking1010102} };
+
+#endif
@@ -0,0 +1,51 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_MATH_QUAT
+#ifdef MINI3D_TEST_MATH_QUAT
+
+#include <vector>
+
+#include "../../mini3d_math/quat.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+// The SIMD backend must match the plain scalar formulas. They give the same bits
+// unless the compiler contracts either side into FMA, so compare with a tolerance.
+
+bool testQuatMultiply() {
+    Quat a = Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 1.1f);
+    Quat b = Quat::FromAxisAngle(-0.8f, 0.6f, 0.0f, 0.3f);
+    Quat r( a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y, 
+            a.w*b.y - a.x*b.z + a.y*b.w + a.z*b.x, 
+            a.w*b.z + a.x*b.y - a.y*b.x + a.z*b.w, 
+            a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z);
+    return testNearEquals(a * b, r, 1e-6f);
+};
+
+bool testQuatTransform() {
+    Quat q = Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 2.5f);
+    Vec3 v(1.5f, -2.0f, 0.25f);
+    Vec3 r(q.x, q.y, q.z);
+    Vec3 c1(r.y*v.z - v.y*r.z + v.x*q.w, r.z*v.x - v.z*r.x + v.y*q.w, r.x*v.y - v.x*r.y + v.z*q.w);
+    Vec3 r2 = r + r;
+    Vec3 expected(v.x + (r2.y*c1.z - c1.y*r2.z), v.y + (r2.z*c1.x - c1.z*r2.x), v.z + (r2.x*c1.y - c1.x*r2.y));
+    Vec4 v4 = q.Transform(Vec4(v.x, v.y, v.z, 7.0f));
+    return testNearEquals(q.Transform(v), expected, 1e-5f) && testNearEquals(v4, Vec4(expected.x, expected.y, expected.z, 7.0f), 1e-5f);
+};
+
+bool testQuatNormalize() {
+    Quat q(1.0f, 2.0f, 3.0f, 4.0f);
+    float s = sqrt(q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w);
+    return testNearEquals(q.Normalized(), Quat(q.x / s, q.y / s, q.z / s, q.w / s), 1e-6f) && Quat(0.0f).Normalized() == Quat(0,0,0,1);
+};
+
+vector<pair<const char*, bool(*)()>> math_uquat = {
+    {"Multiply", &testQuatMultiply},
+    {"Transform", &testQuatTransform},
+    {"Normalize", &testQuatNormalize} };
+
+#endif
@@ -0,0 +1,91 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_MATH_QUATBATCH
+#ifdef MINI3D_TEST_MATH_QUATBATCH
+
+#include <vector>
+#include <cmath>
+
+#include "../../mini3d_math/quatbatch.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+const unsigned int TEST_QUATBATCH_COUNT = 11;
+
+void testQuatBatchInput(Quat* a, Quat* b, float* t) {
+    for (unsigned int i = 0; i < TEST_QUATBATCH_COUNT; ++i) {
+        a[i] = Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.4f * i);
+        b[i] = Quat::FromAxisAngle(-0.8f, 0.6f, 0.0f, 3.0f - 0.5f * i);
+        t[i] = i / (float)(TEST_QUATBATCH_COUNT - 1);
+    }
+}
+
+bool testQuatBatchNormalize() {
+    Quat q[TEST_QUATBATCH_COUNT];
+    for (unsigned int i = 0; i < TEST_QUATBATCH_COUNT; ++i)
+        q[i] = Quat(1.0f + i, -2.0f, 0.5f * i, 3.0f);
+    QuatBatch::Normalize(q, TEST_QUATBATCH_COUNT);
+    for (unsigned int i = 0; i < TEST_QUATBATCH_COUNT; ++i)
+        if (!testNearEquals(q[i], Quat(1.0f + i, -2.0f, 0.5f * i, 3.0f).Normalized(), 1e-6f))
+            return false;
+    return true;
+};
+
+bool testQuatBatchMultiply() {
+    Quat a[TEST_QUATBATCH_COUNT], b[TEST_QUATBATCH_COUNT], r[TEST_QUATBATCH_COUNT];
+    float t[TEST_QUATBATCH_COUNT];
+    testQuatBatchInput(a, b, t);
+    QuatBatch::Multiply(r, a, b, TEST_QUATBATCH_COUNT);
+    for (unsigned int i = 0; i < TEST_QUATBATCH_COUNT; ++i)
+        if (!testNearEquals(r[i], a[i] * b[i], 1e-6f))
+            return false;
+
+    // In place, with a count that is a multiple of four and no tail
+    QuatBatch::Multiply(a, a, b, 8);
+    for (unsigned int i = 0; i < 8; ++i)
+        if (!testNearEquals(a[i], r[i], 1e-6f))
+            return false;
+    return true;
+};
+
+bool testQuatBatchNlerp() {
+    Quat a[TEST_QUATBATCH_COUNT], b[TEST_QUATBATCH_COUNT], r[TEST_QUATBATCH_COUNT];
+    float t[TEST_QUATBATCH_COUNT];
+    testQuatBatchInput(a, b, t);
+    QuatBatch::Nlerp(r, a, b, t, TEST_QUATBATCH_COUNT);
+    for (unsigned int i = 0; i < TEST_QUATBATCH_COUNT; ++i) {
+        Quat bi = (a[i].x*b[i].x + a[i].y*b[i].y + a[i].z*b[i].z + a[i].w*b[i].w < 0) ? -b[i] : b[i];
+        if (!testNearEquals(r[i], (a[i] * (1 - t[i]) + bi * t[i]).Normalized(), 1e-6f))
+            return false;
+    }
+    return true;
+};
+
+bool testQuatBatchSlerp() {
+    Quat a[TEST_QUATBATCH_COUNT], b[TEST_QUATBATCH_COUNT], r[TEST_QUATBATCH_COUNT];
+    float t[TEST_QUATBATCH_COUNT];
+    testQuatBatchInput(a, b, t);
+    QuatBatch::Slerp(r, a, b, t, TEST_QUATBATCH_COUNT);
+    for (unsigned int i = 0; i < TEST_QUATBATCH_COUNT; ++i) {
+        // Reference slerp in double precision
+        double d = a[i].x*b[i].x + a[i].y*b[i].y + a[i].z*b[i].z + a[i].w*b[i].w;
+        Quat bi = (d < 0) ? -b[i] : b[i];
+        double theta = acos(fabs(d));
+        double wa = sin((1 - t[i]) * theta) / sin(theta), wb = sin(t[i] * theta) / sin(theta);
+        if (!testNearEquals(r[i], a[i] * (float)wa + bi * (float)wb, 5e-5f))
+            return false;
+    }
+    return true;
+};
+
+vector<pair<const char*, bool(*)()>> math_uquatbatch = {
+    {"Normalize", &testQuatBatchNormalize},
+    {"Multiply", &testQuatBatchMultiply},
+    {"Nlerp", &testQuatBatchNlerp},
+    {"Slerp", &testQuatBatchSlerp} };
+
+#endif
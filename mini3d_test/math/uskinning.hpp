@@ -0,0 +1,99 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_MATH_SKINNING
+#ifdef MINI3D_TEST_MATH_SKINNING
+
+#include <vector>
+#include <cmath>
+
+#include "../../mini3d_math/skinning.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+// Vertices are POSITION, NORMAL, TEXTURE, GROUPS like the default export_m3d.py output with groups
+
+const unsigned int TEST_SKINNING_JOINTS = 3;
+const unsigned int TEST_SKINNING_FLOATS = 3 + 3 + 2 + 8;
+
+Skinning::VertexLayout testSkinningLayout() {
+    const Skinning::Attribute attributes[] = { Skinning::POSITION, Skinning::NORMAL, Skinning::TEXTURE, Skinning::GROUPS };
+    return Skinning::VertexLayout::FromAttributes(attributes, 4);
+}
+
+void testSkinningJoints(Transform* t, DualQuat* d, float* s) {
+    for (unsigned int i = 0; i < TEST_SKINNING_JOINTS; ++i)
+        t[i] = Transform(Vec3(1.0f * i, -2.0f, 0.5f), Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.9f * i + 0.2f), 1.0f + 0.25f * i);
+    Skinning::DualQuatsFromTransforms(d, s, t, TEST_SKINNING_JOINTS);
+}
+
+void testSkinningVertex(float* v, float g0, float g1, float w0, float w1) {
+    const float vertex[TEST_SKINNING_FLOATS] = { 0.3f, -1.2f, 2.5f, 0.0f, 0.6f, 0.8f, 0.25f, 0.75f, g0, g1, 0.0f, 0.0f, w0, w1, 0.0f, 0.0f };
+    for (unsigned int i = 0; i < TEST_SKINNING_FLOATS; ++i)
+        v[i] = vertex[i];
+}
+
+bool testSkinningLayoutOffsets() {
+    Skinning::VertexLayout layout = testSkinningLayout();
+    return layout.stride == TEST_SKINNING_FLOATS * 4 && layout.position == 0 && layout.normal == 12 && layout.groups == 32;
+};
+
+bool testSkinningSingleJoint() {
+    Transform t[TEST_SKINNING_JOINTS];
+    DualQuat d[TEST_SKINNING_JOINTS];
+    float s[TEST_SKINNING_JOINTS];
+    testSkinningJoints(t, d, s);
+
+    float in[TEST_SKINNING_JOINTS * TEST_SKINNING_FLOATS], out[TEST_SKINNING_JOINTS * TEST_SKINNING_FLOATS];
+    for (unsigned int i = 0; i < TEST_SKINNING_JOINTS; ++i) {
+        testSkinningVertex(in + i * TEST_SKINNING_FLOATS, (float)i, 0.0f, 1.0f, 0.0f);
+        testSkinningVertex(out + i * TEST_SKINNING_FLOATS, 0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    Skinning::SkinDualQuat(out, in, 0, TEST_SKINNING_JOINTS, testSkinningLayout(), d, s);
+
+    for (unsigned int i = 0; i < TEST_SKINNING_JOINTS; ++i) {
+        const float* v = out + i * TEST_SKINNING_FLOATS;
+        if (!testNearEquals(Vec3(v), t[i] * Vec3(in), 1e-5f) || !testNearEquals(Vec3(v + 3), t[i].rot.Transform(Vec3(in + 3)), 1e-5f))
+            return false;
+
+        // TEXTURE and GROUPS are not written
+        if (v[6] != 0.25f || v[8] != 0.0f)
+            return false;
+    }
+    return true;
+};
+
+bool testSkinningBlend() {
+    Transform t[TEST_SKINNING_JOINTS];
+    DualQuat d[TEST_SKINNING_JOINTS];
+    float s[TEST_SKINNING_JOINTS];
+    testSkinningJoints(t, d, s);
+
+    // A joint and its negated dual quaternion are the same transform and must blend as such
+    d[2] = d[1] * -1.0f;
+    t[2] = t[1];
+    s[2] = s[1];
+
+    float v[TEST_SKINNING_FLOATS];
+    testSkinningVertex(v, 1.0f, 2.0f, 0.3f, 0.7f);
+    Skinning::SkinDualQuat(v, v, 0, 1, testSkinningLayout(), d, s);
+    if (!testNearEquals(Vec3(v), t[1] * Vec3(0.3f, -1.2f, 2.5f), 1e-5f))
+        return false;
+
+    // Halfway between two joints the rotation is halfway too
+    testSkinningVertex(v, 0.0f, 1.0f, 0.5f, 0.5f);
+    Skinning::SkinDualQuat(v, v, 0, 1, testSkinningLayout(), d, 0);
+    Quat half = Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.65f);
+    return testNearEquals(Vec3(v + 3), half.Transform(Vec3(0.0f, 0.6f, 0.8f)), 1e-5f);
+};
+
+vector<pair<const char*, bool(*)()>> math_uskinning = {
+    {"Layout", &testSkinningLayoutOffsets},
+    {"SingleJoint", &testSkinningSingleJoint},
+    {"Blend", &testSkinningBlend} };
+
+#endif
@@ -0,0 +1,75 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_MATH_TRANSFORMBATCH
+#ifdef MINI3D_TEST_MATH_TRANSFORMBATCH
+
+#include <vector>
+
+#include "../../mini3d_math/transformbatch.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+// Batch results must match the per object Transform functions
+
+Transform testTransformBatchTransform(unsigned int i) {
+    return Transform(Vec3(0.5f * i, -1.0f, 2.0f + i), Quat::FromAxisAngle(0.267f, 0.535f, 0.802f, 0.3f * i), 1.0f + 0.1f * i);
+}
+
+bool testTransformBatchCompose() {
+    const unsigned int count = 7;
+    TransformBatch a(count), b(count), out(count);
+    for (unsigned int i = 0; i < count; ++i) {
+        a.Set(i, testTransformBatchTransform(i));
+        b.Set(i, testTransformBatchTransform(count - i));
+    }
+    TransformBatch::Compose(out, a, b);
+    for (unsigned int i = 0; i < count; ++i) {
+        Transform t = testTransformBatchTransform(i) * testTransformBatchTransform(count - i);
+        Transform r = out.Get(i);
+        if (!testNearEquals(r, t, 1e-5f))
+            return false;
+    }
+    return true;
+};
+
+bool testTransformBatchToMatrices() {
+    const unsigned int count = 5;
+    TransformBatch batch(count);
+    for (unsigned int i = 0; i < count; ++i)
+        batch.Set(i, testTransformBatchTransform(i));
+    float m[count][16];
+    batch.ToMatrices(m);
+    for (unsigned int i = 0; i < count; ++i) {
+        float expected[16];
+        testTransformBatchTransform(i).ToMatrix(expected);
+        if (!testNearEquals(expected, m[i], 16, 1e-5f))
+            return false;
+    }
+    return true;
+};
+
+bool testTransformBatchTransformPoints() {
+    const unsigned int count = 6;
+    TransformBatch batch(count);
+    Vec3 in[count], out[count];
+    for (unsigned int i = 0; i < count; ++i) {
+        batch.Set(i, testTransformBatchTransform(i));
+        in[i] = Vec3(1.0f * i, 2.0f, -3.0f);
+    }
+    batch.TransformPoints(out, in);
+    for (unsigned int i = 0; i < count; ++i)
+        if (!testNearEquals(out[i], testTransformBatchTransform(i) * in[i], 1e-5f))
+            return false;
+    return true;
+};
+
+vector<pair<const char*, bool(*)()>> math_utransformbatch = {
+    {"Compose", &testTransformBatchCompose},
+    {"ToMatrices", &testTransformBatchToMatrices},
+    {"TransformPoints", &testTransformBatchTransformPoints} };
+
+#endif
@@ -0,0 +1,70 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#define MINI3D_TEST_MATH_VECN
+#ifdef MINI3D_TEST_MATH_VECN
+
+#include <vector>
+
+#include "../../mini3d_math/vec3.hpp"
+#include "../../mini3d_math/vec4.hpp"
+#include "../../mini3d_animation/track.hpp"
+#include "../testutils.hpp"
+
+using namespace mini3d::math;
+using namespace std;
+
+bool testVecNConstexpr() {
+    static_assert(sizeof(Vec3) == 3 * sizeof(float) && sizeof(VecN<float, 5>) == 5 * sizeof(float), "VecN must not be padded");
+    constexpr Vec3 v(1.0f, 2.0f, 3.0f);
+    constexpr VecN<float, 5> w(1, 2, 3, 4, 5);
+    static_assert(v.z == 3.0f && w.e[4] == 5.0f, "VecN must be constructible in constant expressions");
+    return true;
+};
+
+bool testVecNArithmetic() {
+    VecN<float, 5> a(1, 2, 3, 4, 5), b(5.0f);
+    return (a + b) * 2.0f == VecN<float, 5>(12, 14, 16, 18, 20) && a.Dot(b) == 75.0f && (b - a)[4] == 0.0f;
+};
+
+bool testVecNCross() {
+    return Vec3(1, 0, 0).Cross(Vec3(0, 1, 0)) == Vec3(0, 0, 1) && Vec3::Cross(Vec3(1, 2, 3), Vec3(4, 5, 6)) == Vec3(-3, 6, -3);
+};
+
+bool testVecNMulAdd() {
+    return MulAdd(Vec3(1, 2, 3), 2.0f, Vec3(1)) == Vec3(3, 5, 7) && MulAdd(Vec4(1, 2, 3, 4), 2.0f, Vec4(1)) == Vec4(3, 5, 7, 9);
+};
+
+// Every component is scaled by the same reciprocal length
+bool testVecNNormalize() {
+    VecN<float, 5> a(1, -2, 3, 0.5f, 4);
+    float s = 1.0f / a.Length();
+    VecN<float, 5> expected(1 * s, -2 * s, 3 * s, 0.5f * s, 4 * s);
+    Vec3 v(3, 0, -4);
+    v.Normalize();
+    return testNearEquals(a.Normalized().e, expected.e, 5, 1e-6f) && testNearEquals(v, Vec3(0.6f, 0.0f, -0.8f), 1e-6f);
+};
+
+// The fused Hermite overloads must give the same result as the generic Track expression
+bool testVecNHermite() {
+    Vec3 p0(1, 2, 3), p1(-4, 0.5f, 2), m0(0.25f, -1, 3), m1(2, 2, -0.75f);
+    Vec4 q0(1, 2, 3, 4), q1(-4, 0.5f, 2, 1), n0(0.25f, -1, 3, 0), n1(2, 2, -0.75f, 1);
+    for (float t = 0.0f; t <= 1.0f; t += 0.125f) {
+        if (Hermite(p0, p1, m0, m1, t) != mini3d::animation::Hermite<Vec3>(p0, p1, m0, m1, t))
+            return false;
+        if (Hermite(q0, q1, n0, n1, t) != mini3d::animation::Hermite<Vec4>(q0, q1, n0, n1, t))
+            return false;
+    }
+    return true;
+};
+
+vector<pair<const char*, bool(*)()>> math_uvecn = {
+    {"Constexpr", &testVecNConstexpr},
+    {"Arithmetic", &testVecNArithmetic},
+    {"Cross", &testVecNCross},
+    {"MulAdd", &testVecNMulAdd},
+    {"Normalize", &testVecNNormalize},
+    {"Hermite", &testVecNHermite} };
+
+#endif
@@ -7,15 +7,74 @@
 
 #include <vector>
 #include <string>
+#include <cstdio>
+#include <cstdarg>
 
 #include "math/uvec3.hpp"
+#include "math/uquat.hpp"
+#include "math/utransformbatch.hpp"
+#include "math/umat4.hpp"
+#include "math/ufrustum.hpp"
+#include "math/uquatbatch.hpp"
+#include "math/uvecn.hpp"
+#include "math/ubonepalette.hpp"
+#include "math/ufastmath.hpp"
+#include "math/udualquat.hpp"
+#include "math/uskinning.hpp"
+#include "math/upacking.hpp"
+#include "animation/uanimationclip.hpp"
+#include "animation/ucompressedclip.hpp"
+#include "animation/uposebuffer.hpp"
+#include "animation/ublendspace.hpp"
+#include "animation/uclipplayer.hpp"
+#include "animation/uanimationevents.hpp"
+#include "animation/uanimationmanager.hpp"
+#include "import/umini3dimporter.hpp"
+#include "import/uarena.hpp"
+#include "import/uassetarray.hpp"
+#include "import/uassetstreamer.hpp"
 
 using namespace std;
 
+// Failed asserts are printed, the test that hit one reports its own result
+void mini3d_assert(bool expression, const char* text, ...) {
+    if (expression)
+        return;
+
+    va_list args;
+    va_start(args, text);
+    printf("Assert: ");
+    vprintf(text, args);
+    printf("\n");
+    va_end(args);
+}
+
 int main() {
 
     vector<pair<const char*, vector<pair<const char*, bool(*)()>>>> suites = {
-        { "mini3d_math/vec3.cpp", math_uvec3 } };
+        { "mini3d_math/vec3.cpp", math_uvec3 },
+        { "mini3d_math/quat.hpp", math_uquat },
+        { "mini3d_math/transformbatch.hpp", math_utransformbatch },
+        { "mini3d_math/mat4.hpp", math_umat4 },
+        { "mini3d_math/frustum.hpp", math_ufrustum },
+        { "mini3d_math/quatbatch.hpp", math_uquatbatch },
+        { "mini3d_math/vecn.hpp", math_uvecn },
+        { "mini3d_math/bonepalette.hpp", math_ubonepalette },
+        { "mini3d_math/fastmath.hpp", math_ufastmath },
+        { "mini3d_math/dualquat.hpp", math_udualquat },
+        { "mini3d_math/skinning.hpp", math_uskinning },
+        { "mini3d_math/packing.hpp", math_upacking },
+        { "mini3d_animation/animationclip.hpp", animation_uanimationclip },
+        { "mini3d_animation/compressedclip.hpp", animation_ucompressedclip },
+        { "mini3d_animation/posebuffer.hpp", animation_uposebuffer },
+        { "mini3d_animation/blendspace.hpp", animation_ublendspace },
+        { "mini3d_animation/clipplayer.hpp", animation_uclipplayer },
+        { "mini3d_animation/animationevents.hpp", animation_uanimationevents },
+        { "mini3d_animation/animationmanager.cpp", animation_uanimationmanager },
+        { "mini3d_import/importers/mini3d/mini3dimporter.cpp", import_umini3dimporter },
+        { "mini3d_import/common/arena.cpp", import_uarena },
+        { "mini3d_import/assetlibrary.hpp", import_uassetarray },
+        { "mini3d_import/assetstreamer.cpp", import_uassetstreamer } };
 
     int pass = 0;
     int fail = 0;
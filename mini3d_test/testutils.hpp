@@ -0,0 +1,34 @@
+// Copyright (c) <2018> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+#ifndef MINI3D_TEST_TESTUTILS_H
+#define MINI3D_TEST_TESTUTILS_H
+
+#include <cmath>
+
+#include "../mini3d_math/transform.hpp"
+#include "../mini3d_math/mat4.hpp"
+
+using namespace mini3d::math;
+
+// Results computed along two paths are compared with a tolerance. Even when both
+// evaluate the same expression, the compiler may contract a multiply and an add
+// into one FMA on one path and not the other (-march=native), which changes the
+// last bits.
+
+inline bool testNearEquals(const float* a, const float* b, unsigned int count, float epsilon) {
+    for (unsigned int i = 0; i < count; ++i)
+        if (!(fabs(a[i] - b[i]) <= epsilon))
+            return false;
+    return true;
+}
+
+inline bool testNearEquals(float a, float b, float epsilon)                           { return testNearEquals(&a, &b, 1, epsilon); }
+inline bool testNearEquals(const Vec3 &a, const Vec3 &b, float epsilon)               { return testNearEquals(&a.x, &b.x, 3, epsilon); }
+inline bool testNearEquals(const Vec4 &a, const Vec4 &b, float epsilon)               { return testNearEquals(&a.x, &b.x, 4, epsilon); }
+inline bool testNearEquals(const Quat &a, const Quat &b, float epsilon)               { return testNearEquals(&a.x, &b.x, 4, epsilon); }
+inline bool testNearEquals(const Mat4 &a, const Mat4 &b, float epsilon)               { return testNearEquals(a.m, b.m, 16, epsilon); }
+inline bool testNearEquals(const Transform &a, const Transform &b, float epsilon)     { return testNearEquals(a.pos, b.pos, epsilon) && testNearEquals(a.rot, b.rot, epsilon) && testNearEquals(a.scale, b.scale, epsilon); }
+
+#endif
@@ -6,6 +6,8 @@
 
 #include "animationutils.hpp"
 
+#include <cstddef>
+
 void mini3d_assert(bool expression, const char* text, ...) ;
 
 using namespace mini3d::utils;
@@ -13,68 +15,191 @@ using namespace mini3d::utils;
 const unsigned int POSITION_KEYFRAME_SIZE = sizeof(Vec3) + sizeof(float);
 const unsigned int ROTATION_KEYFRAME_SIZE = sizeof(Quat) + sizeof(float);
 
+namespace {
+
+// Looks the bone up in the armature's name index by the hash computed at load time,
+// see AssetLibrary::BuildIndex. Returns joints.count if the armature has no such bone,
+// the channel is then left out.
+unsigned int JointIndex(Action* action, Channel* channel, Armature* armature)
+{
+    Joint* joint = armature->joints.Find(channel->boneNameHash, channel->boneName.array);
+    mini3d_assert(joint != 0, "Can't find transform index for bone %s and action %s on armature %s", channel->boneName.array, action->name.array, armature->name.array);
+    return joint ? (unsigned int)(joint - armature->joints.array) : armature->joints.count;
+}
+
+// A track writing the channel to target, 0 for the channel types tracks do not animate.
+// Transform has one scale for all axes and SCALE channels have one per axis, so scale
+// is not animated.
+ITrack* NewTrack(Channel* channel, Transform* target)
+{
+    switch (channel->type)
+    {
+        case Channel::POSITION:
+            return new Track<Vec3>(&target->pos, (Keyframe<Vec3>*)channel->animationData.array, channel->animationData.count / POSITION_KEYFRAME_SIZE);
+        case Channel::ROTATION:
+            return new Track<Quat, true>(&target->rot, (Keyframe<Quat>*)channel->animationData.array, channel->animationData.count / ROTATION_KEYFRAME_SIZE);
+        default:
+            return 0;
+    }
+}
+
+}
+
+// Channels without a track are left out, the animation has one track per animated channel
 Animation* AnimationUtils::AnimationFromAction(Action* action, Transform* target)
 {
     ITrack** tracks = new ITrack*[action->channels.count];
+    unsigned int count = 0;
+
+    for (unsigned int i = 0; i < action->channels.count; ++i)
+        if (ITrack* track = NewTrack(action->channels.array + i, target))
+            tracks[count++] = track;
+
+    return new Animation(tracks, count, action->length);
+}
+
+Animation* AnimationUtils::BoneAnimationFromAction(Action* action, Armature* armature, Transform* targets)
+{
+    ITrack** tracks = new ITrack*[action->channels.count];
+    unsigned int count = 0;
 
     for (unsigned int i = 0; i < action->channels.count; ++i)
     {
         Channel* channel = action->channels.array + i;
-        switch (channel->type) 
-        {
-            case Channel::POSITION:
-                tracks[i] = new Track<Vec3>(&target->pos, (Keyframe<Vec3>*)channel->animationData.array, channel->animationData.count / POSITION_KEYFRAME_SIZE);
-                break;
-            case Channel::ROTATION:
-                tracks[i] = new Track<Quat, true>(&target->rot, (Keyframe<Quat>*)channel->animationData.array, channel->animationData.count / ROTATION_KEYFRAME_SIZE);
-                break;
-        }
+
+        unsigned int j = JointIndex(action, channel, armature);
+        if (j == armature->joints.count)
+            continue;
+
+        if (ITrack* track = NewTrack(channel, targets + j))
+            tracks[count++] = track;
     }
 
-    return new Animation(tracks, action->channels.count, action->length);
+    return new Animation(tracks, count, action->length);
 }
 
-Animation* AnimationUtils::BoneAnimationFromAction(Action* action, Armature* armature, Transform targets[4])
+namespace {
+
+const unsigned int TRANSFORM_FLOATS = sizeof(Transform) / sizeof(float);
+
+// Where a channel goes in its Transform, false for the channel types clips do not animate
+bool ChannelLayout(const Channel* channel, unsigned int &components, unsigned int &offset, unsigned int &flags, unsigned int &keySize)
 {
-    ITrack** tracks = new ITrack*[action->channels.count];
+    switch (channel->type)
+    {
+        case Channel::POSITION:
+            components = 3, offset = offsetof(Transform, pos) / sizeof(float), flags = 0, keySize = POSITION_KEYFRAME_SIZE;
+            return true;
+        case Channel::ROTATION:
+            components = 4, offset = offsetof(Transform, rot) / sizeof(float), flags = AnimationClip::CHANNEL_NORMALIZE, keySize = ROTATION_KEYFRAME_SIZE;
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <typename Clip>
+void AddClipChannel(Clip* clip, Channel* channel, unsigned int transformIndex)
+{
+    unsigned int components, offset, flags, keySize;
+    if (ChannelLayout(channel, components, offset, flags, keySize))
+        clip->AddChannel((const float*)channel->animationData.array, channel->animationData.count / keySize, components, transformIndex * TRANSFORM_FLOATS + offset, flags);
+}
 
+// Interpolates with the authored tangents when the file has one in and one out
+// tangent for every key, and with Catmull-Rom tangents otherwise
+void AddClipChannel(AnimationClip* clip, Channel* channel, unsigned int transformIndex)
+{
+    unsigned int components, offset, flags, keySize;
+    if (!ChannelLayout(channel, components, offset, flags, keySize))
+        return;
+
+    unsigned int count = channel->animationData.count / keySize;
+    const float* pTangents = (channel->tangents.count == count * 2 * components * sizeof(float)) ? (const float*)channel->tangents.array : 0;
+    clip->AddChannel((const float*)channel->animationData.array, count, components, transformIndex * TRANSFORM_FLOATS + offset, flags, pTangents);
+}
+
+// Takes the keys the exporter compressed when they are what the clip would make of the
+// channel, at its sample rate and within its tolerance, and compresses the raw keys
+// otherwise
+void AddClipChannel(CompressedClip* clip, Channel* channel, unsigned int transformIndex)
+{
+    const CompressedKeys &keys = channel->compressed;
+    unsigned int components, offset, flags, keySize;
+    if (!ChannelLayout(channel, components, offset, flags, keySize))
+        return;
+
+    if (keys.keyCount == 0 || keys.sampleRate != clip->GetSampleRate() || keys.tolerance > clip->GetTolerance() ||
+        keys.encoding != (unsigned int)CompressedClip::GetEncoding(components, flags) ||
+        keys.values.count != keys.keyCount * CompressedClip::GetStride(components, flags) * sizeof(uint16_t))
+    {
+        AddClipChannel<CompressedClip>(clip, channel, transformIndex);
+        return;
+    }
+
+    clip->AddCompressedChannel((const uint16_t*)keys.frames.array, (const uint16_t*)keys.values.array, keys.keyCount, components, transformIndex * TRANSFORM_FLOATS + offset, flags, keys.minimum, keys.scale);
+}
+
+template <typename Clip>
+Clip* AddClipChannels(Clip* clip, Action* action, Armature* armature)
+{
     for (unsigned int i = 0; i < action->channels.count; ++i)
     {
         Channel* channel = action->channels.array + i;
 
-        unsigned int j;
-        // TODO: Optimize (should do binary search)
-        for (j = 0; j < armature->joints.count; ++j)
-            if (armature->joints.array[j].name == channel->boneName)
-                break;
-
-        mini3d_assert((j < armature->joints.count), "Can't find transform index for bone %s and action %s on armature %s", channel->boneName, action->name, armature->name);
-
-        switch (channel->type) 
-        {
-            case Channel::POSITION:
-                tracks[i] = new Track<Vec3>(&targets[j].pos, (Keyframe<Vec3>*)channel->animationData.array, channel->animationData.count / POSITION_KEYFRAME_SIZE);
-                break;
-            case Channel::ROTATION:
-                tracks[i] = new Track<Quat, true>(&targets[j].rot, (Keyframe<Quat>*)channel->animationData.array, channel->animationData.count / ROTATION_KEYFRAME_SIZE);
-                break;
-        }
+        unsigned int j = armature ? JointIndex(action, channel, armature) : 0;
+        if (armature && j == armature->joints.count)
+            continue;
+
+        AddClipChannel(clip, channel, j);
     }
 
-    return new Animation(tracks, action->channels.count, action->length);
+    return clip;
+}
+
+}
+
+AnimationClip* AnimationUtils::ClipFromAction(Action* action)
+{
+    return AddClipChannels(new AnimationClip(action->length), action, 0);
+}
+
+AnimationClip* AnimationUtils::BoneClipFromAction(Action* action, Armature* armature)
+{
+    return AddClipChannels(new AnimationClip(action->length), action, armature);
+}
+
+CompressedClip* AnimationUtils::CompressedClipFromAction(Action* action, float tolerance)
+{
+    return AddClipChannels(new CompressedClip(action->length, tolerance), action, 0);
 }
 
-void AnimationUtils::BoneTransformsToMatrices(float boneMatrices[4][16], Transform transforms[4], const Armature* armature)
+CompressedClip* AnimationUtils::CompressedBoneClipFromAction(Action* action, Armature* armature, float tolerance)
 {
+    return AddClipChannels(new CompressedClip(action->length, tolerance), action, armature);
+}
+
+void AnimationUtils::BoneTransformsToMatrices(float* pBoneMatrices, Transform* transforms, const Armature* armature, BonePalette::Layout layout)
+{
+    // Joints are stored parents first, so one pass concatenates the whole hierarchy
     for (unsigned int i = 0; i < armature->joints.count; ++i)
     {
         Joint* joint = armature->joints.array + i;
-        transforms[i].rot.RotateAxis(joint->roll);
-        transforms[i].pos = Vec3(joint->offset) + transforms[i] * -Vec3(joint->offset);
+        Vec3 offset(joint->offset);
 
-        if (joint->parent)
-            transforms[i] = transforms[joint->parent->index] * transforms[i];
+        // roll * rot / roll, with the roll as a matrix precomputed at load
+        const float* m = joint->rollBasis;
+        Quat &rot = transforms[i].rot;
+        float x = rot.x, y = rot.y, z = rot.z;
+        rot.x = m[0]*x + m[1]*y + m[2]*z;
+        rot.y = m[3]*x + m[4]*y + m[5]*z;
+        rot.z = m[6]*x + m[7]*y + m[8]*z;
 
-        transforms[i].ToMatrix(boneMatrices[i]);
+        transforms[i].pos = offset + transforms[i] * -offset;
+
+        if (joint->parent)
+            BonePalette::Concatenate(transforms[i], transforms[joint->parent->index]);
     }
+
+    BonePalette::ToMatrices(pBoneMatrices, transforms, armature->joints.count, layout);
 }
\ No newline at end of file
@@ -21,8 +21,23 @@ namespace utils {
 struct AnimationUtils
 {
     static Animation* AnimationFromAction(Action* action, Transform* target);
-    static Animation* BoneAnimationFromAction(Action* action, Armature* armature, Transform targets[4]);
-    static void BoneTransformsToMatrices(float boneMatrices[4][16], Transform transforms[4], const Armature* armature);
+    static Animation* BoneAnimationFromAction(Action* action, Armature* armature, Transform* targets);
+
+    // Clips for ClipEvaluator. The pose buffer is one Transform, or one Transform per joint
+    // of the armature in joint order, so it can be passed as (float*)transforms. Channels
+    // are interpolated with the authored tangents when the file has them.
+    static AnimationClip* ClipFromAction(Action* action);
+    static AnimationClip* BoneClipFromAction(Action* action, Armature* armature);
+
+    // The same clips with keys removed and quantized, see CompressedClip. Channels use the
+    // keys the exporter compressed when the file has them within tolerance, the others
+    // are compressed at load time.
+    static CompressedClip* CompressedClipFromAction(Action* action, float tolerance = 1e-4f);
+    static CompressedClip* CompressedBoneClipFromAction(Action* action, Armature* armature, float tolerance = 1e-4f);
+
+    // Writes one matrix per joint of the armature to pBoneMatrices (12 or 16 floats each, see
+    // BonePalette). transforms holds the joint local transforms and is left in model space.
+    static void BoneTransformsToMatrices(float* pBoneMatrices, Transform* transforms, const Armature* armature, BonePalette::Layout layout = BonePalette::LAYOUT_4X4);
 };
 
 }
@@ -0,0 +1,182 @@
+
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#include "meshutils.hpp"
+
+void mini3d_assert(bool expression, const char* text, ...);
+
+using namespace mini3d::utils;
+
+const unsigned int MAX_PACKED_JOINTS = 256;
+
+namespace {
+
+// Copies components floats of every vertex starting at offsetInBytes into a tightly packed array
+float* Gather(const Mesh* mesh, unsigned int vertexCount, unsigned int offsetInBytes, unsigned int components)
+{
+    float* pOut = new float[vertexCount * components];
+    for (unsigned int i = 0; i < vertexCount; ++i)
+        memcpy(pOut + i * components, mesh->vertexData.array + i * mesh->vertexSizeInBytes + offsetInBytes, components * sizeof(float));
+    return pOut;
+}
+
+// Copies sizeInBytes bytes per vertex from a tightly packed array into the vertices
+void Scatter(char* pVertices, unsigned int vertexCount, unsigned int vertexSizeInBytes, unsigned int offsetInBytes, const void* pData, unsigned int sizeInBytes)
+{
+    for (unsigned int i = 0; i < vertexCount; ++i)
+        memcpy(pVertices + i * vertexSizeInBytes + offsetInBytes, (const char*)pData + i * sizeInBytes, sizeInBytes);
+}
+
+IShaderInputLayout::InputElement Element(const char* nameGLSL, const char* semanticHLSL, unsigned int offsetInBytes, IShaderInputLayout::DataType type)
+{
+    IShaderInputLayout::InputElement element = { nameGLSL, semanticHLSL, 0, 0, offsetInBytes, type, IShaderInputLayout::PER_VERTEX };
+    return element;
+}
+
+}
+
+unsigned int MeshUtils::PackVertices(Mesh* mesh, const Skinning::Attribute* pAttributes, unsigned int count, unsigned int flags, IShaderInputLayout::InputElement* pElements)
+{
+    Skinning::VertexLayout source = Skinning::VertexLayout::FromAttributes(pAttributes, count);
+    mini3d_assert(source.stride == mesh->vertexSizeInBytes, "Vertex attributes do not match the vertex size of mesh %s", mesh->name.array);
+
+    static const unsigned int FLOAT_SIZES[] = { 3, 3, 2, 8, 3 };
+    static const unsigned int PACKED_SIZES[] = { 12, 4, 4, 8, 4 };
+
+    unsigned int vertexCount = mesh->vertexData.count / mesh->vertexSizeInBytes;
+
+    unsigned int packedSize = 0;
+    for (unsigned int i = 0; i < count; ++i)
+        packedSize += (pAttributes[i] == Skinning::POSITION && (flags & PACK_POSITION_HALF)) ? 8 : PACKED_SIZES[pAttributes[i]];
+
+    char* pPacked = new char[vertexCount * packedSize];
+    unsigned int elementCount = 0;
+    unsigned int sourceOffset = 0, offset = 0;
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int components = FLOAT_SIZES[pAttributes[i]];
+        float* pFloats = Gather(mesh, vertexCount, sourceOffset, components);
+        sourceOffset += components * sizeof(float);
+
+        switch (pAttributes[i])
+        {
+            case Skinning::POSITION:
+                if (flags & PACK_POSITION_HALF)
+                {
+                    float* pVec4s = new float[vertexCount * 4];
+                    for (unsigned int v = 0; v < vertexCount; ++v)
+                        memcpy(pVec4s + v * 4, pFloats + v * 3, 3 * sizeof(float)), pVec4s[v * 4 + 3] = 1.0f;
+
+                    uint16_t* pHalfs = new uint16_t[vertexCount * 4];
+                    Packing::FloatsToHalfs(pHalfs, pVec4s, vertexCount * 4);
+                    Scatter(pPacked, vertexCount, packedSize, offset, pHalfs, 8);
+                    pElements[elementCount++] = Element("position", "POSITION", offset, IShaderInputLayout::R16G16B16A16_FLOAT);
+                    offset += 8;
+                    delete[] pHalfs;
+                    delete[] pVec4s;
+                }
+                else
+                {
+                    Scatter(pPacked, vertexCount, packedSize, offset, pFloats, 12);
+                    pElements[elementCount++] = Element("position", "POSITION", offset, IShaderInputLayout::R32G32B32_FLOAT);
+                    offset += 12;
+                }
+                break;
+
+            case Skinning::NORMAL:
+                if (flags & PACK_NORMAL_1010102)
+                {
+                    float* pVec4s = new float[vertexCount * 4];
+                    for (unsigned int v = 0; v < vertexCount * 4; ++v)
+                        pVec4s[v] = (v % 4 == 3) ? 0.0f : pFloats[v / 4 * 3 + v % 4] * 0.5f + 0.5f;
+
+                    uint32_t* pPackedNormals = new uint32_t[vertexCount];
+                    Packing::Vec4sToUnorm1010102(pPackedNormals, pVec4s, vertexCount);
+                    Scatter(pPacked, vertexCount, packedSize, offset, pPackedNormals, 4);
+                    pElements[elementCount++] = Element("normal", "NORMAL", offset, IShaderInputLayout::R10G10B10A2_UNORM);
+                    delete[] pPackedNormals;
+                    delete[] pVec4s;
+                }
+                else
+                {
+                    int16_t* pOctahedral = new int16_t[vertexCount * 2];
+                    Packing::NormalsToOctahedral(pOctahedral, pFloats, vertexCount);
+                    Scatter(pPacked, vertexCount, packedSize, offset, pOctahedral, 4);
+                    pElements[elementCount++] = Element("normal", "NORMAL", offset, IShaderInputLayout::R16G16_SNORM);
+                    delete[] pOctahedral;
+                }
+                offset += 4;
+                break;
+
+            case Skinning::TEXTURE:
+            {
+                uint16_t* pHalfs = new uint16_t[vertexCount * 2];
+                Packing::FloatsToHalfs(pHalfs, pFloats, vertexCount * 2);
+                Scatter(pPacked, vertexCount, packedSize, offset, pHalfs, 4);
+                pElements[elementCount++] = Element("texCoord", "TEXCOORD", offset, IShaderInputLayout::R16G16_FLOAT);
+                offset += 4;
+                delete[] pHalfs;
+                break;
+            }
+
+            case Skinning::GROUPS:
+            {
+                // 4 indices and 4 weights per vertex. The weights are sorted largest first by the
+                // exporter, the first one absorbs the rounding so the weights still sum to 255.
+                uint8_t* pGroups = new uint8_t[vertexCount * 8];
+                for (unsigned int v = 0; v < vertexCount; ++v)
+                {
+                    const float* g = pFloats + v * 8;
+                    uint8_t* p = pGroups + v * 8;
+                    for (unsigned int j = 0; j < 4; ++j)
+                    {
+                        mini3d_assert(g[j] >= 0 && g[j] < MAX_PACKED_JOINTS, "Joint index %f does not fit in 8 bits in mesh %s", g[j], mesh->name.array);
+                        p[j] = (uint8_t)g[j];
+                    }
+
+                    Packing::FloatsToUnorm8(p + 4, g + 4, 4);
+                    int sum = p[5] + p[6] + p[7];
+                    if (p[4] + sum != 0)
+                        p[4] = (uint8_t)((sum < 255) ? 255 - sum : 0);
+                }
+                Scatter(pPacked, vertexCount, packedSize, offset, pGroups, 8);
+                pElements[elementCount++] = Element("groupIndices", "BLENDINDICES", offset, IShaderInputLayout::R8G8B8A8_UINT);
+                pElements[elementCount++] = Element("groupWeights", "BLENDWEIGHT", offset + 4, IShaderInputLayout::R8G8B8A8_UNORM);
+                offset += 8;
+                delete[] pGroups;
+                break;
+            }
+
+            case Skinning::COLOR:
+            {
+                float* pVec4s = new float[vertexCount * 4];
+                for (unsigned int v = 0; v < vertexCount * 4; ++v)
+                    pVec4s[v] = (v % 4 == 3) ? 1.0f : pFloats[v / 4 * 3 + v % 4];
+
+                uint8_t* pColors = new uint8_t[vertexCount * 4];
+                Packing::FloatsToUnorm8(pColors, pVec4s, vertexCount * 4);
+                Scatter(pPacked, vertexCount, packedSize, offset, pColors, 4);
+                pElements[elementCount++] = Element("color", "COLOR", offset, IShaderInputLayout::R8G8B8A8_UNORM);
+                offset += 4;
+                delete[] pColors;
+                delete[] pVec4s;
+                break;
+            }
+        }
+
+        delete[] pFloats;
+    }
+
+    if (mesh->vertexData.owner)
+        delete[] mesh->vertexData.array;
+    mesh->vertexData.array = pPacked;
+    mesh->vertexData.owner = true;
+    mesh->vertexData.count = vertexCount * packedSize;
+    mesh->vertexSizeInBytes = packedSize;
+
+    return elementCount;
+}
@@ -0,0 +1,45 @@
+
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_UTILS_MESHUTILS_H
+#define MINI3D_UTILS_MESHUTILS_H
+
+#include "../mini3d/import.hpp"
+#include "../mini3d/math.hpp"
+#include "../mini3d/graphics.hpp"
+
+using namespace mini3d::import;
+using namespace mini3d::math;
+using namespace mini3d::graphics;
+
+namespace mini3d {
+namespace utils {
+
+struct MeshUtils
+{
+    enum PackFlags { PACK_POSITION_HALF = 1, PACK_NORMAL_1010102 = 2 };
+
+    // Repacks the float vertex data of a loaded mesh into a compact layout. pAttributes lists
+    // the attributes in file order, as set in the exporter. Call it right after loading, it
+    // replaces mesh->vertexData and mesh->vertexSizeInBytes. The default export (POSITION,
+    // NORMAL, TEXTURE) goes from 32 to 20 bytes per vertex, with GROUPS from 64 to 28.
+    //
+    //  POSITION    R32G32B32_FLOAT, or R16G16B16A16_FLOAT with w = 1 for PACK_POSITION_HALF
+    //  NORMAL      R16G16_SNORM octahedral, see Packing::NormalsToOctahedral
+    //              or R10G10B10A2_UNORM holding n * 0.5 + 0.5 for PACK_NORMAL_1010102
+    //  TEXTURE     R16G16_FLOAT
+    //  GROUPS      R8G8B8A8_UINT joint indices followed by R8G8B8A8_UNORM weights
+    //  COLOR       R8G8B8A8_UNORM with a = 1
+    //
+    // Writes the matching input elements for vertex buffer 0 to pElements, one per attribute
+    // and two for GROUPS, and returns the number of elements written.
+    static unsigned int PackVertices(Mesh* mesh, const Skinning::Attribute* pAttributes, unsigned int count, unsigned int flags, IShaderInputLayout::InputElement* pElements);
+};
+
+}
+}
+
+#endif
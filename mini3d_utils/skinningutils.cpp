@@ -0,0 +1,87 @@
+
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#include "skinningutils.hpp"
+#include "../mini3d/system.hpp"
+
+void mini3d_assert(bool expression, const char* text, ...);
+
+using namespace mini3d::utils;
+
+// Starting threads costs more than skinning this many vertices
+const unsigned int MIN_VERTICES_PER_THREAD = 1024;
+const unsigned int MAX_SKINNING_THREADS = 16;
+
+namespace {
+
+struct SkinRange : mini3d::system::IRunnable
+{
+    void* pOut;
+    const void* pIn;
+    unsigned int begin, end;
+    const Skinning::VertexLayout* pLayout;
+    const DualQuat* pJoints;
+    const float* pScales;
+
+    void Run() { Skinning::SkinDualQuat(pOut, pIn, begin, end, *pLayout, pJoints, pScales); }
+};
+
+}
+
+void SkinningUtils::SkinVertices(void* pOut, const void* pIn, unsigned int count, const Skinning::VertexLayout &layout, const DualQuat* pJoints, const float* pScales, unsigned int threadCount)
+{
+    mini3d_assert(layout.position != Skinning::NO_ATTRIBUTE && layout.groups != Skinning::NO_ATTRIBUTE, "Skinning needs the POSITION and GROUPS vertex attributes");
+
+    unsigned int maxThreads = (count + MIN_VERTICES_PER_THREAD - 1) / MIN_VERTICES_PER_THREAD;
+    threadCount = (threadCount < maxThreads) ? threadCount : maxThreads;
+    threadCount = (threadCount < MAX_SKINNING_THREADS) ? threadCount : MAX_SKINNING_THREADS;
+
+    if (threadCount <= 1)
+    {
+        Skinning::SkinDualQuat(pOut, pIn, 0, count, layout, pJoints, pScales);
+        return;
+    }
+
+    SkinRange ranges[MAX_SKINNING_THREADS];
+    mini3d::system::IThread* threads[MAX_SKINNING_THREADS];
+
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        ranges[i].pOut = pOut;
+        ranges[i].pIn = pIn;
+        ranges[i].begin = (unsigned int)((unsigned long long)count * i / threadCount);
+        ranges[i].end = (unsigned int)((unsigned long long)count * (i + 1) / threadCount);
+        ranges[i].pLayout = &layout;
+        ranges[i].pJoints = pJoints;
+        ranges[i].pScales = pScales;
+    }
+
+    bool started[MAX_SKINNING_THREADS];
+    for (unsigned int i = 0; i < threadCount - 1; ++i)
+    {
+        threads[i] = mini3d::system::IThread::New(&ranges[i]);
+        started[i] = threads[i]->Run();
+    }
+
+    // The last range runs on the calling thread, and so do the ranges of threads that
+    // could not be started
+    ranges[threadCount - 1].Run();
+
+    for (unsigned int i = 0; i < threadCount - 1; ++i)
+    {
+        if (!started[i])
+            ranges[i].Run();
+
+        threads[i]->Join();
+        delete threads[i];
+    }
+}
+
+void SkinningUtils::SkinMesh(void* pOut, const Mesh* mesh, const Skinning::VertexLayout &layout, const DualQuat* pJoints, const float* pScales, unsigned int threadCount)
+{
+    mini3d_assert(layout.stride == mesh->vertexSizeInBytes, "Vertex layout does not match the vertex size of mesh %s", mesh->name.array);
+    SkinVertices(pOut, mesh->vertexData.array, mesh->vertexData.count / mesh->vertexSizeInBytes, layout, pJoints, pScales, threadCount);
+}
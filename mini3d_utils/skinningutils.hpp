@@ -0,0 +1,34 @@
+
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_UTILS_SKINNINGUTILS_H
+#define MINI3D_UTILS_SKINNINGUTILS_H
+
+#include "../mini3d/import.hpp"
+#include "../mini3d/math.hpp"
+
+using namespace mini3d::import;
+using namespace mini3d::math;
+
+namespace mini3d {
+namespace utils {
+
+struct SkinningUtils
+{
+    // Dual quaternion skins count vertices of pIn into pOut, split into equal vertex ranges over
+    // threadCount threads (the calling thread included). See Skinning::SkinDualQuat.
+    static void SkinVertices(void* pOut, const void* pIn, unsigned int count, const Skinning::VertexLayout &layout, const DualQuat* pJoints, const float* pScales, unsigned int threadCount = 1);
+
+    // Skins all vertices of an imported mesh. pOut must hold mesh->vertexData.count bytes.
+    // The joints are the transforms from AnimationUtils::BoneTransformsToMatrices converted
+    // with Skinning::DualQuatsFromTransforms.
+    static void SkinMesh(void* pOut, const Mesh* mesh, const Skinning::VertexLayout &layout, const DualQuat* pJoints, const float* pScales, unsigned int threadCount = 1);
+};
+
+}
+}
+
+#endif
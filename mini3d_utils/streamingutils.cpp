@@ -0,0 +1,88 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#include "streamingutils.hpp"
+#include "../mini3d_import/common/stb_image.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace mini3d::utils;
+
+
+////////// MESH STREAM JOB //////////////////////////////////////////////////////
+
+void MeshStreamJob::Finalize()
+{
+    m_pVertexBuffer = IVertexBuffer::New(m_pGraphics, m_mesh->vertexData.array, m_mesh->vertexData.count, m_mesh->vertexSizeInBytes);
+
+    IIndexBuffer::DataType dataType = (m_mesh->indexSizeInBytes == 4) ? IIndexBuffer::INT_32 : IIndexBuffer::INT_16;
+    m_pIndexBuffer = IIndexBuffer::New(m_pGraphics, m_mesh->indexData.array, m_mesh->indexData.count, dataType);
+}
+
+
+////////// TEXTURE STREAM JOB ///////////////////////////////////////////////////
+
+TextureStreamJob::TextureStreamJob(IGraphicsService* pGraphics, const char* filename, ITexture::SamplerSettings samplerSettings) :
+    m_pGraphics(pGraphics), m_samplerSettings(samplerSettings), m_pFileData(0), m_fileSize(0), m_pPixels(0), m_width(0), m_height(0), m_pTexture(0)
+{
+    m_pFilename = strcpy(new char[strlen(filename) + 1], filename);
+}
+
+TextureStreamJob::~TextureStreamJob()
+{
+    delete[] m_pFilename;
+}
+
+bool TextureStreamJob::Read()
+{
+    FILE* file = fopen(m_pFilename, "rb");
+    if (file == 0)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (size <= 0)
+    {
+        fclose(file);
+        return false;
+    }
+
+    m_fileSize = (unsigned int)size;
+    m_pFileData = new unsigned char[m_fileSize];
+    bool complete = (fread(m_pFileData, 1, m_fileSize, file) == m_fileSize);
+    fclose(file);
+
+    return complete;
+}
+
+bool TextureStreamJob::Decode()
+{
+    int components;
+    m_pPixels = stbi_load_from_memory(m_pFileData, (int)m_fileSize, &m_width, &m_height, &components, 4);
+
+    delete[] m_pFileData;
+    m_pFileData = 0;
+
+    return m_pPixels != 0;
+}
+
+void TextureStreamJob::Finalize()
+{
+    m_pTexture = IBitmapTexture::New(m_pGraphics, (const char*)m_pPixels, m_width, m_height, IBitmapTexture::FORMAT_RGBA8UI, m_samplerSettings);
+
+    stbi_image_free(m_pPixels);
+    m_pPixels = 0;
+}
+
+void TextureStreamJob::Discard()
+{
+    delete[] m_pFileData;
+    stbi_image_free(m_pPixels);
+    m_pFileData = 0;
+    m_pPixels = 0;
+}
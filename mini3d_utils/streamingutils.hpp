@@ -0,0 +1,84 @@
+// Copyright (c) <2012> Daniel Peterson
+// This file is part of Mini3D <www.mini3d.org>
+// It is distributed under the MIT Software License <www.mini3d.org/license.php>
+
+
+#ifndef MINI3D_UTILS_STREAMINGUTILS_H
+#define MINI3D_UTILS_STREAMINGUTILS_H
+
+#include "../mini3d/import.hpp"
+#include "../mini3d/graphics.hpp"
+
+using namespace mini3d::import;
+using namespace mini3d::graphics;
+
+namespace mini3d {
+namespace utils {
+
+// Stream jobs for AssetStreamer that end in GPU resources. The resources are
+// created in Finalize, on the thread calling AssetStreamer::Update, and are the
+// caller's once the job is READY.
+
+// Uploads the vertex and index data of a loaded mesh. There is nothing to read or
+// decode, streaming it only puts the upload in priority order with the rest and
+// under the maxFinalize cap of AssetStreamer::Update. The mesh must stay loaded
+// until the job is READY.
+class MeshStreamJob : public StreamJob
+{
+public:
+
+    MeshStreamJob(IGraphicsService* pGraphics, const Mesh* mesh) : m_pGraphics(pGraphics), m_mesh(mesh), m_pVertexBuffer(0), m_pIndexBuffer(0) {}
+
+    IVertexBuffer* GetVertexBuffer() const                              { return m_pVertexBuffer; }
+    IIndexBuffer* GetIndexBuffer() const                                { return m_pIndexBuffer; }
+
+protected:
+
+    void Finalize();
+
+private:
+
+    IGraphicsService* m_pGraphics;
+    const Mesh* m_mesh;
+    IVertexBuffer* m_pVertexBuffer;
+    IIndexBuffer* m_pIndexBuffer;
+};
+
+// Reads an image file on the I/O thread, decodes it to RGBA8 with stb_image on a
+// worker thread and creates the texture in Finalize.
+class TextureStreamJob : public StreamJob
+{
+public:
+
+    TextureStreamJob(IGraphicsService* pGraphics, const char* filename, ITexture::SamplerSettings samplerSettings = SAMPLER_SETTINGS_DEFAULT);
+    ~TextureStreamJob();
+
+    IBitmapTexture* GetTexture() const                                  { return m_pTexture; }
+
+protected:
+
+    bool Read();
+    bool Decode();
+    void Finalize();
+    void Discard();
+
+private:
+
+    IGraphicsService* m_pGraphics;
+    ITexture::SamplerSettings m_samplerSettings;
+    char* m_pFilename;
+
+    unsigned char* m_pFileData;
+    unsigned int m_fileSize;
+
+    unsigned char* m_pPixels;
+    int m_width;
+    int m_height;
+
+    IBitmapTexture* m_pTexture;
+};
+
+}
+}
+
+#endif
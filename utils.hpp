@@ -8,5 +8,8 @@
 #define MINI3D_UTILS_H
 
 #include "mini3d_utils/animationutils.hpp"
+#include "mini3d_utils/skinningutils.hpp"
+#include "mini3d_utils/meshutils.hpp"
+#include "mini3d_utils/streamingutils.hpp"
 
 #endif